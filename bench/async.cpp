@@ -0,0 +1,103 @@
+#include "bench.h"
+
+#include "simcoe/async/generator.h"
+#include "simcoe/async/task.h"
+
+#include <atomic>
+#include <format>
+
+using namespace simcoe;
+using namespace simcoe::async;
+
+namespace {
+    constexpr size_t kCalls = 1'000'000;
+    constexpr size_t kHops = 100'000;
+    constexpr size_t kWorkers = 3;
+
+    uint64_t plain(uint64_t value) {
+        return value * 3 + 1;
+    }
+
+    Task<uint64_t> child(uint64_t value) {
+        co_return value * 3 + 1;
+    }
+
+    // each iteration creates a child frame, resumes it and destroys it
+    Task<uint64_t> parent(size_t count) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += co_await child(i);
+        }
+
+        co_return sum;
+    }
+
+    Generator<uint64_t> sequence(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            co_yield plain(i);
+        }
+    }
+
+    Task<uint64_t> hops(IExecutor& executor, size_t count) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            co_await schedule(executor);
+            sum += i;
+        }
+
+        co_return sum;
+    }
+}
+
+int main() {
+    bench::section(std::format("{} calls", kCalls));
+
+    bench::report("plain loop", bench::measure(kCalls, [](size_t i) { bench::keep(plain(i)); }));
+
+    {
+        auto start = bench::Clock::now();
+        bench::keep(syncWait(parent(kCalls)));
+        bench::report("Task create + co_await", bench::toNanos(bench::Clock::now() - start) / kCalls);
+    }
+
+    {
+        auto start = bench::Clock::now();
+        uint64_t sum = 0;
+        for (uint64_t value : sequence(kCalls)) {
+            sum += value;
+        }
+
+        bench::keep(sum);
+        bench::report("Generator step", bench::toNanos(bench::Clock::now() - start) / kCalls);
+    }
+
+    bench::section(std::format("{} executor hops", kHops));
+
+    {
+        InlineExecutor executor;
+
+        auto start = bench::Clock::now();
+        bench::keep(syncWait(hops(executor, kHops)));
+        bench::report("InlineExecutor", bench::toNanos(bench::Clock::now() - start) / kHops);
+    }
+
+    {
+        threads::Scheduler scheduler(kWorkers);
+        SchedulerExecutor executor(scheduler);
+
+        auto start = bench::Clock::now();
+        bench::keep(syncWait(hops(executor, kHops)));
+        bench::report(std::format("SchedulerExecutor, {} threads", scheduler.getThreadCount()), bench::toNanos(bench::Clock::now() - start) / kHops);
+
+        // the same round trip as a plain job for comparison
+        std::atomic_uint64_t sum = 0;
+        double job = bench::measure(kHops, [&](size_t i) {
+            threads::Counter counter;
+            scheduler.submit([&sum, i] { sum += i; }, &counter);
+            scheduler.wait(counter);
+        });
+
+        bench::keep(sum);
+        bench::report(std::format("Scheduler submit + wait, {} threads", scheduler.getThreadCount()), job);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+// timing helpers shared by the benchmarks. each benchmark is its own executable,
+// run them with meson test --benchmark. build with --buildtype=release for numbers worth keeping
+namespace bench {
+    using Clock = std::chrono::steady_clock;
+
+    namespace detail {
+        inline volatile uint64_t gSink = 0;
+    }
+
+    // hand results here so the optimiser can't drop the work that made them
+    inline void keep(uint64_t value) {
+        detail::gSink = value;
+    }
+
+    inline double toNanos(Clock::duration time) {
+        return std::chrono::duration<double, std::nano>(time).count();
+    }
+
+    // average nanoseconds per call of fn(i) for i in [0, iterations)
+    template<typename F>
+    double measure(size_t iterations, F&& fn) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            fn(i);
+        }
+
+        return toNanos(Clock::now() - start) / double(iterations);
+    }
+
+    inline void section(std::string_view name) {
+        std::printf("\n%.*s\n", int(name.size()), name.data());
+    }
+
+    inline void report(std::string_view name, double value, std::string_view unit = "ns/op") {
+        std::printf("  %-44.*s %12.1f %.*s\n", int(name.size()), name.data(), value, int(unit.size()), unit.data());
+    }
+}
@@ -0,0 +1,137 @@
+#include "bench.h"
+
+#include "simcoe/core/logwriter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kCalls = 1'000'000;
+    constexpr size_t kThreads = 8;
+
+    constexpr std::string_view kPath = "assets/textures/brick_albedo.dds";
+
+    void logMessage(logging::Category& category, size_t i) {
+        category.info("loaded {} in {}ms ({} mips)", kPath, float(i) * 0.25f, uint32_t(i % 12));
+    }
+
+    // kCalls info() calls split across threads
+    void run(logging::Category& category, size_t threads) {
+        std::vector<std::jthread> logging;
+        for (size_t t = 0; t < threads; t++) {
+            logging.emplace_back([&, t] {
+                for (size_t i = t; i < kCalls; i += threads) {
+                    logMessage(category, i);
+                }
+            });
+        }
+    }
+
+    // what FileSink writes for the same calls, it keeps its file open until exit so it can't be measured after
+    size_t getTextSize() {
+        size_t size = 0;
+        for (size_t i = 0; i < kCalls; i++) {
+            size += std::formatted_size("[asset:info] loaded {} in {}ms ({} mips)\n", kPath, float(i) * 0.25f, uint32_t(i % 12));
+        }
+
+        return size;
+    }
+
+    // times every call on one thread, the slow tail is the calls that filled the buffer
+    void reportLatency(std::string_view name, const std::filesystem::path& path) {
+        logging::Category category { logging::eInfo, "asset" };
+        std::vector<uint64_t> times(kCalls);
+
+        {
+            logging::BinarySink binarySink { path.string().c_str() };
+            for (size_t i = 0; i < kCalls; i++) {
+                auto start = bench::Clock::now();
+                logMessage(category, i);
+                times[i] = uint64_t(bench::toNanos(bench::Clock::now() - start));
+            }
+        }
+
+        std::filesystem::remove(path);
+        std::sort(times.begin(), times.end());
+
+        bench::report(std::format("{} p50", name), double(times[kCalls / 2]), "ns");
+        bench::report(std::format("{} p99.9", name), double(times[kCalls - kCalls / 1000]), "ns");
+        bench::report(std::format("{} max", name), double(times.back()), "ns");
+    }
+
+    void report(std::string_view name, double time, size_t bytes) {
+        bench::report(name, time / kCalls, "ns/call");
+        bench::report(std::format("{} throughput", name), double(bytes) / (time / 1e9) / 1e6, "MB/s");
+        bench::report(std::format("{} size", name), double(bytes) / kCalls, "bytes/call");
+    }
+}
+
+int main() {
+    auto textPath = std::filesystem::temp_directory_path() / "simcoe-bench.log";
+    auto binaryPath = std::filesystem::temp_directory_path() / "simcoe-bench.bin.log";
+
+    size_t textSize = getTextSize();
+
+    logging::FileSink fileSink { "file", textPath.string().c_str() };
+
+    for (size_t threads : { size_t(1), kThreads }) {
+        bench::section(std::format("{} info() calls from {} threads", kCalls, threads));
+
+        {
+            logging::Category category { logging::eInfo, "asset" };
+            category.addSink(&fileSink);
+
+            auto start = bench::Clock::now();
+            run(category, threads);
+            report("FileSink", bench::toNanos(bench::Clock::now() - start), textSize);
+        }
+
+        {
+            // no text sinks so nothing is formatted, the time includes writing out the last buffer on close
+            logging::Category category { logging::eInfo, "asset" };
+
+            auto start = bench::Clock::now();
+
+            {
+                logging::BinarySink binarySink { binaryPath.string().c_str() };
+                run(category, threads);
+            }
+
+            report("BinarySink", bench::toNanos(bench::Clock::now() - start), std::filesystem::file_size(binaryPath));
+            std::filesystem::remove(binaryPath);
+        }
+
+        {
+            // full buffers are handed to the writer thread rather than written by whoever filled them
+            logging::Category category { logging::eInfo, "asset" };
+            logging::Writer writer {{ .overflow = logging::Overflow::eBlock }};
+
+            auto start = bench::Clock::now();
+
+            {
+                logging::BinarySink binarySink { binaryPath.string().c_str() };
+                run(category, threads);
+            }
+
+            report("BinarySink with a writer", bench::toNanos(bench::Clock::now() - start), std::filesystem::file_size(binaryPath));
+            std::filesystem::remove(binaryPath);
+        }
+    }
+
+    bench::section(std::format("{} info() calls from 1 thread, per call", kCalls));
+
+    reportLatency("BinarySink", binaryPath);
+
+    {
+        logging::Writer writer {{ .overflow = logging::Overflow::eBlock }};
+        reportLatency("BinarySink with a writer", binaryPath);
+    }
+
+    std::error_code error;
+    std::filesystem::remove(textPath, error);
+}
@@ -0,0 +1,93 @@
+#include "bench.h"
+
+#include "simcoe/memory/bitmap.h"
+
+#include <algorithm>
+#include <format>
+#include <random>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kBits = 1 << 20;
+    constexpr size_t kBatch = 1024;
+    constexpr size_t kRounds = 256;
+
+    constexpr double kOccupancy[] = { 0.01, 0.5, 0.99 };
+
+    // fills a map to the occupancy with the used bits scattered over it,
+    // then times releasing and reallocating random batches so occupancy stays put
+    template<typename M>
+    void run(const char *pzName, double occupancy) {
+        using Index = typename M::Index;
+
+        M map(kBits);
+        std::mt19937_64 rng(1);
+
+        std::vector<Index> live;
+        live.reserve(kBits);
+
+        for (size_t i = 0; i < kBits; i++) {
+            live.push_back(map.alloc());
+        }
+
+        std::shuffle(live.begin(), live.end(), rng);
+
+        size_t used = size_t(double(kBits) * occupancy);
+        for (size_t i = used; i < kBits; i++) {
+            map.release(live[i]);
+        }
+
+        live.resize(used);
+
+        double allocTime = 0.0;
+        double releaseTime = 0.0;
+        uint64_t check = 0;
+
+        std::vector<size_t> slots(kBatch);
+
+        for (size_t round = 0; round < kRounds; round++) {
+            for (size_t& slot : slots) {
+                slot = rng() % live.size();
+            }
+
+            // the same slot may come up twice in a batch, release each index once
+            std::sort(slots.begin(), slots.end());
+            slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+            auto start = bench::Clock::now();
+            for (size_t slot : slots) {
+                map.release(live[slot]);
+            }
+
+            auto middle = bench::Clock::now();
+            for (size_t slot : slots) {
+                live[slot] = map.alloc();
+            }
+
+            auto end = bench::Clock::now();
+
+            releaseTime += bench::toNanos(middle - start) / double(slots.size());
+            allocTime += bench::toNanos(end - middle) / double(slots.size());
+
+            check += size_t(live[slots.front()]);
+            slots.resize(kBatch);
+        }
+
+        bench::keep(check);
+
+        int percent = int(occupancy * 100.0);
+        bench::report(std::format("{} alloc @ {}%", pzName, percent), allocTime / kRounds);
+        bench::report(std::format("{} release @ {}%", pzName, percent), releaseTime / kRounds);
+    }
+}
+
+int main() {
+    bench::section("bitmap, 1M bits, random batches of 1024");
+
+    for (double occupancy : kOccupancy) {
+        run<memory::BitMap>("BitMap", occupancy);
+        run<memory::AtomicBitMap>("AtomicBitMap", occupancy);
+    }
+}
@@ -0,0 +1,121 @@
+#include "bench.h"
+
+#include "simcoe/threads/channel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <format>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kItems = 1 << 20;
+    constexpr size_t kThreads[] = { 2, 4, 8 };
+
+    // what a channel replaces, a deque behind a lock with a condition variable for the consumers
+    struct LockedQueue {
+        bool push(uint64_t item) {
+            {
+                std::lock_guard guard(mutex);
+                items.push_back(item);
+            }
+
+            ready.notify_one();
+            return true;
+        }
+
+        bool pop(uint64_t& item) {
+            std::unique_lock guard(mutex);
+            ready.wait(guard, [&] { return !items.empty() || closed; });
+
+            if (items.empty()) { return false; }
+
+            item = items.front();
+            items.pop_front();
+            return true;
+        }
+
+        void close() {
+            {
+                std::lock_guard guard(mutex);
+                closed = true;
+            }
+
+            ready.notify_all();
+        }
+
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<uint64_t> items;
+        bool closed = false;
+    };
+
+    // producers split kItems between them, consumers pop until the queue closes
+    template<typename Q>
+    double run(size_t producers, size_t consumers) {
+        Q queue;
+        std::atomic_uint64_t sum = 0;
+
+        auto start = bench::Clock::now();
+
+        {
+            std::vector<std::jthread> consuming;
+            for (size_t i = 0; i < consumers; i++) {
+                consuming.emplace_back([&] {
+                    uint64_t local = 0;
+                    uint64_t item = 0;
+                    while (queue.pop(item)) {
+                        local += item;
+                    }
+
+                    sum += local;
+                });
+            }
+
+            {
+                std::vector<std::jthread> producing;
+                for (size_t i = 0; i < producers; i++) {
+                    producing.emplace_back([&, i] {
+                        for (size_t item = i; item < kItems; item += producers) {
+                            queue.push(item);
+                        }
+                    });
+                }
+            }
+
+            queue.close();
+        }
+
+        double time = bench::toNanos(bench::Clock::now() - start);
+
+        ASSERT(sum == uint64_t(kItems) * (kItems - 1) / 2);
+        return time / kItems;
+    }
+}
+
+int main() {
+    bench::section(std::format("{} items, 1 producer, 1 consumer", kItems));
+
+    bench::report("Channel<eSPSC>", run<threads::Channel<uint64_t, threads::ChannelKind::eSPSC>>(1, 1), "ns/item");
+    bench::report("Channel<eMPSC>", run<threads::Channel<uint64_t, threads::ChannelKind::eMPSC>>(1, 1), "ns/item");
+    bench::report("Channel<eMPMC>", run<threads::Channel<uint64_t>>(1, 1), "ns/item");
+    bench::report("std::mutex + std::deque", run<LockedQueue>(1, 1), "ns/item");
+
+    for (size_t count : kThreads) {
+        bench::section(std::format("{} items, {} producers, 1 consumer", kItems, count));
+
+        bench::report("Channel<eMPSC>", run<threads::Channel<uint64_t, threads::ChannelKind::eMPSC>>(count, 1), "ns/item");
+        bench::report("std::mutex + std::deque", run<LockedQueue>(count, 1), "ns/item");
+    }
+
+    for (size_t count : kThreads) {
+        bench::section(std::format("{} items, {} producers, {} consumers", kItems, count, count));
+
+        bench::report("Channel<eMPMC>", run<threads::Channel<uint64_t>>(count, count), "ns/item");
+        bench::report("std::mutex + std::deque", run<LockedQueue>(count, count), "ns/item");
+    }
+}
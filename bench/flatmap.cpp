@@ -0,0 +1,97 @@
+#include "bench.h"
+
+#include "simcoe/memory/flatmap.h"
+
+#include <algorithm>
+#include <format>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kSizes[] = { 10, 100, 1'000, 10'000, 100'000, 1'000'000 };
+
+    // small maps are rebuilt until about this many operations have been timed
+    constexpr size_t kOperations = 2'000'000;
+
+    template<typename M>
+    void run(const char *pzName, size_t size) {
+        std::mt19937_64 rng(size);
+
+        std::vector<uint64_t> keys(size);
+        std::vector<uint64_t> misses(size);
+        for (size_t i = 0; i < size; i++) {
+            keys[i] = rng();
+            misses[i] = rng();
+        }
+
+        size_t repeats = std::max<size_t>(kOperations / size, 1);
+
+        // a fresh map each time so insert includes every rehash on the way up
+        double insert = 0.0;
+        for (size_t i = 0; i < repeats; i++) {
+            M map;
+
+            auto start = bench::Clock::now();
+            for (uint64_t key : keys) {
+                map[key] = key;
+            }
+
+            insert += bench::toNanos(bench::Clock::now() - start);
+            bench::keep(map.size());
+        }
+
+        M map;
+        for (uint64_t key : keys) {
+            map[key] = key;
+        }
+
+        // look keys up in a different order than they went in
+        std::vector<uint64_t> order = keys;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        double hit = bench::measure(repeats, [&](size_t) {
+            uint64_t sum = 0;
+            for (uint64_t key : order) {
+                sum += map.find(key)->second;
+            }
+
+            bench::keep(sum);
+        });
+
+        double miss = bench::measure(repeats, [&](size_t) {
+            uint64_t sum = 0;
+            for (uint64_t key : misses) {
+                sum += map.find(key) == map.end();
+            }
+
+            bench::keep(sum);
+        });
+
+        double iterate = bench::measure(repeats, [&](size_t) {
+            uint64_t sum = 0;
+            for (const auto& [key, value] : map) {
+                sum += value;
+            }
+
+            bench::keep(sum);
+        });
+
+        // measure gives the time for a whole pass over the keys
+        bench::report(std::format("{} insert", pzName), insert / double(repeats * size));
+        bench::report(std::format("{} lookup hit", pzName), hit / double(size));
+        bench::report(std::format("{} lookup miss", pzName), miss / double(size));
+        bench::report(std::format("{} iterate", pzName), iterate / double(size), "ns/item");
+    }
+}
+
+int main() {
+    for (size_t size : kSizes) {
+        bench::section(std::format("{} uint64 keys", size));
+
+        run<memory::FlatMap<uint64_t, uint64_t>>("FlatMap", size);
+        run<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map", size);
+    }
+}
@@ -0,0 +1,74 @@
+#include "bench.h"
+
+#include "simcoe/core/logging.h"
+
+#include <format>
+#include <string>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kCalls = 2'000'000;
+
+    // counts what reaches it so the work can't be thrown away
+    struct NullSink final : logging::IFilterSink {
+        NullSink() : IFilterSink("null") { }
+
+        void accept(logging::Category&, logging::Level, const char *pzMessage) override {
+            received += 1;
+            bench::keep(uint64_t(pzMessage[0]));
+        }
+
+        size_t received = 0;
+    };
+
+    // the arguments a typical asset warning carries
+    constexpr std::string_view kPath = "assets/textures/brick_albedo.dds";
+
+    // what info() did before the level check moved ahead of formatting,
+    // format into a fresh string and leave the filtering to the sink
+    void formatFirst(logging::Category& category, NullSink& sink, size_t i) {
+        std::string message = std::format("loaded {} in {}ms ({} mips)", kPath, float(i) * 0.25f, i % 12);
+        sink.send(category, logging::eInfo, message.c_str());
+    }
+
+    // the same fresh string but sent the way info() sends, through the category's locked sink list
+    void formatThenDispatch(logging::Category& category, size_t i) {
+        std::string message = std::format("loaded {} in {}ms ({} mips)", kPath, float(i) * 0.25f, i % 12);
+        category.dispatch(logging::eInfo, message.c_str());
+    }
+
+    void logInfo(logging::Category& category, size_t i) {
+        category.info("loaded {} in {}ms ({} mips)", kPath, float(i) * 0.25f, i % 12);
+    }
+}
+
+int main() {
+    NullSink sink;
+
+    logging::Category filtered { logging::eWarn, "filtered" };
+    filtered.addSink(&sink);
+
+    logging::Category unfiltered { logging::eInfo, "unfiltered" };
+    unfiltered.addSink(&sink);
+
+    logging::Category silent { logging::eInfo, "silent" };
+
+    bench::section(std::format("{} info() calls, below the category level", kCalls));
+
+    bench::report("format then filter in the sink", bench::measure(kCalls, [&](size_t i) { formatFirst(filtered, sink, i); }));
+    bench::report("level checked before formatting", bench::measure(kCalls, [&](size_t i) { logInfo(filtered, i); }));
+
+    bench::section(std::format("{} info() calls, at the category level", kCalls));
+
+    bench::report("format then filter in the sink", bench::measure(kCalls, [&](size_t i) { formatFirst(unfiltered, sink, i); }));
+    bench::report("fresh string then dispatch", bench::measure(kCalls, [&](size_t i) { formatThenDispatch(unfiltered, i); }));
+    bench::report("formatted into the thread local buffer", bench::measure(kCalls, [&](size_t i) { logInfo(unfiltered, i); }));
+    bench::report("no text sinks, nothing formatted", bench::measure(kCalls, [&](size_t i) { logInfo(silent, i); }));
+
+    if constexpr (logging::kMinLevel > logging::eInfo) {
+        bench::section("info() is below the log-level option in this build, the calls above compiled to nothing");
+    }
+
+    bench::keep(sink.received);
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+
+#include "simcoe/core/logwriter.h"
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kThreads = 8;
+    constexpr size_t kPerThread = 20'000;
+
+    struct Latency {
+        double p50;
+        double p99;
+        double p999;
+        double max;
+    };
+
+    double getPercentile(std::vector<uint64_t>& samples, double percentile) {
+        size_t index = std::min(samples.size() - 1, size_t(double(samples.size()) * percentile));
+        std::nth_element(samples.begin(), samples.begin() + ptrdiff_t(index), samples.end());
+        return double(samples[index]);
+    }
+
+    // every thread times each info() call on its own, the samples are merged afterwards
+    Latency run(logging::Category& category) {
+        std::vector<std::vector<uint64_t>> samples(kThreads);
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t t = 0; t < kThreads; t++) {
+                threads.emplace_back([&, t] {
+                    std::vector<uint64_t>& local = samples[t];
+                    local.reserve(kPerThread);
+
+                    for (size_t i = 0; i < kPerThread; i++) {
+                        auto start = bench::Clock::now();
+                        category.info("thread {} message {} with a little text after it", t, i);
+                        local.push_back(uint64_t(bench::toNanos(bench::Clock::now() - start)));
+                    }
+                });
+            }
+        }
+
+        std::vector<uint64_t> all;
+        for (const std::vector<uint64_t>& local : samples) {
+            all.insert(all.end(), local.begin(), local.end());
+        }
+
+        ASSERT(all.size() == kThreads * kPerThread);
+
+        return {
+            .p50 = getPercentile(all, 0.5),
+            .p99 = getPercentile(all, 0.99),
+            .p999 = getPercentile(all, 0.999),
+            .max = double(*std::max_element(all.begin(), all.end()))
+        };
+    }
+
+    void report(std::string_view name, const Latency& latency) {
+        bench::report(std::format("{} p50", name), latency.p50, "ns");
+        bench::report(std::format("{} p99", name), latency.p99, "ns");
+        bench::report(std::format("{} p99.9", name), latency.p999, "ns");
+        bench::report(std::format("{} max", name), latency.max, "ns");
+    }
+}
+
+int main() {
+    auto path = std::filesystem::temp_directory_path() / "simcoe-bench-logwriter.log";
+
+    {
+        // a real file rather than the console so the numbers don't depend on the terminal
+        logging::FileSink sink { "file", path.string().c_str() };
+        logging::Category category { logging::eInfo, "bench" };
+        category.addSink(&sink);
+
+        bench::section(std::format("{} threads, {} info() calls each, file sink", kThreads, kPerThread));
+
+        report("sync", run(category));
+
+        for (logging::Overflow overflow : { logging::Overflow::eBlock, logging::Overflow::eReport }) {
+            bool block = overflow == logging::Overflow::eBlock;
+
+            logging::Writer writer {{ .overflow = overflow }};
+
+            report(block ? "async, eBlock" : "async, eReport", run(category));
+
+            writer.flush();
+            bench::report(block ? "async, eBlock dropped" : "async, eReport dropped", double(writer.getDropped()), "records");
+        }
+    }
+
+    std::filesystem::remove(path);
+}
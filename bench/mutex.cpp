@@ -0,0 +1,93 @@
+#include "bench.h"
+
+#include "simcoe/core/panic.h"
+#include "simcoe/threads/mutex.h"
+
+#include <format>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kCalls = 10'000'000;
+    constexpr size_t kPerThread = 1'000'000;
+    constexpr size_t kThreads = 8;
+
+    // a critical section shaped like the ones in the engine, a few loads and stores
+    struct Shared {
+        uint64_t values[8] = {};
+
+        void touch(size_t i) {
+            values[i % 8] += i;
+            values[0] += 1;
+        }
+    };
+
+    template<typename M>
+    double uncontended() {
+        M mutex;
+        Shared shared;
+
+        double time = bench::measure(kCalls, [&](size_t i) {
+            std::lock_guard guard(mutex);
+            shared.touch(i);
+        });
+
+        bench::keep(shared.values[0]);
+        return time;
+    }
+
+    // every thread hammers the same lock, reports wall time per acquire across all threads
+    template<typename M>
+    double contended(size_t count) {
+        M mutex;
+        Shared shared;
+
+        auto start = bench::Clock::now();
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t t = 0; t < count; t++) {
+                threads.emplace_back([&] {
+                    for (size_t i = 0; i < kPerThread; i++) {
+                        std::lock_guard guard(mutex);
+                        shared.touch(i);
+                    }
+                });
+            }
+        }
+
+        double time = bench::toNanos(bench::Clock::now() - start);
+
+        ASSERT(shared.values[0] >= count * kPerThread);
+        return time / double(count * kPerThread);
+    }
+}
+
+int main() {
+    // libstdc++ skips locking entirely until the process has started a thread,
+    // the engine always has so make sure std::mutex pays for its atomics here too
+    std::jthread([] { }).join();
+
+    bench::section(std::format("{} uncontended lock + unlock", kCalls));
+
+    bench::report("threads::Mutex", uncontended<threads::Mutex>());
+    bench::report("std::mutex", uncontended<std::mutex>());
+
+    for (size_t count : { size_t(2), kThreads }) {
+        bench::section(std::format("{} threads, {} lock + unlock each", count, kPerThread));
+
+        bench::report("threads::Mutex", contended<threads::Mutex>(count), "ns/acquire");
+        bench::report("std::mutex", contended<std::mutex>(count), "ns/acquire");
+    }
+
+    if constexpr (threads::kLockStats) {
+        threads::LockStats stats = threads::getLockStats();
+        bench::section("threads::Mutex lock stats");
+        bench::report("contended", double(stats.contended), "acquires");
+        bench::report("spun", double(stats.spun), "acquires");
+        bench::report("parked", double(stats.parked), "sleeps");
+    }
+}
@@ -0,0 +1,154 @@
+#include "bench.h"
+
+#include "simcoe/core/name.h"
+#include "simcoe/memory/flatmap.h"
+#include "simcoe/memory/tracking.h"
+
+#include <format>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace simcoe;
+
+// the render graph needs d3d12, this builds the same shape of graph objects.
+// every pass and edge carries a name that is copied when the object is constructed,
+// passes are found by name in the graph's pass map
+namespace {
+    constexpr size_t kPasses = 10'000;
+    constexpr size_t kInputs = 3;
+    constexpr size_t kOutputs = 2;
+
+    struct Before {
+        static constexpr const char *kName = "std::string";
+
+        using Name = std::string;
+        template<typename K, typename V>
+        using Map = std::unordered_map<K, V>;
+    };
+
+    struct After {
+        static constexpr const char *kName = "util::Name";
+
+        using Name = util::Name;
+        template<typename K, typename V>
+        using Map = memory::FlatMap<K, V>;
+    };
+
+    template<typename L>
+    struct Object {
+        Object(typename L::Name name) : name(name) { }
+        Object(const Object& other) = default;
+
+        typename L::Name name;
+    };
+
+    template<typename L>
+    struct Edge : Object<L> {
+        Edge(const Object<L>& self, size_t pass) : Object<L>(self), pass(pass) { }
+
+        size_t pass;
+    };
+
+    template<typename L>
+    struct Pass : Object<L> {
+        using Object<L>::Object;
+
+        std::vector<std::unique_ptr<Edge<L>>> inputs;
+        std::vector<std::unique_ptr<Edge<L>>> outputs;
+    };
+
+    template<typename L>
+    using Graph = typename L::template Map<typename L::Name, std::unique_ptr<Pass<L>>>;
+
+    template<typename L>
+    Graph<L> build(const std::vector<std::string>& names) {
+        Graph<L> graph;
+
+        for (size_t i = 0; i < kPasses; i++) {
+            auto pPass = std::make_unique<Pass<L>>(names[i]);
+
+            for (size_t input = 0; input < kInputs; input++) {
+                Object<L> self { std::format("{}.in{}", names[i], input) };
+                pPass->inputs.emplace_back(new Edge<L>(self, (i * 7 + input) % kPasses));
+            }
+
+            for (size_t output = 0; output < kOutputs; output++) {
+                Object<L> self { std::format("{}.out{}", names[i], output) };
+                pPass->outputs.emplace_back(new Edge<L>(self, i));
+            }
+
+            typename L::Name name = pPass->name;
+            graph.try_emplace(name, std::move(pPass));
+        }
+
+        return graph;
+    }
+
+    template<typename L>
+    void run(const std::vector<std::string>& names) {
+        memory::TagScope scope(memory::eRender);
+        size_t live = memory::getTagStats(memory::eRender).live.b();
+        size_t text = util::Name::getStats().text.b();
+
+        // the first build interns every name, a rebuild finds them all already there
+        auto start = bench::Clock::now();
+        auto graph = build<L>(names);
+        double cold = bench::toNanos(bench::Clock::now() - start);
+
+        size_t bytes = memory::getTagStats(memory::eRender).live.b() - live;
+        size_t interned = util::Name::getStats().text.b() - text;
+
+        start = bench::Clock::now();
+        auto rebuild = build<L>(names);
+        double warm = bench::toNanos(bench::Clock::now() - start);
+
+        // every input edge resolved to its source pass by name, as the graph wires edges
+        std::vector<typename L::Name> keys;
+        for (const auto& name : names) {
+            keys.push_back(typename L::Name(name));
+        }
+
+        double lookup = bench::measure(kPasses, [&](size_t i) {
+            const auto& pPass = graph.find(keys[i])->second;
+
+            uint64_t sum = 0;
+            for (const auto& pInput : pPass->inputs) {
+                sum += graph.find(keys[pInput->pass])->second->outputs.size();
+            }
+
+            bench::keep(sum);
+        });
+
+        // the names share a long prefix so a string compare reads most of both
+        double compare = bench::measure(kPasses, [&](size_t i) {
+            const auto& pPass = rebuild.find(keys[i])->second;
+            bench::keep((pPass->name == keys[i]) + (pPass->name == keys[kPasses - i - 1]));
+        });
+
+        bench::report(std::format("{} build", L::kName), cold / 1'000'000.0, "ms");
+        bench::report(std::format("{} rebuild", L::kName), warm / 1'000'000.0, "ms");
+        bench::report(std::format("{} heap", L::kName), double(bytes) / 1024.0, "kb");
+        bench::report(std::format("{} interned text", L::kName), double(interned) / 1024.0, "kb");
+        bench::report(std::format("{} lookup pass + inputs", L::kName), lookup);
+        bench::report(std::format("{} lookup + 2 compares", L::kName), compare);
+    }
+}
+
+int main() {
+    if constexpr (!memory::kAllocTracking) {
+        std::printf("alloc tracking is disabled, configure with -Dalloc-tracking=enabled for the heap size\n");
+    }
+
+    // long enough that std::string cant keep them inline
+    std::vector<std::string> names;
+    for (size_t i = 0; i < kPasses; i++) {
+        names.push_back(std::format("render/pass/postprocess.{:05}", i));
+    }
+
+    bench::section(std::format("synthetic graph, {} passes, {} edges each", kPasses, kInputs + kOutputs));
+
+    run<Before>(names);
+    run<After>(names);
+}
@@ -0,0 +1,130 @@
+#include "bench.h"
+
+#include "simcoe/memory/pool.h"
+
+#include <format>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kLive = 1024;
+    constexpr size_t kRounds = 2048;
+
+    constexpr size_t kThreads = 8;
+    constexpr size_t kPerProducer = 1 << 18;
+    constexpr size_t kBatch = 64;
+
+    struct Object {
+        uint64_t data[6];
+    };
+
+    struct Pool {
+        static Object *create(uint64_t value) { return memory::ObjectPool<Object>::create(Object { { value } }); }
+        static void destroy(Object *ptr) { memory::ObjectPool<Object>::destroy(ptr); }
+    };
+
+    struct Heap {
+        static Object *create(uint64_t value) { return new Object { { value } }; }
+        static void destroy(Object *ptr) { delete ptr; }
+    };
+
+    // allocate a batch, free it in the same order, repeat
+    template<typename A>
+    double single() {
+        std::vector<Object*> live(kLive);
+
+        double total = bench::measure(kRounds, [&](size_t round) {
+            for (size_t i = 0; i < kLive; i++) {
+                live[i] = A::create(round + i);
+            }
+
+            bench::keep(live[round % kLive]->data[0]);
+
+            for (Object *ptr : live) {
+                A::destroy(ptr);
+            }
+        });
+
+        return total / kLive;
+    }
+
+    // half the threads allocate batches and hand them over, the other half free them.
+    // every object is freed on a different thread than the one that made it
+    template<typename A>
+    double producerConsumer() {
+        std::mutex mutex;
+        std::vector<std::vector<Object*>> batches;
+        size_t producing = kThreads / 2;
+
+        auto producer = [&](size_t id) {
+            std::vector<Object*> batch;
+
+            for (size_t i = 0; i < kPerProducer; i++) {
+                batch.push_back(A::create(id + i));
+
+                if (batch.size() == kBatch) {
+                    std::lock_guard guard(mutex);
+                    batches.push_back(std::move(batch));
+                    batch.clear();
+                }
+            }
+
+            std::lock_guard guard(mutex);
+            producing -= 1;
+        };
+
+        auto consumer = [&] {
+            std::vector<Object*> batch;
+
+            while (true) {
+                {
+                    std::lock_guard guard(mutex);
+                    if (!batches.empty()) {
+                        batch = std::move(batches.back());
+                        batches.pop_back();
+                    } else if (producing == 0) {
+                        return;
+                    }
+                }
+
+                if (batch.empty()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                for (Object *ptr : batch) {
+                    A::destroy(ptr);
+                }
+
+                batch.clear();
+            }
+        };
+
+        auto start = bench::Clock::now();
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i = 0; i < kThreads / 2; i++) {
+                threads.emplace_back(producer, i);
+                threads.emplace_back(consumer);
+            }
+        }
+
+        return bench::toNanos(bench::Clock::now() - start) / double(kPerProducer * (kThreads / 2));
+    }
+}
+
+int main() {
+    bench::section(std::format("object pool, {} byte objects", sizeof(Object)));
+
+    bench::report(std::format("ObjectPool, batches of {}", kLive), single<Pool>());
+    bench::report(std::format("new/delete, batches of {}", kLive), single<Heap>());
+
+    bench::section(std::format("{} producers, {} consumers, batches of {}", kThreads / 2, kThreads / 2, kBatch));
+
+    bench::report("ObjectPool", producerConsumer<Pool>());
+    bench::report("new/delete", producerConsumer<Heap>());
+}
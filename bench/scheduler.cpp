@@ -0,0 +1,102 @@
+#include "bench.h"
+
+#include "simcoe/threads/scheduler.h"
+
+#include <atomic>
+#include <format>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kWorkers[] = { 0, 1, 3, 7 };
+
+    constexpr size_t kJobs = 100'000;
+    constexpr size_t kItems = 1'000'000;
+    constexpr size_t kOuter = 256;
+    constexpr size_t kInner = 4096;
+    constexpr size_t kRepeats = 8;
+
+    // a little arithmetic so jobs are not completely empty
+    uint64_t work(uint64_t value) {
+        for (size_t i = 0; i < 16; i++) {
+            value = value * 6364136223846793005ull + 1442695040888963407ull;
+        }
+
+        return value;
+    }
+
+    // one thread submits every job into a single counter then waits on it
+    double fanOut(threads::Scheduler& scheduler) {
+        std::atomic_uint64_t sum = 0;
+
+        double time = bench::measure(kRepeats, [&](size_t) {
+            threads::Counter counter;
+            for (size_t i = 0; i < kJobs; i++) {
+                scheduler.submit([&sum, i] { sum.fetch_add(work(i), std::memory_order_relaxed); }, &counter);
+            }
+
+            scheduler.wait(counter);
+        });
+
+        bench::keep(sum);
+        return time / kJobs;
+    }
+
+    // parallelFor over cheap items, at a grain of 1 every item is its own job
+    double fineGrained(threads::Scheduler& scheduler, size_t grain) {
+        std::vector<uint64_t> results(kItems);
+
+        double time = bench::measure(kRepeats, [&](size_t) {
+            scheduler.parallelFor(0, kItems, [&](size_t i) { results[i] = work(i); }, grain);
+        });
+
+        bench::keep(results[kItems / 2]);
+        return time / kItems;
+    }
+
+    // parallelFor inside parallelFor, the inner waits run jobs on whichever thread is waiting
+    double nested(threads::Scheduler& scheduler) {
+        std::vector<uint64_t> results(kOuter * kInner);
+
+        double time = bench::measure(kRepeats, [&](size_t) {
+            scheduler.parallelFor(0, kOuter, [&](size_t outer) {
+                scheduler.parallelFor(0, kInner, [&](size_t inner) {
+                    results[outer * kInner + inner] = work(inner);
+                });
+            }, 1);
+        });
+
+        bench::keep(results[kInner]);
+        return time / double(kOuter * kInner);
+    }
+
+    double serial() {
+        std::vector<uint64_t> results(kItems);
+
+        double time = bench::measure(kRepeats, [&](size_t) {
+            for (size_t i = 0; i < kItems; i++) {
+                results[i] = work(i);
+            }
+        });
+
+        bench::keep(results[kItems / 2]);
+        return time / kItems;
+    }
+}
+
+int main() {
+    bench::section(std::format("serial, {} items", kItems));
+    bench::report("loop", serial(), "ns/item");
+
+    for (size_t workers : kWorkers) {
+        threads::Scheduler scheduler(workers);
+
+        bench::section(std::format("{} threads", scheduler.getThreadCount()));
+
+        bench::report(std::format("fan out {} jobs", kJobs), fanOut(scheduler), "ns/job");
+        bench::report(std::format("parallelFor {}, grain 1", kItems), fineGrained(scheduler, 1), "ns/item");
+        bench::report(std::format("parallelFor {}, auto grain", kItems), fineGrained(scheduler, 0), "ns/item");
+        bench::report(std::format("nested parallelFor {}x{}", kOuter, kInner), nested(scheduler), "ns/item");
+    }
+}
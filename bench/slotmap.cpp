@@ -0,0 +1,150 @@
+#include "bench.h"
+
+#include "simcoe/memory/slotmap.h"
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kSize = 100'000;
+    constexpr size_t kBatch = 256;
+    constexpr size_t kRounds = 64;
+    constexpr size_t kPasses = 64;
+
+    // the slot map the generational one replaced, kept as it was apart from
+    // sizing its storage with size rather than a wordCount() it never had
+    namespace baseline {
+        template<typename T, T Empty = T()>
+        struct SlotMap final {
+            enum struct Index : size_t { eInvalid = SIZE_MAX };
+
+            SlotMap(size_t size) : size(size), pSlots(new T[size]) {
+                std::fill_n(pSlots.get(), size, Empty);
+            }
+
+            size_t getSize() const { return size; }
+
+            Index alloc(const T& value) {
+                for (size_t i = 0; i < getSize(); ++i) {
+                    if (pSlots[i] == Empty) {
+                        pSlots[i] = value;
+                        return Index(i);
+                    }
+                }
+
+                return Index::eInvalid;
+            }
+
+            void release(Index index) {
+                ASSERT(get(index) != Empty);
+                set(index, Empty);
+            }
+
+            T get(Index index) const {
+                ASSERT(index != Index::eInvalid);
+                return pSlots[size_t(index)];
+            }
+
+            void set(Index index, const T& value) {
+                ASSERT(index != Index::eInvalid);
+                pSlots[size_t(index)] = value;
+            }
+
+            size_t size;
+            std::unique_ptr<T[]> pSlots;
+        };
+    }
+
+    // every slot in use, then release and refill random batches so the map stays full
+    template<typename M>
+    double churn(M& map, std::vector<typename M::Index>& live) {
+        std::mt19937_64 rng(1);
+        std::vector<size_t> picks(kBatch);
+
+        double total = 0.0;
+
+        for (size_t round = 0; round < kRounds; round++) {
+            for (size_t& pick : picks) {
+                pick = rng() % live.size();
+            }
+
+            std::sort(picks.begin(), picks.end());
+            picks.erase(std::unique(picks.begin(), picks.end()), picks.end());
+
+            auto start = bench::Clock::now();
+            for (size_t pick : picks) {
+                map.release(live[pick]);
+            }
+
+            for (size_t pick : picks) {
+                live[pick] = map.alloc(pick + 1);
+            }
+
+            total += bench::toNanos(bench::Clock::now() - start) / double(picks.size());
+            picks.resize(kBatch);
+        }
+
+        return total / kRounds;
+    }
+
+    void runBaseline() {
+        using Map = baseline::SlotMap<uint64_t>;
+
+        Map map(kSize);
+        std::vector<Map::Index> live;
+        for (size_t i = 0; i < kSize; i++) {
+            live.push_back(map.alloc(i + 1));
+        }
+
+        bench::report("old SlotMap alloc+release", churn(map, live));
+
+        // iteration has to visit every slot and skip the empty ones
+        double iterate = bench::measure(kPasses, [&](size_t) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < map.getSize(); i++) {
+                if (uint64_t value = map.pSlots[i]; value != 0) {
+                    sum += value;
+                }
+            }
+
+            bench::keep(sum);
+        });
+
+        bench::report("old SlotMap iterate", iterate / kSize, "ns/item");
+    }
+
+    void runGenerational() {
+        using Map = memory::SlotMap<uint64_t>;
+
+        Map map(kSize);
+        std::vector<Map::Index> live;
+        for (size_t i = 0; i < kSize; i++) {
+            live.push_back(map.alloc(i + 1));
+        }
+
+        bench::report("SlotMap alloc+release", churn(map, live));
+
+        double iterate = bench::measure(kPasses, [&](size_t) {
+            uint64_t sum = 0;
+            for (uint64_t value : map) {
+                sum += value;
+            }
+
+            bench::keep(sum);
+        });
+
+        bench::report("SlotMap iterate", iterate / kSize, "ns/item");
+    }
+}
+
+int main() {
+    bench::section(std::format("slot map, {} live values, random batches of {}", kSize, kBatch));
+
+    runBaseline();
+    runGenerational();
+}
@@ -0,0 +1,154 @@
+#include "bench.h"
+
+#include "simcoe/memory/smallvector.h"
+#include "simcoe/memory/tracking.h"
+
+#include <format>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace simcoe;
+
+// the render graph needs d3d12, this rebuilds its shape out of the same lists.
+// passes own their edges through small lists, every frame each pass gathers
+// the barriers for its inputs, and loading a scene fills node child and primitive lists.
+// heap allocations are counted through the tracking allocator
+namespace {
+    constexpr size_t kPasses = 10'000;
+    constexpr size_t kNodes = 100'000;
+    constexpr size_t kFrames = 16;
+
+    struct Before {
+        static constexpr const char *kName = "std::vector";
+
+        template<typename T, size_t N>
+        using List = std::vector<T>;
+    };
+
+    struct After {
+        static constexpr const char *kName = "SmallVector";
+
+        template<typename T, size_t N>
+        using List = memory::SmallVector<T, N>;
+    };
+
+    struct Edge {
+        size_t source;
+        int state;
+    };
+
+    // the same size as a D3D12_RESOURCE_BARRIER
+    struct Barrier {
+        void *pResource;
+        int before;
+        int after;
+        uint64_t reserved[2];
+    };
+
+    template<typename L>
+    struct Pass {
+        typename L::template List<std::unique_ptr<Edge>, 4> inputs;
+        typename L::template List<std::unique_ptr<Edge>, 4> outputs;
+    };
+
+    template<typename L>
+    struct Node {
+        typename L::template List<size_t, 8> children;
+        typename L::template List<size_t, 8> primitives;
+    };
+
+    struct Result {
+        double time;
+        size_t allocs;
+    };
+
+    template<typename F>
+    Result count(F&& fn) {
+        memory::TagScope scope(memory::eRender);
+        size_t before = memory::getTagStats(memory::eRender).allocs;
+
+        auto start = bench::Clock::now();
+        fn();
+        double time = bench::toNanos(bench::Clock::now() - start);
+
+        return Result { time, memory::getTagStats(memory::eRender).allocs - before };
+    }
+
+    void report(const char *pzList, const char *pzStage, Result result, size_t items) {
+        bench::report(std::format("{} {}", pzList, pzStage), result.time / double(items));
+        bench::report(std::format("{} {} allocs", pzList, pzStage), double(result.allocs), "allocs");
+    }
+
+    template<typename L>
+    void run() {
+        std::mt19937_64 rng(1);
+        std::vector<Pass<L>> passes(kPasses);
+
+        auto build = count([&] {
+            for (size_t i = 0; i < kPasses; i++) {
+                size_t inputs = 1 + rng() % 3;
+                size_t outputs = 1 + rng() % 2;
+
+                for (size_t input = 0; input < inputs; input++) {
+                    passes[i].inputs.emplace_back(new Edge { rng() % kPasses, int(rng() % 4) });
+                }
+
+                for (size_t output = 0; output < outputs; output++) {
+                    passes[i].outputs.emplace_back(new Edge { i, int(rng() % 4) });
+                }
+            }
+        });
+
+        auto frames = count([&] {
+            for (size_t frame = 0; frame < kFrames; frame++) {
+                for (auto& pass : passes) {
+                    typename L::template List<Barrier, 8> barriers;
+
+                    for (auto& input : pass.inputs) {
+                        const auto& source = passes[input->source].outputs.front();
+                        if (source->state == input->state) { continue; }
+
+                        barriers.push_back(Barrier { source.get(), source->state, input->state, { } });
+                    }
+
+                    bench::keep(barriers.size());
+                }
+            }
+        });
+
+        auto load = count([&] {
+            std::vector<Node<L>> nodes(kNodes);
+
+            for (size_t i = 0; i < kNodes; i++) {
+                size_t children = rng() % 4;
+                size_t primitives = 1 + rng() % 3;
+
+                for (size_t child = 0; child < children; child++) {
+                    nodes[i].children.push_back(rng() % kNodes);
+                }
+
+                for (size_t primitive = 0; primitive < primitives; primitive++) {
+                    nodes[i].primitives.push_back(rng() % kNodes);
+                }
+            }
+
+            bench::keep(nodes.back().primitives.size());
+        });
+
+        report(L::kName, "graph build", build, kPasses);
+        report(L::kName, "barriers", frames, kPasses * kFrames);
+        report(L::kName, "scene load", load, kNodes);
+    }
+}
+
+int main() {
+    if constexpr (!memory::kAllocTracking) {
+        std::printf("alloc tracking is disabled, configure with -Dalloc-tracking=enabled for the allocation counts\n");
+    }
+
+    bench::section(std::format("render graph lists, {} passes, {} frames, {} nodes", kPasses, kFrames, kNodes));
+
+    run<Before>();
+    run<After>();
+}
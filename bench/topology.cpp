@@ -0,0 +1,133 @@
+#include "bench.h"
+
+#include "simcoe/core/topology.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <format>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::os::threads;
+
+namespace {
+    constexpr size_t kFrames = 300;
+    constexpr size_t kWork = 300'000; // about a millisecond of arithmetic per frame
+
+    // the same amount of work every frame, so any spread in frame time comes from the scheduler
+    uint64_t frame(uint64_t seed) {
+        uint64_t x = seed | 1;
+        for (size_t i = 0; i < kWork; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+
+        return x;
+    }
+
+    struct Spread {
+        double mean;
+        double p50;
+        double p99;
+        double deviation;
+    };
+
+    Spread getSpread(std::vector<double> times) {
+        double sum = 0.0;
+        for (double time : times) { sum += time; }
+        double mean = sum / double(times.size());
+
+        double squares = 0.0;
+        for (double time : times) { squares += (time - mean) * (time - mean); }
+
+        std::sort(times.begin(), times.end());
+
+        return {
+            .mean = mean,
+            .p50 = times[times.size() / 2],
+            .p99 = times[std::min(times.size() - 1, times.size() * 99 / 100)],
+            .deviation = std::sqrt(squares / double(times.size()))
+        };
+    }
+
+    const char *getAppliedName(Applied applied) {
+        switch (applied) {
+        case Applied::eAll: return "applied";
+        case Applied::eDenied: return "priority denied";
+        default: return "failed";
+        }
+    }
+
+    // runs the frames on a fresh thread so one placement doesn't carry over into the next
+    Spread run(const Placement *pPlacement, Applied& applied) {
+        std::vector<double> times;
+        times.reserve(kFrames);
+
+        std::thread thread([&] {
+            applied = Applied::eAll;
+            if (pPlacement != nullptr) {
+                Info info;
+                info.roles[eMain] = *pPlacement;
+                applied = setup(eMain, info);
+            }
+
+            for (size_t i = 0; i < kFrames; i++) {
+                auto start = bench::Clock::now();
+                bench::keep(frame(i));
+                times.push_back(bench::toNanos(bench::Clock::now() - start) / 1000.0);
+            }
+        });
+
+        thread.join();
+        return getSpread(times);
+    }
+
+    void report(std::string_view name, const Spread& spread, Applied applied) {
+        bench::section(std::format("{} ({})", name, getAppliedName(applied)));
+        bench::report("mean", spread.mean, "us");
+        bench::report("p50", spread.p50, "us");
+        bench::report("p99", spread.p99, "us");
+        bench::report("standard deviation", spread.deviation, "us");
+    }
+}
+
+int main() {
+    const Topology& topology = getTopology();
+
+    // one more busy thread than there are logical processors so the frame thread always has company
+    size_t noiseCount = topology.logicalCount + 1;
+
+    std::atomic_bool running = true;
+    std::vector<std::jthread> noise;
+    for (size_t i = 0; i < noiseCount; i++) {
+        noise.emplace_back([&, i] {
+            uint64_t x = i + 1;
+            while (running.load(std::memory_order_relaxed)) {
+                x = frame(x) >> 32;
+                bench::keep(x);
+            }
+        });
+    }
+
+    std::printf("%zu frames of fixed work against %zu noise threads on %zu logical processors\n",
+        kFrames, noiseCount, topology.logicalCount);
+
+    const Placement pinned = { Affinity::ePinned, Priority::eNormal, 0 };
+    const Placement raised = { Affinity::ePinned, Priority::eHigh, 0 };
+
+    Applied applied = Applied::eAll;
+
+    Spread spread = run(nullptr, applied);
+    report("default placement", spread, applied);
+
+    spread = run(&pinned, applied);
+    report("pinned to core 0", spread, applied);
+
+    spread = run(&raised, applied);
+    report("pinned to core 0, high priority", spread, applied);
+
+    running = false;
+}
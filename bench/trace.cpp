@@ -0,0 +1,55 @@
+#include "bench.h"
+
+#include "simcoe/core/trace.h"
+
+#include <algorithm>
+#include <format>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kZones = 10'000'000;
+
+    // less than a ring holds, so a capture never loses zones
+    constexpr size_t kRecorded = trace::kRingSize / 2;
+
+    void zone(size_t i) {
+        SIMCOE_ZONE("bench");
+        bench::keep(i);
+    }
+
+    void nothing(size_t i) {
+        bench::keep(i);
+    }
+}
+
+int main() {
+    if constexpr (!trace::kEnabled) {
+        std::printf("tracing is compiled out, SIMCOE_ZONE costs nothing. configure with -Dtrace=enabled\n");
+        return 0;
+    }
+
+    bench::section(std::format("{} zones, no capture running (target under 20 ns)", kZones));
+
+    bench::report("empty loop", bench::measure(kZones, nothing));
+    bench::report("idle zone", bench::measure(kZones, zone));
+
+    bench::section(std::format("{} zones while recording (target under 20 ns)", kRecorded));
+
+    // the first zone on a thread allocates its ring, keep that out of the timing
+    trace::start();
+    zone(0);
+
+    // best of a few runs, each restarts the capture so the ring never fills
+    double best = 0.0;
+    for (int run = 0; run < 8; run++) {
+        trace::start();
+        double time = bench::measure(kRecorded, zone);
+        trace::stop();
+
+        best = (run == 0) ? time : std::min(best, time);
+    }
+
+    bench::report("recording zone", best);
+    bench::report("one timestamp, a zone takes two", bench::measure(kRecorded, [](size_t) { bench::keep(trace::detail::now()); }));
+}
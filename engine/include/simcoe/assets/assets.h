@@ -1,6 +1,8 @@
 #pragma once
 
 #include "simcoe/math/math.h"
+#include "simcoe/memory/smallvector.h"
+#include "simcoe/threads/scheduler.h"
 
 #include "simcoe/simcoe.h"
 
@@ -27,11 +29,14 @@ namespace simcoe::assets {
         size_t texture;
     };
 
+    // nodes rarely reference more than a few children or primitives
+    using IndexList = memory::SmallVector<size_t, 8>;
+
     struct Node {
         math::float4x4 transform;
 
-        std::vector<size_t> children;
-        std::vector<size_t> primitives;
+        IndexList children;
+        IndexList primitives;
     };
 
     struct IScene {
@@ -59,7 +64,10 @@ namespace simcoe::assets {
     };
 
     struct Manager {
-        Manager(const std::filesystem::path& root) : root(root) {}
+        Manager(const std::filesystem::path& root, threads::Scheduler& scheduler)
+            : root(root)
+            , scheduler(scheduler)
+        { }
 
         template<typename T>
         std::vector<T> loadBlob(const std::filesystem::path& path) {
@@ -102,5 +110,6 @@ namespace simcoe::assets {
 
     private:
         std::filesystem::path root;
+        threads::Scheduler& scheduler;
     };
 }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "simcoe/threads/scheduler.h"
+
+#include <coroutine>
+
+namespace simcoe::async {
+    // decides where a suspended coroutine resumes
+    struct IExecutor {
+        virtual ~IExecutor() = default;
+
+        virtual void post(std::coroutine_handle<> handle) = 0;
+    };
+
+    // resumes straight away on the posting thread
+    struct InlineExecutor final : IExecutor {
+        void post(std::coroutine_handle<> handle) override {
+            handle.resume();
+        }
+    };
+
+    // resumes as a job on the scheduler
+    struct SchedulerExecutor final : IExecutor {
+        SchedulerExecutor(threads::Scheduler& scheduler)
+            : scheduler(scheduler)
+        { }
+
+        void post(std::coroutine_handle<> handle) override {
+            scheduler.submit([handle] { handle.resume(); });
+        }
+
+    private:
+        threads::Scheduler& scheduler;
+    };
+
+    struct ScheduleAwaiter {
+        IExecutor& executor;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+        void await_resume() const noexcept { }
+    };
+
+    // co_await to continue the current coroutine on an executor
+    inline ScheduleAwaiter schedule(IExecutor& executor) {
+        return { executor };
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "simcoe/async/task.h"
+
+#include <iterator>
+#include <memory>
+
+namespace simcoe::async {
+    // synchronous sequence produced by co_yield, the body runs a step each time the iterator advances
+    template<typename T>
+    struct [[nodiscard]] Generator {
+        using value_type = std::remove_cvref_t<T>;
+        using pointer = std::add_pointer_t<std::remove_reference_t<T>>;
+
+        struct promise_type : detail::PooledPromise {
+            Generator get_return_object() noexcept {
+                return Generator { std::coroutine_handle<promise_type>::from_promise(*this) };
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return { }; }
+            std::suspend_always final_suspend() const noexcept { return { }; }
+
+            // temporaries live in the frame until the next resume so pointing at them is fine
+            std::suspend_always yield_value(std::remove_reference_t<T>& value) noexcept {
+                pValue = std::addressof(value);
+                return { };
+            }
+
+            std::suspend_always yield_value(std::remove_reference_t<T>&& value) noexcept {
+                pValue = std::addressof(value);
+                return { };
+            }
+
+            void return_void() noexcept { }
+            void unhandled_exception() const noexcept { std::terminate(); }
+
+            // generators are synchronous, awaiting inside one is a mistake
+            template<typename U>
+            std::suspend_never await_transform(U&&) = delete;
+
+            pointer pValue = nullptr;
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        struct Sentinel { };
+
+        struct Iterator {
+            using iterator_category = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = Generator::value_type;
+
+            Handle handle;
+
+            Iterator& operator++() {
+                handle.resume();
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            std::remove_reference_t<T>& operator*() const { return *handle.promise().pValue; }
+            pointer operator->() const { return handle.promise().pValue; }
+
+            bool operator==(Sentinel) const { return handle.done(); }
+        };
+
+        Generator() = default;
+
+        explicit Generator(Handle handle)
+            : handle(handle)
+        { }
+
+        Generator(Generator&& other) noexcept
+            : handle(std::exchange(other.handle, nullptr))
+        { }
+
+        Generator& operator=(Generator&& other) noexcept {
+            if (this != &other) {
+                destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~Generator() {
+            destroy();
+        }
+
+        Iterator begin() {
+            handle.resume();
+            return { handle };
+        }
+
+        Sentinel end() { return { }; }
+
+    private:
+        void destroy() {
+            if (handle) {
+                handle.destroy();
+                handle = nullptr;
+            }
+        }
+
+        Handle handle = nullptr;
+    };
+}
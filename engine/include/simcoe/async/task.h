@@ -0,0 +1,219 @@
+#pragma once
+
+#include "simcoe/async/executor.h"
+
+#include "simcoe/memory/pool.h"
+#include "simcoe/threads/mutex.h"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace simcoe::async {
+    template<typename T = void>
+    struct Task;
+
+    namespace detail {
+        // void results are stored as monostate so containers of results stay regular
+        template<typename T>
+        using Result = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        // coroutine frames are recycled through the object pool rather than the global heap
+        struct PooledPromise {
+            static void *operator new(size_t size) {
+                return memory::detail::poolAlloc(size);
+            }
+
+            static void operator delete(void *ptr, size_t size) {
+                memory::detail::poolFree(ptr, size);
+            }
+        };
+
+        struct TaskPromiseBase : PooledPromise {
+            // hand control straight to whoever awaited us
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+
+                template<typename P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+                    std::coroutine_handle<> next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept { }
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return { }; }
+            FinalAwaiter final_suspend() const noexcept { return { }; }
+
+            // exceptions are disabled
+            void unhandled_exception() const noexcept { std::terminate(); }
+
+            std::coroutine_handle<> continuation;
+        };
+
+        template<typename T>
+        struct TaskPromise : TaskPromiseBase {
+            Task<T> get_return_object() noexcept;
+
+            template<typename V> requires std::is_convertible_v<V&&, T>
+            void return_value(V&& it) {
+                value.emplace(std::forward<V>(it));
+            }
+
+            T& result() { return *value; }
+
+        private:
+            std::optional<T> value;
+        };
+
+        template<>
+        struct TaskPromise<void> : TaskPromiseBase {
+            Task<void> get_return_object() noexcept;
+
+            void return_void() noexcept { }
+            void result() noexcept { }
+        };
+
+        // eagerly started coroutine that frees itself once it finishes
+        struct Detached {
+            struct promise_type : PooledPromise {
+                Detached get_return_object() noexcept { return { }; }
+
+                std::suspend_never initial_suspend() const noexcept { return { }; }
+                std::suspend_never final_suspend() const noexcept { return { }; }
+
+                void return_void() noexcept { }
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+    }
+
+    // lazily started coroutine. it runs when awaited and resumes the awaiter when it finishes,
+    // it only changes thread if it awaits something that does, such as schedule()
+    template<typename T>
+    struct [[nodiscard]] Task {
+        using promise_type = detail::TaskPromise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+
+        explicit Task(Handle handle)
+            : handle(handle)
+        { }
+
+        Task(Task&& other) noexcept
+            : handle(std::exchange(other.handle, nullptr))
+        { }
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~Task() {
+            destroy();
+        }
+
+        bool isReady() const { return !handle || handle.done(); }
+
+        auto operator co_await() & noexcept { return Awaiter<false> { handle }; }
+        auto operator co_await() && noexcept { return Awaiter<true> { handle }; }
+
+    private:
+        template<bool Move>
+        struct Awaiter {
+            // awaiting an rvalue task moves the result out, an lvalue task keeps it
+            using Result = std::conditional_t<Move, T, std::add_lvalue_reference_t<T>>;
+
+            Handle handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            Result await_resume() {
+                if constexpr (std::is_void_v<T>) {
+                    return;
+                } else if constexpr (Move) {
+                    return std::move(handle.promise().result());
+                } else {
+                    return handle.promise().result();
+                }
+            }
+        };
+
+        void destroy() {
+            if (handle) {
+                handle.destroy();
+                handle = nullptr;
+            }
+        }
+
+        Handle handle = nullptr;
+    };
+
+    template<typename T>
+    Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+        return Task<T> { std::coroutine_handle<TaskPromise>::from_promise(*this) };
+    }
+
+    inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+        return Task<void> { std::coroutine_handle<TaskPromise>::from_promise(*this) };
+    }
+
+    namespace detail {
+        // run a task to completion, store its result then call notify.
+        // notify is the last thing that touches the task or slot, so it may release them
+        template<typename T, typename F>
+        Detached runAndNotify(Task<T>& task, std::optional<Result<T>>& slot, F notify) {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                slot.emplace();
+            } else {
+                slot.emplace(co_await std::move(task));
+            }
+
+            notify();
+        }
+
+        inline Detached runDetached(IExecutor& executor, Task<> task) {
+            co_await schedule(executor);
+            co_await task;
+        }
+    }
+
+    // start a task on an executor without waiting for it, the frame is freed once it finishes
+    inline void spawn(IExecutor& executor, Task<> task) {
+        detail::runDetached(executor, std::move(task));
+    }
+
+    // block the calling thread until the task finishes.
+    // the task runs on this thread until it first moves to an executor
+    template<typename T>
+    T syncWait(Task<T> task) {
+        threads::Event done;
+
+        std::optional<detail::Result<T>> result;
+
+        detail::runAndNotify(task, result, [&] {
+            done.set();
+        });
+
+        done.wait();
+
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*result);
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "simcoe/async/task.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace simcoe::async {
+    namespace detail {
+        // resumes the awaiting coroutine once every child and the awaiter itself have arrived.
+        // the awaiter arrives last in await_suspend so a child finishing early never resumes it too soon
+        struct Gate {
+            std::atomic_size_t remaining;
+            std::coroutine_handle<> continuation = nullptr;
+
+            void arrive() {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    continuation.resume();
+                }
+            }
+        };
+
+        template<typename F>
+        struct GateAwaiter {
+            Gate& gate;
+            F start;
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> handle) {
+                gate.continuation = handle;
+                start();
+                return gate.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+            }
+
+            void await_resume() const noexcept { }
+        };
+
+        template<typename F>
+        GateAwaiter<F> startAll(Gate& gate, F&& start) {
+            return { gate, std::forward<F>(start) };
+        }
+
+        template<typename T>
+        struct AnyState {
+            std::vector<Task<T>> tasks;
+            std::vector<std::optional<Result<T>>> results;
+
+            std::atomic_size_t winner = SIZE_MAX;
+            Gate gate { 2 };
+        };
+    }
+
+    template<typename T>
+    struct AnyResult {
+        size_t index;
+        detail::Result<T> value;
+    };
+
+    // start every task and resume once all of them have finished
+    template<typename... T>
+    Task<std::tuple<detail::Result<T>...>> when_all(Task<T>... tasks) {
+        std::tuple<std::optional<detail::Result<T>>...> results;
+        detail::Gate gate { sizeof...(T) + 1 };
+
+        auto refs = std::tie(tasks...);
+
+        co_await detail::startAll(gate, [&] {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (detail::runAndNotify(std::get<I>(refs), std::get<I>(results), [&gate] { gate.arrive(); }), ...);
+            }(std::index_sequence_for<T...>{});
+        });
+
+        co_return std::apply([](auto&... result) {
+            return std::tuple<detail::Result<T>...> { std::move(*result)... };
+        }, results);
+    }
+
+    template<typename T>
+    Task<std::vector<detail::Result<T>>> when_all(std::vector<Task<T>> tasks) {
+        std::vector<std::optional<detail::Result<T>>> results(tasks.size());
+        detail::Gate gate { tasks.size() + 1 };
+
+        co_await detail::startAll(gate, [&] {
+            for (size_t i = 0; i < tasks.size(); i++) {
+                detail::runAndNotify(tasks[i], results[i], [&gate] { gate.arrive(); });
+            }
+        });
+
+        std::vector<detail::Result<T>> values;
+        values.reserve(results.size());
+
+        for (auto& result : results) {
+            values.push_back(std::move(*result));
+        }
+
+        co_return values;
+    }
+
+    // start every task and resume as soon as the first one finishes.
+    // the rest still run to completion and their results are dropped
+    template<typename T>
+    Task<AnyResult<T>> when_any(std::vector<Task<T>> tasks) {
+        ASSERT(!tasks.empty());
+
+        // shared with the children so the losers can outlive this frame
+        auto pState = std::make_shared<detail::AnyState<T>>();
+        pState->results.resize(tasks.size());
+        pState->tasks = std::move(tasks);
+
+        co_await detail::startAll(pState->gate, [&] {
+            for (size_t i = 0; i < pState->tasks.size(); i++) {
+                detail::runAndNotify(pState->tasks[i], pState->results[i], [pState, i] {
+                    size_t expected = SIZE_MAX;
+                    if (pState->winner.compare_exchange_strong(expected, i, std::memory_order_acq_rel)) {
+                        pState->gate.arrive();
+                    }
+                });
+            }
+        });
+
+        size_t index = pState->winner.load(std::memory_order_acquire);
+        co_return AnyResult<T> { index, std::move(*pState->results[index]) };
+    }
+}
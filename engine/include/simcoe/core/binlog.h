@@ -0,0 +1,165 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// layout of simcoe.bin.log. shared by BinarySink and the logdecode tool so only
+// depends on the standard library. everything is little endian, written as these structs lay out on x64.
+//
+// the file is a FileHeader then a stream of records. each record starts with a Kind byte.
+// formats and categories are defined once, the first time they are used, before any message that refers to them.
+//
+// bump kVersion whenever anything here changes shape
+namespace simcoe::logging::binary {
+    constexpr char kMagic[4] = { 'S', 'B', 'L', 'G' };
+    constexpr uint16_t kVersion = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t headerSize; // sizeof(FileHeader) when written, records start here
+        uint32_t reserved;
+        int64_t startTime; // system clock nanoseconds when the sink opened, messages are relative to this
+    };
+
+    static_assert(sizeof(FileHeader) == 24);
+
+    enum Kind : uint8_t {
+        eFormat, // Define then the format string
+        eCategory, // Define then the category name
+        eMessage // Message then its arguments
+    };
+
+    struct Define {
+        Kind kind;
+        uint8_t reserved[3];
+        uint32_t id;
+        uint32_t length; // bytes of text that follow
+    };
+
+    static_assert(sizeof(Define) == 12);
+
+    struct Message {
+        Kind kind;
+        uint8_t level;
+        uint8_t argCount;
+        uint8_t reserved;
+        uint16_t category;
+        uint16_t thread; // small index handed out in order of first log, not an os id
+        uint32_t format;
+        uint32_t size; // bytes of arguments that follow
+        uint64_t time; // nanoseconds since FileHeader::startTime
+    };
+
+    static_assert(sizeof(Message) == 24);
+
+    // every argument is one of these tags followed by its value.
+    // integers are leb128 varints since most logged numbers are small,
+    // strings are a uint32_t length then the bytes, everything else is its natural size
+    enum Arg : uint8_t {
+        eBool,
+        eChar,
+        eInt, // zigzag varint
+        eUint, // varint
+        eFloat,
+        eDouble,
+        eString,
+        ePointer // uint64_t, formatted like a const void*
+    };
+
+    // a message with arguments that have no binary form is formatted on the spot,
+    // then written against this format with the text as its only argument
+    constexpr std::string_view kTextFormat = "{}";
+
+    using Buffer = std::vector<std::byte>;
+
+    template<typename T>
+    void write(Buffer& buffer, const T& value) requires std::is_trivially_copyable_v<T> {
+        size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    inline void writeText(Buffer& buffer, std::string_view text) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + text.size());
+        std::memcpy(buffer.data() + offset, text.data(), text.size());
+    }
+
+    inline void writeVarint(Buffer& buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(std::byte((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+
+        buffer.push_back(std::byte(value));
+    }
+
+    // keeps small negative numbers small
+    constexpr uint64_t zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+    constexpr int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+    inline void writeString(Buffer& buffer, std::string_view text) {
+        write(buffer, eString);
+        write(buffer, uint32_t(text.size()));
+        writeText(buffer, text);
+    }
+
+    ///
+    /// argument encoding
+    ///
+
+    template<typename T>
+    concept StringLike = std::convertible_to<const T&, std::string_view>;
+
+    template<typename T>
+    concept HasView = requires(const T& value) {
+        { value.view() } -> std::convertible_to<std::string_view>;
+    };
+
+    template<typename T>
+    concept Encodable = std::same_as<T, bool>
+        || std::same_as<T, char>
+        || std::integral<T>
+        || std::floating_point<T>
+        || std::is_pointer_v<T>
+        || StringLike<T>
+        || HasView<T>;
+
+    template<typename T>
+    void encode(Buffer& buffer, const T& value) {
+        if constexpr (std::same_as<T, bool>) {
+            write(buffer, eBool);
+            write(buffer, uint8_t(value));
+        } else if constexpr (std::same_as<T, char>) {
+            write(buffer, eChar);
+            write(buffer, value);
+        } else if constexpr (std::signed_integral<T>) {
+            write(buffer, eInt);
+            writeVarint(buffer, zigzag(int64_t(value)));
+        } else if constexpr (std::unsigned_integral<T>) {
+            write(buffer, eUint);
+            writeVarint(buffer, uint64_t(value));
+        } else if constexpr (std::same_as<T, float>) {
+            write(buffer, eFloat);
+            write(buffer, value);
+        } else if constexpr (std::floating_point<T>) {
+            write(buffer, eDouble);
+            write(buffer, double(value));
+        } else if constexpr (StringLike<T>) {
+            writeString(buffer, std::string_view(value));
+        } else if constexpr (HasView<T>) {
+            writeString(buffer, std::string_view(value.view()));
+        } else {
+            // std::format prints every other pointer as an address
+            write(buffer, ePointer);
+            write(buffer, uint64_t(reinterpret_cast<uintptr_t>(value)));
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "simcoe/core/loop.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simcoe {
+    struct FrameTimes {
+        Duration cpu; // recording the frame
+        Duration presentWait; // blocked on the gpu and swapchain after recording
+        Duration gpu; // from the first to the last command of the frame on the gpu
+    };
+
+    // rolling history of the last few frames with percentiles and a log scale histogram.
+    // everything is sized up front so adding a frame never allocates. not thread safe
+    struct FrameStats {
+        enum Series {
+            eCpu,
+            ePresentWait,
+            eGpu,
+
+            eSeriesCount
+        };
+
+        struct Summary {
+            Duration p50;
+            Duration p95;
+            Duration p99;
+            Duration max;
+        };
+
+        // below 4us each bucket is 1us, above that every power of two is split into 4 buckets.
+        // the last bucket also holds anything slower than about 2 seconds
+        static constexpr size_t kBucketCount = 80;
+        using Histogram = std::array<uint32_t, kBucketCount>;
+
+        struct Info {
+            size_t window = 1024; // frames kept
+        };
+
+        FrameStats(const Info& info);
+
+        void add(const FrameTimes& times);
+
+        // zeroed until the first frame
+        Summary getSummary(Series series) const;
+
+        // frames in the window per bucket
+        const Histogram& getHistogram(Series series) const { return histograms[series]; }
+
+        size_t getCount() const;
+        size_t getWindow() const { return window; }
+
+        // frames added since creation
+        size_t getTotal() const { return total; }
+
+        static size_t getBucket(Duration time);
+
+        // shortest time in a bucket, it ends where the next one starts
+        static Duration getBucketStart(size_t bucket);
+
+        static const char *getSeriesName(Series series);
+
+        // one row per frame in the window, oldest first, times in microseconds
+        bool writeCsv(const char *pzPath) const;
+
+    private:
+        size_t window;
+        size_t total = 0;
+
+        // frame i is at i % window
+        std::vector<Duration> samples[eSeriesCount];
+        Histogram histograms[eSeriesCount] = { };
+
+        // percentiles partially sort a copy of the window
+        mutable std::vector<Duration> scratch;
+    };
+}
@@ -1,11 +1,33 @@
 #pragma once
 
-#include <unordered_set>
+#include "simcoe/core/binlog.h"
+#include "simcoe/core/name.h"
+
+#include "simcoe/memory/tracking.h"
+
+#include "simcoe/threads/mutex.h"
+
+#include <atomic>
+#include <chrono>
 #include <format>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+// messages below this level are compiled out. 0 keeps everything, see the log-level meson option
+#ifndef SIMCOE_LOG_LEVEL
+#   define SIMCOE_LOG_LEVEL 0
+#endif
 
 namespace simcoe::logging {
     struct Category;
     struct ISink;
+    struct BinarySink;
+
+    // the open binary sink or null
+    BinarySink *getBinarySink();
 
     enum Level : unsigned {
 #define LEVEL(id, name) id,
@@ -13,41 +35,147 @@ namespace simcoe::logging {
         eTotal
     };
 
+    constexpr Level kMinLevel = Level(SIMCOE_LOG_LEVEL);
+
+    struct RateLimit {
+        float perSecond = 0.f; // steady rate each call site may log at, 0 for no limit
+        uint32_t burst = 1; // messages a quiet site may log back to back
+        Level minLevel = eWarn; // messages below this are never limited
+    };
+
+    // token bucket per call site, keyed by the address of the format string literal.
+    // identical literals the linker merges share a bucket, which is usually what you want.
+    // the bucket is a single timestamp (gcra) so checking it is one CAS, no locks
+    struct RateLimiter final {
+        RateLimiter() = default;
+
+        RateLimiter(const RateLimiter&) = delete;
+        RateLimiter& operator=(const RateLimiter&) = delete;
+
+        // safe to call while other threads log
+        void configure(RateLimit limit);
+        RateLimit getLimit() const;
+
+        bool isLimited(Level level) const {
+            return interval.load(std::memory_order_relaxed) != 0
+                && level >= minLevel.load(std::memory_order_relaxed);
+        }
+
+        // false if the site is over its limit. when true, suppressed is how many
+        // messages from the site were dropped since it last got through
+        bool allow(const void *pSite, size_t& suppressed);
+
+        // messages dropped across every site
+        size_t getSuppressed() const { return totalSuppressed.load(std::memory_order_relaxed); }
+
+    private:
+        struct Site {
+            std::atomic<const void*> pKey = nullptr;
+            std::atomic_uint64_t arrival = 0; // when the bucket is next full, in clock nanoseconds
+            std::atomic_size_t suppressed = 0;
+        };
+
+        // sites past this many are never limited
+        static constexpr size_t kMaxSites = 512;
+
+        Site *getSite(const void *pKey);
+
+        std::atomic_uint64_t interval = 0; // nanoseconds between messages, 0 when disabled
+        std::atomic_uint64_t tolerance = 0; // how far ahead of now a site may run, the burst
+        std::atomic<Level> minLevel = eWarn;
+
+        std::atomic_size_t totalSuppressed = 0;
+
+        Site sites[kMaxSites];
+    };
+
     struct Category final {
         using SinkSet = std::unordered_set<ISink*>;
 
-        Category(Level level, const char *pzName)
+        Category(Level level, util::Name name)
             : logLevel(level)
-            , pzName(pzName)
+            , name(name)
+            , pLimiter(std::make_unique<RateLimiter>())
+            , pSinks(std::make_unique<SinkList>())
         { }
 
+        // hands the message to the log writer when there is one, otherwise straight to the sinks
         void send(Level level, const char *pzMessage);
 
-        void info(const char *pzMessage, auto&&... args) {
-            send(eInfo, std::vformat(pzMessage, std::make_format_args(args...)).c_str());
+        // send to every sink on the calling thread. holds the sink lock while sending,
+        // so a sink must not log to or change the sinks of the category it was sent from
+        void dispatch(Level level, const char *pzMessage);
+
+        // the format string is checked against the arguments at compile time.
+        // below the category level nothing is formatted, below kMinLevel the call compiles to nothing
+        // though its arguments are still evaluated
+
+        template<typename... A>
+        void info(std::format_string<A...> fmt, A&&... args) {
+            log<eInfo, A...>(fmt, args...);
         }
 
-        void warn(const char *pzMessage, auto&&... args) {
-            send(eWarn, std::vformat(pzMessage, std::make_format_args(args...)).c_str());
+        template<typename... A>
+        void warn(std::format_string<A...> fmt, A&&... args) {
+            log<eWarn, A...>(fmt, args...);
         }
 
-        void fatal(const char *pzMessage, auto&&... args) {
-            send(eFatal, std::vformat(pzMessage, std::make_format_args(args...)).c_str());
+        template<typename... A>
+        void fatal(std::format_string<A...> fmt, A&&... args) {
+            log<eFatal, A...>(fmt, args...);
         }
 
+        bool isEnabled(Level level) const { return level >= kMinLevel && level >= logLevel; }
+
+        // format into a fresh string and send it. for format strings only known at runtime,
+        // the typed calls above format into a thread local buffer instead
+        void format(Level level, std::string_view fmt, std::format_args args);
+
+        // safe to call while other threads log and the writer delivers.
+        // once removeSink returns the sink is no longer being sent to
         void addSink(ISink *pSink);
         void removeSink(ISink *pSink);
 
+        // limit how often each call site in this category may log, a zeroed limit turns it off
+        void setRateLimit(RateLimit limit) { pLimiter->configure(limit); }
+        RateLimit getRateLimit() const { return pLimiter->getLimit(); }
+        size_t getSuppressed() const { return pLimiter->getSuppressed(); }
+
         constexpr Level getLevel() const { return logLevel; }
-        constexpr const char *getName() const { return pzName; }
+        constexpr util::Name getName() const { return name; }
 
-        const SinkSet& getSinks() const { return sinks; }
+        // a copy, other threads may change the sinks once it is taken
+        SinkSet getSinks() const;
+        bool hasSinks() const { return pSinks->count.load(std::memory_order_relaxed) > 0; }
 
     private:
+        template<Level L, typename... A>
+        void log(std::format_string<A...> fmt, A&... args);
+
+        // this thread's format buffer, empty while a message formatted into it is being sent
+        static std::span<char> getFormatBuffer();
+
+        // send the first length chars of the format buffer
+        void sendFormatBuffer(Level level, size_t length);
+
+        // logged ahead of a message that had repeats dropped
+        void sendSuppressed(Level level, std::string_view fmt, size_t count);
+
         Level logLevel;
-        const char *pzName;
+        util::Name name;
+
+        // boxed so categories stay movable
+        std::unique_ptr<RateLimiter> pLimiter;
+
+        // changed rarely, read for every message on whichever thread delivers it.
+        // boxed with its lock for the same reason as the limiter
+        struct SinkList {
+            threads::Mutex lock;
+            SinkSet sinks;
+            std::atomic_size_t count = 0; // checked without the lock before formatting
+        };
 
-        SinkSet sinks;
+        std::unique_ptr<SinkList> pSinks;
     };
 
     struct ISink {
@@ -93,4 +221,118 @@ namespace simcoe::logging {
 
         void accept(Category &category, Level level, const char *pzMessage) override;
     };
+
+    // writes the format string id and raw arguments of every message instead of text,
+    // the logdecode tool formats them later. see binlog.h for the layout.
+    // sees every category while it is open, only one may be open at a time.
+    // messages are encoded on the calling thread into a shared buffer. once it fills it is handed
+    // to the log writer thread to write out, or written on the caller when there is no writer.
+    // threads log through it without holding a reference, so it has to be opened before any of them
+    // start and destroyed after they are joined
+    struct BinarySink final {
+        BinarySink(const char *pzPath);
+        ~BinarySink();
+
+        BinarySink(const BinarySink&) = delete;
+        BinarySink& operator=(const BinarySink&) = delete;
+
+        template<typename... A>
+        void write(Category& category, Level level, std::string_view fmt, A&... args) {
+            memory::TagScope tag(memory::eLogging);
+            memory::AllowAllocScope allow;
+
+            if constexpr ((binary::Encodable<std::remove_cvref_t<A>> && ...)) {
+                binary::Buffer& scratch = getScratch();
+                scratch.clear();
+                (binary::encode(scratch, args), ...);
+
+                send(category, level, fmt, scratch, sizeof...(A));
+            } else {
+                // something without a binary form, enums or math types, fall back to text
+                writeFormatted(category, level, fmt, std::make_format_args(args...));
+            }
+        }
+
+        void flush();
+
+        // used by panic, gives up rather than waiting on a thread that may be the one panicking
+        bool tryFlush();
+
+    private:
+        static constexpr size_t kFlushSize = 64 * 1024;
+
+        struct PendingWrite;
+
+        // per thread argument buffer
+        static binary::Buffer& getScratch();
+
+        void send(Category& category, Level level, std::string_view fmt, const binary::Buffer& args, size_t count);
+        void writeFormatted(Category& category, Level level, std::string_view fmt, std::format_args args);
+
+        uint32_t getFormatId(std::string_view fmt);
+        uint32_t getCategoryId(Category& category);
+        void define(binary::Kind kind, uint32_t id, std::string_view text);
+
+        // swap the full buffer for the empty pending one and post it to the writer
+        bool handOff();
+
+        // runs on the writer thread
+        void writePending();
+
+        // writes the pending buffer then this one, with both locks held
+        void writeLocked();
+        void flushLocked();
+
+        FILE *pFile;
+        std::chrono::steady_clock::time_point start;
+
+        threads::Mutex lock;
+        binary::Buffer buffer;
+
+        // held while writing to the file, taken after lock
+        threads::Mutex fileLock;
+        std::unique_ptr<PendingWrite> pPending;
+
+        // format strings are literals so their address is enough to tell them apart
+        std::unordered_map<const char*, uint32_t> formats;
+        std::unordered_map<Category*, uint32_t> categories;
+    };
+
+    template<Level L, typename... A>
+    void Category::log(std::format_string<A...> fmt, A&... args) {
+        if constexpr (L >= kMinLevel) {
+            if (!isEnabled(L)) { return; }
+
+            if (pLimiter->isLimited(L)) {
+                size_t suppressed = 0;
+                if (!pLimiter->allow(fmt.get().data(), suppressed)) { return; }
+
+                if (suppressed > 0) {
+                    sendSuppressed(L, fmt.get(), suppressed);
+                }
+            }
+
+            if (BinarySink *pBinary = getBinarySink()) {
+                pBinary->write(*this, L, fmt.get(), args...);
+            }
+
+            // text is only worth formatting if someone reads it
+            if (!hasSinks()) { return; }
+
+            // format_to_n writes straight into the buffer, leaving room for the terminator.
+            // messages logged from inside a sink and the odd one too long for it get a string of their own
+            std::span<char> buffer = getFormatBuffer();
+            if (!buffer.empty()) {
+                auto result = std::format_to_n<char*, A...>(buffer.data(), buffer.size() - 1, fmt, std::forward<A>(args)...);
+                if (size_t(result.size) < buffer.size()) {
+                    sendFormatBuffer(L, size_t(result.size));
+                    return;
+                }
+            }
+
+            format(L, fmt.get(), std::make_format_args(args...));
+        } else {
+            (static_cast<void>(args), ...);
+        }
+    }
 }
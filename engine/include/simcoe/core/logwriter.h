@@ -0,0 +1,99 @@
+#pragma once
+
+#include "simcoe/core/logging.h"
+#include "simcoe/core/topology.h"
+
+#include "simcoe/threads/channel.h"
+
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+namespace simcoe::logging {
+    namespace detail {
+        struct FlushState;
+    }
+
+    // what post does when the writer has capacity records queued
+    enum struct Overflow {
+        eBlock, // wait for the writer to catch up
+        eDrop, // throw the record away, only getDropped knows
+        eReport // throw the record away and have the writer log how many went missing
+    };
+
+    // work that has to happen on the writer thread, in order with the messages posted around it.
+    // whoever posts it keeps it alive until it has run
+    struct IWriterTask {
+        virtual void run() = 0;
+
+    protected:
+        ~IWriterTask() = default;
+    };
+
+    // one queued message. fixed size so the queue never allocates per message,
+    // longer messages are cut short and end with an ellipsis
+    struct Record {
+        static constexpr size_t kMessageSize = 232;
+
+        Category *pCategory; // null for tasks
+        Level level;
+        uint32_t length;
+        IWriterTask *pTask; // flush markers and other tasks only
+        char message[kMessageSize];
+    };
+
+    static_assert(sizeof(Record) == 256);
+
+    // moves sink output off the logging threads. categories hand formatted messages to
+    // the writer which sends them to their sinks in batches on its own thread.
+    // registers itself on construction, only one may exist at a time
+    struct Writer {
+        struct Info {
+            size_t capacity = 4096; // records
+            Overflow overflow = Overflow::eReport;
+
+            os::threads::Info threads = { };
+        };
+
+        Writer(const Info& info);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // false when the caller should send the message itself, such as
+        // when logging from a sink on the writer thread or after shutdown
+        bool post(Category& category, Level level, std::string_view message);
+
+        // run the task on the writer thread after everything posted before it. never dropped,
+        // blocks while the queue is full. false when the caller should run it itself, as with messages
+        bool post(IWriterTask *pTask);
+
+        // wait until everything this thread posted before the call has reached the sinks.
+        // false if the timeout ran out first. returns straight away on the writer thread
+        bool flush(std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+        size_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+        bool isWriterThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+    private:
+        static constexpr size_t kBatchSize = 64;
+
+        void run(const os::threads::Info& threads);
+        void deliver(const Record& record);
+        void reportDropped();
+
+        Overflow overflow;
+
+        threads::Channel<Record, threads::ChannelKind::eMPSC> channel;
+
+        std::atomic_size_t dropped = 0;
+        std::atomic<Category*> pLastDropped = nullptr;
+        size_t reported = 0;
+
+        std::jthread thread;
+    };
+
+    // the active writer or null when categories send synchronously
+    Writer *getWriter();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace simcoe {
+    using Duration = std::chrono::nanoseconds;
+
+    // where the loop reads time from, tests drive a fake one
+    struct IClock {
+        virtual ~IClock() = default;
+
+        virtual Duration now() = 0;
+    };
+
+    struct SteadyClock final : IClock {
+        Duration now() override;
+    };
+
+    // a value at the last two ticks, rendering blends between them
+    template<typename T>
+    struct Interpolated {
+        constexpr Interpolated(const T& it = T())
+            : previous(it)
+            , current(it)
+        { }
+
+        // call once per tick with the new state
+        constexpr void update(const T& it) {
+            previous = current;
+            current = it;
+        }
+
+        constexpr T get(float alpha) const {
+            return previous + (current - previous) * alpha;
+        }
+
+        T previous;
+        T current;
+    };
+
+    // runs the simulation at a fixed tick however fast frames arrive.
+    // elapsed time collects in an accumulator and is spent a tick at a time.
+    // a frame runs at most maxSteps ticks, time beyond that is dropped so a slow frame can't spiral
+    struct GameLoop {
+        struct Info {
+            double tickRate = 60.0; // simulation ticks per second
+            size_t maxSteps = 5; // most ticks a single frame may run
+        };
+
+        GameLoop(const Info& info, IClock& clock);
+
+        // call once per frame, runs step(dt) for each tick that is due.
+        // returns how far between the last tick and the next one this frame is, in [0, 1)
+        template<typename F>
+        float update(F&& step) {
+            size_t steps = advance();
+            float dt = getTickDelta();
+
+            for (size_t i = 0; i < steps; i++) {
+                step(dt);
+            }
+
+            return getAlpha();
+        }
+
+        float getTickDelta() const;
+        float getAlpha() const;
+
+        size_t getTick() const { return tick; }
+        Duration getDropped() const { return dropped; }
+
+    private:
+        // read the clock and work out how many ticks are due
+        size_t advance();
+
+        IClock& clock;
+        Duration delta;
+        size_t maxSteps;
+
+        Duration last;
+        Duration accumulator = Duration::zero();
+        Duration dropped = Duration::zero();
+
+        size_t tick = 0;
+    };
+}
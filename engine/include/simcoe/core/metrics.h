@@ -0,0 +1,211 @@
+#pragma once
+
+#include "simcoe/core/topology.h"
+
+#include "simcoe/threads/mutex.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// named operational numbers such as draw calls or bytes uploaded, watched over time by a Sampler.
+// metrics are meant to be globals, they register themselves on construction and are never removed.
+// one made later, such as a function local static, is picked up by running samplers on their next sample
+// but has to outlive them.
+// updates are relaxed atomics spread over per thread shards so hot paths don't fight over a cache line
+namespace simcoe::metrics {
+    enum Kind {
+        eCounter,
+        eGauge,
+        eHistogram
+    };
+
+    constexpr size_t kShards = 16;
+
+    namespace detail {
+        // threads are handed shards round robin the first time they update a metric
+        size_t newShard();
+
+        inline size_t getShard() {
+            thread_local size_t shard = SIZE_MAX;
+            if (shard == SIZE_MAX) {
+                shard = newShard();
+            }
+
+            return shard;
+        }
+
+        template<typename T>
+        struct alignas(64) Shard {
+            std::atomic<T> value;
+        };
+    }
+
+    struct Metric {
+        Metric(const Metric&) = delete;
+        Metric& operator=(const Metric&) = delete;
+
+        const char *getName() const { return pzName; }
+        Kind getKind() const { return kind; }
+
+        // the registry is a list threaded through every metric
+        Metric *getNext() const { return pNext; }
+
+    protected:
+        Metric(const char *pzName, Kind kind);
+
+        // adds the metric to the registry, called once the derived metric is fully
+        // constructed since a sampler may read it from then on
+        void publish();
+
+    private:
+        const char *pzName;
+        Kind kind;
+        Metric *pNext;
+    };
+
+    // most recently registered first, walk it with getNext
+    Metric *getMetrics();
+
+    // a running total that only goes up
+    struct Counter final : Metric {
+        Counter(const char *pzName)
+            : Metric(pzName, eCounter)
+        {
+            publish();
+        }
+
+        void add(uint64_t count = 1) {
+            shards[detail::getShard()].value.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        uint64_t get() const;
+
+    private:
+        detail::Shard<uint64_t> shards[kShards] = { };
+    };
+
+    // a level that moves both ways, such as descriptors in use.
+    // only takes deltas so updates from different threads can still be sharded
+    struct Gauge final : Metric {
+        Gauge(const char *pzName)
+            : Metric(pzName, eGauge)
+        {
+            publish();
+        }
+
+        void add(int64_t delta) {
+            shards[detail::getShard()].value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        void sub(int64_t delta) { add(-delta); }
+
+        int64_t get() const;
+
+    private:
+        detail::Shard<int64_t> shards[kShards] = { };
+    };
+
+    // distribution of values such as wait times. bucket 0 holds 0 and bucket i holds [2^(i-1), 2^i)
+    struct Histogram final : Metric {
+        static constexpr size_t kBucketCount = 65;
+
+        struct Snapshot {
+            uint64_t count;
+            uint64_t sum;
+            std::array<uint64_t, kBucketCount> buckets;
+
+            // largest value the bucket holding the percentile could contain, 0 when empty
+            uint64_t getPercentile(size_t percent) const;
+        };
+
+        Histogram(const char *pzName)
+            : Metric(pzName, eHistogram)
+        {
+            publish();
+        }
+
+        void record(uint64_t value) {
+            Shard& shard = shards[detail::getShard()];
+            shard.buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        Snapshot get() const;
+
+        static constexpr size_t getBucket(uint64_t value) { return size_t(std::bit_width(value)); }
+
+        static constexpr uint64_t getBucketLimit(size_t bucket) {
+            return (bucket == kBucketCount - 1) ? UINT64_MAX : (uint64_t(1) << bucket) - 1;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic_uint64_t sum;
+            std::atomic_uint64_t buckets[kBucketCount];
+        };
+
+        Shard shards[kShards] = { };
+    };
+
+    enum struct Format {
+        eJsonLines,
+        eCsv
+    };
+
+    // writes every registered metric to a file at a fixed interval on its own thread, and once more when destroyed.
+    // metrics registered after it starts are added from the next sample, a csv file gets a new header row for them.
+    // counters and gauges are written as their current value.
+    // histograms are written as the count, sum and percentiles of what was recorded since the last sample
+    struct Sampler {
+        struct Info {
+            const char *pzPath = "simcoe.metrics.jsonl";
+            Format format = Format::eJsonLines;
+            std::chrono::milliseconds interval = std::chrono::seconds(1);
+
+            os::threads::Info threads = { };
+        };
+
+        Sampler(const Info& info);
+        ~Sampler();
+
+        Sampler(const Sampler&) = delete;
+        Sampler& operator=(const Sampler&) = delete;
+
+    private:
+        void run(std::stop_token stop, const os::threads::Info& threads);
+
+        // true if metrics were registered since the last call
+        bool refresh();
+
+        void writeHeader();
+        void writeSample();
+
+        struct Entry {
+            Metric *pMetric;
+            Histogram::Snapshot previous; // what a histogram held at the last sample
+        };
+
+        Info info;
+        FILE *pFile = nullptr;
+
+        // sorted by name so columns stay put between runs
+        std::vector<Entry> entries;
+
+        // the newest metric seen, the registry only grows at its head
+        Metric *pHead = nullptr;
+
+        std::chrono::steady_clock::time_point start;
+
+        threads::Mutex lock;
+        std::condition_variable_any wake;
+        std::jthread thread;
+    };
+}
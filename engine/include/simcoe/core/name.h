@@ -0,0 +1,55 @@
+#pragma once
+
+#include "simcoe/core/units.h"
+
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace simcoe::util {
+    // handle to a string in the global intern table.
+    // interned text is never freed so c_str() stays valid for the life of the program,
+    // comparing and hashing only touch the 32 bit id
+    struct Name final {
+        struct Stats {
+            size_t names;
+            units::Memory text;
+        };
+
+        constexpr Name() = default;
+
+        Name(std::string_view text);
+        Name(const char *pzText) : Name(std::string_view(pzText)) { }
+        Name(const std::string& text) : Name(std::string_view(text)) { }
+
+        const char *c_str() const;
+        std::string_view view() const;
+
+        constexpr uint32_t getId() const { return id; }
+        constexpr bool empty() const { return id == 0; }
+
+        constexpr bool operator==(const Name& other) const = default;
+
+        static Stats getStats();
+
+    private:
+        // 0 is always the empty string
+        uint32_t id = 0;
+    };
+}
+
+template<>
+struct std::hash<simcoe::util::Name> {
+    size_t operator()(simcoe::util::Name name) const noexcept {
+        return name.getId();
+    }
+};
+
+template<>
+struct std::formatter<simcoe::util::Name> : std::formatter<std::string_view> {
+    auto format(simcoe::util::Name name, auto& ctx) const {
+        return std::formatter<std::string_view>::format(name.view(), ctx);
+    }
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace simcoe::os::threads {
+    enum CoreType {
+        ePerformance,
+        eEfficiency
+    };
+
+    struct Core {
+        CoreType type;
+        std::vector<size_t> logical; // logical processor ids, more than one with smt
+    };
+
+    struct Topology {
+        std::vector<Core> cores; // physical cores, performance cores first
+        size_t logicalCount = 0;
+
+        // true when the machine mixes performance and efficiency cores
+        bool isHybrid() const;
+
+        size_t getCoreCount(CoreType type) const;
+
+        // every logical processor on cores of this type
+        std::vector<size_t> getLogical(CoreType type) const;
+    };
+
+    // detected once and cached
+    const Topology& getTopology();
+
+    // scheduler workers to spawn. one per performance core, leaving room for the main and render threads
+    size_t getDefaultWorkerCount();
+
+    enum struct Priority {
+        eLow,
+        eNormal,
+        eHigh,
+        eCritical
+    };
+
+    enum struct Affinity {
+        eAny, // let the os decide
+        ePerformance, // any performance core
+        eEfficiency, // any efficiency core, performance cores on machines without them
+        ePinned // a single physical core
+    };
+
+    struct Placement {
+        Affinity affinity = Affinity::eAny;
+        Priority priority = Priority::eNormal;
+        size_t core = 0; // physical core index when pinned
+    };
+
+    enum Role {
+        eMain,
+        eRender,
+        eWorker, // scheduler workers, they also load assets
+        eLogging,
+        eMetrics,
+
+        eRoleCount
+    };
+
+    // where each kind of thread should run
+    struct Info {
+        Placement roles[eRoleCount] = {
+            /* eMain = */ { Affinity::ePerformance, Priority::eHigh },
+            /* eRender = */ { Affinity::ePerformance, Priority::eHigh },
+            /* eWorker = */ { Affinity::ePerformance, Priority::eNormal },
+            /* eLogging = */ { Affinity::eEfficiency, Priority::eLow },
+            /* eMetrics = */ { Affinity::eEfficiency, Priority::eLow }
+        };
+    };
+
+    // how much of a request the os went along with
+    enum struct Applied {
+        eAll,
+        eDenied, // the priority needs privileges the process lacks, CAP_SYS_NICE on linux. the rest was applied
+        eFailed
+    };
+
+    const char *getRoleName(Role role);
+
+    // these all act on the calling thread and return false if the os refused
+
+    // shows up in debuggers and profilers
+    bool setName(std::string_view name);
+    bool setAffinity(std::span<const size_t> logical);
+    // an unprivileged linux process may lower its priority but not raise it
+    Applied setPriority(Priority priority);
+
+    // name the thread after its role and apply the placement for it.
+    // index tells apart threads sharing a role, such as workers.
+    // eDenied is normal for a game run without privileges, callers decide how loud to be about it
+    Applied setup(Role role, const Info& info, size_t index = 0);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#elif defined(__x86_64__)
+#   include <x86intrin.h>
+#endif
+
+// scoped cpu zones for seeing where frame time goes. a zone costs one relaxed load
+// until a capture is running. when 0 SIMCOE_ZONE compiles to nothing
+#ifndef SIMCOE_TRACE
+#   define SIMCOE_TRACE 0
+#endif
+
+namespace simcoe::trace {
+    constexpr bool kEnabled = SIMCOE_TRACE;
+
+    struct Stats {
+        size_t threads; // threads that have recorded anything
+        size_t events; // zones recorded by the current or last capture
+        size_t lost; // zones overwritten before they were saved, raise kRingSize if this grows
+    };
+
+    // per thread, in zones. a thread allocates its ring the first time it records
+    constexpr size_t kRingSize = 1 << 16;
+
+    // record zones until stop is called, throws away anything from an earlier capture
+    void start();
+    void stop();
+
+    // record the next count frames then stop
+    void capture(size_t frames);
+
+    // call once a frame from the thread that presents, frames show up as markers in the trace
+    void frame();
+
+    bool isRecording();
+
+    // zeroed when tracing is compiled out
+    Stats getStats();
+
+    // write the last capture as chrome trace event json, it opens in chrome://tracing and ui.perfetto.dev.
+    // stops a running capture. false if tracing is compiled out or the file could not be written
+    bool save(const char *pzPath);
+
+    // how the calling thread is labelled in saved traces
+    void setThreadName(std::string_view name);
+
+    namespace detail {
+        extern std::atomic_bool gRecording;
+
+        // timestamp counter on x64, converted to time when saving
+        inline uint64_t now() {
+#if defined(_M_X64) || defined(__x86_64__)
+            return __rdtsc();
+#else
+            return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        void record(const char *pzName, uint64_t begin, uint64_t end);
+    }
+
+#if SIMCOE_TRACE
+    // the name is kept by pointer until the trace is saved,
+    // so it must be a literal or otherwise live forever, such as util::Name::c_str
+    struct Zone final {
+        Zone(const char *pzName)
+            : pzName(pzName)
+            , begin(detail::gRecording.load(std::memory_order_relaxed) ? detail::now() : 0)
+        { }
+
+        ~Zone() {
+            if (begin != 0) {
+                detail::record(pzName, begin, detail::now());
+            }
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char *pzName;
+        uint64_t begin;
+    };
+#endif
+}
+
+#if SIMCOE_TRACE
+#   define SIMCOE_ZONE_JOIN2(a, b) a##b
+#   define SIMCOE_ZONE_JOIN(a, b) SIMCOE_ZONE_JOIN2(a, b)
+#   define SIMCOE_ZONE(name) simcoe::trace::Zone SIMCOE_ZONE_JOIN(zone, __LINE__) { name }
+#else
+#   define SIMCOE_ZONE(name) ((void)0)
+#endif
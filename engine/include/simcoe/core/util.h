@@ -1,5 +1,7 @@
 #pragma once
 
+#include "simcoe/threads/mutex.h"
+
 #include <atomic>
 #include <memory>
 #include <string_view>
@@ -56,7 +58,7 @@ namespace simcoe::util {
     };
 
     struct RegistryBase {
-        std::mutex mutex;
+        threads::Mutex mutex;
         std::unordered_set<Entry*> entries = {};
     };
 
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace simcoe::memory {
+    // bump allocator with one block per frame in flight.
+    // nothing is freed individually, a frames block is released all at once
+    // by reset() once the gpu is done with that frame.
+    // allocations that dont fit in the block fall back to the heap and are
+    // counted so steady state frames can be checked for zero heap allocations.
+    // not thread safe, each thread should use its own arena
+    struct FrameArena final {
+        struct Chunk;
+
+        struct Mark {
+            size_t offset;
+            Chunk *pOverflow;
+        };
+
+        FrameArena(size_t frames, size_t size);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+
+        void *alloc(size_t size, size_t align = alignof(std::max_align_t));
+
+        // make a frames block current and release everything allocated from it
+        void reset(size_t frame);
+
+        // scoped use of the current block, rewind frees everything allocated after mark
+        Mark mark() const;
+        void rewind(Mark mark);
+
+        size_t getSize() const { return size; }
+        size_t getUsed() const { return blocks[current].offset; }
+
+        // total number of allocations that fell back to the heap
+        size_t getOverflows() const { return overflows; }
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> pMemory;
+            size_t offset = 0;
+            Chunk *pOverflow = nullptr;
+        };
+
+        void *overflow(size_t size, size_t align);
+        void freeOverflow(Block& block, Chunk *pLast);
+
+        size_t size;
+        size_t current = 0;
+        size_t overflows = 0;
+
+        std::vector<Block> blocks;
+    };
+
+    // stl allocator adaptor, deallocate is a no-op
+    template<typename T>
+    struct ArenaAllocator {
+        using value_type = T;
+
+        ArenaAllocator(FrameArena& arena)
+            : pArena(&arena)
+        { }
+
+        template<typename O>
+        ArenaAllocator(const ArenaAllocator<O>& other)
+            : pArena(other.pArena)
+        { }
+
+        T *allocate(size_t count) {
+            return static_cast<T*>(pArena->alloc(sizeof(T) * count, alignof(T)));
+        }
+
+        void deallocate(T*, size_t) { }
+
+        template<typename O>
+        bool operator==(const ArenaAllocator<O>& other) const { return pArena == other.pArena; }
+
+        FrameArena *pArena;
+    };
+
+    template<typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
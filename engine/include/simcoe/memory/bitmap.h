@@ -1,60 +1,117 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
 #include <memory>
 
 namespace simcoe::memory {
     namespace detail {
+        // two level bitmap, the leaf level holds a bit per slot
+        // the summary level holds a bit per leaf word that is set when the word is full.
+        // alloc scans the summary for a word with free bits then uses ctz
+        // on the leaf word rather than testing every bit
         template<typename T, typename P>
         struct Storage {
             enum struct Index : size_t { eInvalid = SIZE_MAX };
 
-            constexpr Storage(size_t bits): size(bits), pBits(new T[wordCount()]) { 
+            constexpr Storage(size_t bits)
+                : size(bits)
+                , pBits(new T[wordCount()])
+                , pFull(new T[summaryCount()])
+            {
                 reset();
             }
 
             constexpr size_t getSize() const { return size; }
 
-            constexpr bool test(Index index) const { 
-                return pBits[getWord(size_t(index))] & getMask(size_t(index)); 
+            constexpr bool test(Index index) const {
+                return load(pBits[getWord(size_t(index))]) & getMask(size_t(index));
             }
 
-            constexpr Index alloc() {
+            Index alloc() {
                 P *self = static_cast<P*>(this);
-                for (size_t i = 0; i < getSize(); i++) {
-                    if (self->testSet(i)) {
-                        return Index(i);
+
+                // start searching from the summary word that last had space
+                size_t start = hint.load(std::memory_order_relaxed) / kBits;
+                size_t summaries = summaryCount();
+
+                for (size_t i = 0; i < summaries; i++) {
+                    size_t summary = (start + i) % summaries;
+                    std::uint64_t free = ~load(pFull[summary]);
+
+                    while (free != 0) {
+                        size_t word = summary * kBits + std::countr_zero(free);
+                        if (size_t bit = self->claim(word); bit != SIZE_MAX) {
+                            hint.store(word, std::memory_order_relaxed);
+                            return Index(word * kBits + bit);
+                        }
+
+                        free &= free - 1;
                     }
                 }
 
                 return Index::eInvalid;
             }
 
-            constexpr void release(Index index) {
-                clear(size_t(index));
+            void release(Index index) {
+                P *self = static_cast<P*>(this);
+                self->clear(size_t(index));
             }
-        
-            constexpr static inline size_t kBits = sizeof(T) * CHAR_BIT;
+
+            constexpr static inline size_t kBits = sizeof(std::uint64_t) * CHAR_BIT;
+            constexpr static inline std::uint64_t kFull = ~std::uint64_t(0);
 
         protected:
-            constexpr void set(size_t index) {
-                pBits[getWord(index)] |= getMask(index);
-            }
+            constexpr void reset() {
+                for (size_t i = 0; i < wordCount(); i++) {
+                    pBits[i] = 0;
+                }
 
-            constexpr void clear(size_t index) {
-                pBits[getWord(index)] &= ~getMask(index);
-            }
+                for (size_t i = 0; i < summaryCount(); i++) {
+                    pFull[i] = 0;
+                }
 
-            constexpr void reset() {
-                std::fill_n(pBits.get(), wordCount(), 0);
+                // mark the bits past the end of the map as used so they are never handed out
+                if (size_t tail = getSize() % kBits; tail != 0) {
+                    pBits[wordCount() - 1] = kFull << tail;
+                }
+
+                // same for summary bits that dont have a leaf word
+                if (size_t tail = wordCount() % kBits; tail != 0) {
+                    pFull[summaryCount() - 1] = kFull << tail;
+                }
+
+                // an empty map still has one word, none of it is usable
+                if (getSize() == 0) {
+                    pBits[0] = kFull;
+                    pFull[0] = kFull;
+                }
+
+                hint = 0;
             }
 
-        protected:
-            constexpr T getMask(size_t bit) const { return T(1) << (bit % kBits); }
+            static std::uint64_t load(const std::uint64_t& word) { return word; }
+            static std::uint64_t load(const std::atomic_uint64_t& word) { return word.load(std::memory_order_acquire); }
+
+            constexpr std::uint64_t getMask(size_t bit) const { return std::uint64_t(1) << (bit % kBits); }
             constexpr size_t getWord(size_t bit) const { return bit / kBits; }
-            constexpr size_t wordCount() const { return getSize() / kBits + 1; }
+
+            // mask of length bits starting at offset within a single word
+            constexpr std::uint64_t getRangeMask(size_t offset, size_t length) const {
+                return (length >= kBits ? kFull : ((std::uint64_t(1) << length) - 1)) << offset;
+            }
+
+            constexpr size_t wordCount() const { return std::max<size_t>((getSize() + kBits - 1) / kBits, 1); }
+            constexpr size_t summaryCount() const { return (wordCount() + kBits - 1) / kBits; }
 
             size_t size;
             std::unique_ptr<T[]> pBits;
+            std::unique_ptr<T[]> pFull;
+
+            // the leaf word of the last successful alloc
+            std::atomic_size_t hint = 0;
         };
     }
 
@@ -63,6 +120,13 @@ namespace simcoe::memory {
         using Super::Super;
 
         bool testSet(size_t index);
+
+    private:
+        friend Super;
+
+        // set the first free bit in a word and return its offset
+        size_t claim(size_t word);
+        void clear(size_t index);
     };
 
     struct AtomicBitMap final : detail::Storage<std::atomic_uint64_t, AtomicBitMap> {
@@ -70,5 +134,27 @@ namespace simcoe::memory {
         using Super::Super;
 
         bool testSet(size_t index);
+
+        // claim a contiguous run of bits, safe to call from multiple threads
+        Index allocRange(size_t count);
+        void releaseRange(Index index, size_t count);
+
+    private:
+        friend Super;
+
+        size_t claim(size_t word);
+        void clear(size_t index);
+
+        // find the first run of count clear bits at or after start
+        size_t findRange(size_t start, size_t count) const;
+
+        // set every bit in the range one word at a time
+        // rolls back and returns false if any bit was already set
+        bool claimRange(size_t first, size_t count);
+        void clearRange(size_t first, size_t count);
+
+        // the summary is only a hint, a word may be released between
+        // observing it full and publishing that so we recheck after marking
+        void markFull(size_t word);
     };
 }
@@ -0,0 +1,489 @@
+#pragma once
+
+#include "simcoe/core/panic.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define SIMCOE_FLAT_SSE2 1
+#   include <emmintrin.h>
+#else
+#   define SIMCOE_FLAT_SSE2 0
+#endif
+
+namespace simcoe::memory {
+    namespace detail {
+        // one control byte per slot, full slots hold the low 7 bits of the hash
+        constexpr std::int8_t kEmpty = -128;
+        constexpr std::int8_t kDeleted = -2;
+
+        constexpr size_t kGroupWidth = 16;
+
+        // a group of control bytes matched all at once, each result is a bitmask of slots
+        struct Group {
+            Group(const std::int8_t *pControl) {
+#if SIMCOE_FLAT_SSE2
+                control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pControl));
+#else
+                std::memcpy(control, pControl, kGroupWidth);
+#endif
+            }
+
+            std::uint32_t match(std::int8_t hash) const {
+#if SIMCOE_FLAT_SSE2
+                return std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), control)));
+#else
+                return matchIf([hash](std::int8_t it) { return it == hash; });
+#endif
+            }
+
+            std::uint32_t matchEmpty() const {
+                return match(kEmpty);
+            }
+
+            // empty or deleted, both are less than -1
+            std::uint32_t matchFree() const {
+#if SIMCOE_FLAT_SSE2
+                return std::uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), control)));
+#else
+                return matchIf([](std::int8_t it) { return it < -1; });
+#endif
+            }
+
+        private:
+#if SIMCOE_FLAT_SSE2
+            __m128i control;
+#else
+            template<typename F>
+            std::uint32_t matchIf(F&& fn) const {
+                std::uint32_t mask = 0;
+                for (size_t i = 0; i < kGroupWidth; i++) {
+                    mask |= std::uint32_t(fn(control[i])) << i;
+                }
+                return mask;
+            }
+
+            std::int8_t control[kGroupWidth];
+#endif
+        };
+
+        // std::hash is the identity for pointers and integers on some platforms,
+        // fold and multiply so both the group index and the control bits get entropy
+        constexpr size_t mixHash(size_t hash) {
+            std::uint64_t it = hash;
+            it ^= it >> 32;
+            it *= 0xd6e8feb86659fd93ull;
+            it ^= it >> 32;
+            return size_t(it);
+        }
+
+        // swiss table style open addressing over groups of 16 slots.
+        // slots live in one flat array so lookups touch a control group and then
+        // usually a single slot, and iteration is a linear scan.
+        // max load is 7/8, erased slots become tombstones unless their group has
+        // an empty slot already
+        template<typename P, typename H, typename E>
+        struct FlatTable {
+            using key_type = typename P::Key;
+            using value_type = typename P::Value;
+            using size_type = size_t;
+
+            template<bool C>
+            struct Iterator {
+                using Slot = std::conditional_t<C, const typename FlatTable::value_type, typename FlatTable::value_type>;
+
+                using value_type = typename FlatTable::value_type;
+                using reference = Slot&;
+                using pointer = Slot*;
+                using difference_type = ptrdiff_t;
+                using iterator_category = std::forward_iterator_tag;
+
+                Iterator() = default;
+
+                Iterator(const std::int8_t *pControl, const std::int8_t *pEnd, Slot *pSlot)
+                    : pControl(pControl)
+                    , pEnd(pEnd)
+                    , pSlot(pSlot)
+                {
+                    skip();
+                }
+
+                operator Iterator<true>() const { return { pControl, pEnd, pSlot }; }
+
+                reference operator*() const { return *pSlot; }
+                pointer operator->() const { return pSlot; }
+
+                Iterator& operator++() {
+                    pControl += 1;
+                    pSlot += 1;
+                    skip();
+                    return *this;
+                }
+
+                Iterator operator++(int) {
+                    Iterator result = *this;
+                    ++(*this);
+                    return result;
+                }
+
+                bool operator==(const Iterator& other) const { return pControl == other.pControl; }
+
+            private:
+                void skip() {
+                    while (pControl != pEnd && *pControl < 0) {
+                        pControl += 1;
+                        pSlot += 1;
+                    }
+                }
+
+                const std::int8_t *pControl = nullptr;
+                const std::int8_t *pEnd = nullptr;
+                Slot *pSlot = nullptr;
+            };
+
+            using iterator = Iterator<false>;
+            using const_iterator = Iterator<true>;
+
+            FlatTable() = default;
+
+            FlatTable(const FlatTable& other) {
+                reserve(other.size());
+                for (const auto& item : other) {
+                    emplaceWithKey(P::getKey(item), item);
+                }
+            }
+
+            FlatTable(FlatTable&& other) noexcept {
+                take(std::move(other));
+            }
+
+            FlatTable& operator=(const FlatTable& other) {
+                if (this != &other) {
+                    clear();
+                    reserve(other.size());
+                    for (const auto& item : other) {
+                        emplaceWithKey(P::getKey(item), item);
+                    }
+                }
+
+                return *this;
+            }
+
+            FlatTable& operator=(FlatTable&& other) noexcept {
+                if (this != &other) {
+                    destroy();
+                    take(std::move(other));
+                }
+
+                return *this;
+            }
+
+            ~FlatTable() {
+                destroy();
+            }
+
+            size_t size() const { return used; }
+            bool empty() const { return used == 0; }
+            size_t getCapacity() const { return capacity; }
+
+            iterator begin() { return { pControl, pControl + capacity, pSlots }; }
+            iterator end() { return { pControl + capacity, pControl + capacity, pSlots + capacity }; }
+            const_iterator begin() const { return { pControl, pControl + capacity, pSlots }; }
+            const_iterator end() const { return { pControl + capacity, pControl + capacity, pSlots + capacity }; }
+
+            iterator find(const key_type& key) {
+                size_t index = findIndex(key);
+                return index == SIZE_MAX ? end() : iteratorAt(index);
+            }
+
+            const_iterator find(const key_type& key) const {
+                size_t index = findIndex(key);
+                return index == SIZE_MAX ? end() : const_iterator(pControl + index, pControl + capacity, pSlots + index);
+            }
+
+            bool contains(const key_type& key) const {
+                return findIndex(key) != SIZE_MAX;
+            }
+
+            size_t erase(const key_type& key) {
+                size_t index = findIndex(key);
+                if (index == SIZE_MAX) { return 0; }
+
+                std::destroy_at(pSlots + index);
+                used -= 1;
+
+                // a probe would stop at this group anyway if it already has an empty slot
+                if (Group(pControl + (index & ~(kGroupWidth - 1))).matchEmpty() != 0) {
+                    pControl[index] = kEmpty;
+                    growthLeft += 1;
+                } else {
+                    pControl[index] = kDeleted;
+                }
+
+                return 1;
+            }
+
+            // destroys every item but keeps the capacity
+            void clear() {
+                if (capacity == 0) { return; }
+
+                if (used > 0) {
+                    for (size_t i = 0; i < capacity; i++) {
+                        if (pControl[i] >= 0) {
+                            std::destroy_at(pSlots + i);
+                        }
+                    }
+                }
+
+                std::memset(pControl, kEmpty, capacity);
+                used = 0;
+                growthLeft = getMaxLoad(capacity);
+            }
+
+            void reserve(size_t count) {
+                size_t required = kGroupWidth;
+                while (getMaxLoad(required) < count) {
+                    required *= 2;
+                }
+
+                if (required > capacity) {
+                    rehash(required);
+                }
+            }
+
+        protected:
+            template<typename... A>
+            std::pair<iterator, bool> emplaceWithKey(const key_type& key, A&&... args) {
+                size_t hash = getHash(key);
+                if (size_t index = findIndex(key, hash); index != SIZE_MAX) {
+                    return { iteratorAt(index), false };
+                }
+
+                if (growthLeft == 0) {
+                    // mostly tombstones, rehashing at the same size is enough to reclaim them
+                    rehash(used < getMaxLoad(capacity) / 2 ? capacity : std::max(capacity * 2, kGroupWidth));
+                }
+
+                size_t index = findFree(hash);
+                if (pControl[index] == kEmpty) {
+                    growthLeft -= 1;
+                }
+
+                pControl[index] = getControl(hash);
+                std::construct_at(pSlots + index, std::forward<A>(args)...);
+                used += 1;
+
+                return { iteratorAt(index), true };
+            }
+
+        private:
+            static constexpr size_t getMaxLoad(size_t slots) { return slots - slots / 8; }
+
+            static size_t getHash(const key_type& key) { return mixHash(H{}(key)); }
+            static std::int8_t getControl(size_t hash) { return std::int8_t(hash & 0x7F); }
+
+            iterator iteratorAt(size_t index) {
+                return { pControl + index, pControl + capacity, pSlots + index };
+            }
+
+            size_t findIndex(const key_type& key) const {
+                return capacity == 0 ? SIZE_MAX : findIndex(key, getHash(key));
+            }
+
+            // triangular probing over a power of 2 group count visits every group once
+            size_t findIndex(const key_type& key, size_t hash) const {
+                if (capacity == 0) { return SIZE_MAX; }
+
+                size_t groups = capacity / kGroupWidth;
+                size_t group = (hash >> 7) & (groups - 1);
+                std::int8_t control = getControl(hash);
+
+                for (size_t i = 0; i < groups; i++) {
+                    Group it(pControl + group * kGroupWidth);
+
+                    for (std::uint32_t mask = it.match(control); mask != 0; mask &= mask - 1) {
+                        size_t index = group * kGroupWidth + std::countr_zero(mask);
+                        if (E{}(P::getKey(pSlots[index]), key)) {
+                            return index;
+                        }
+                    }
+
+                    if (it.matchEmpty() != 0) {
+                        return SIZE_MAX;
+                    }
+
+                    group = (group + i + 1) & (groups - 1);
+                }
+
+                return SIZE_MAX;
+            }
+
+            size_t findFree(size_t hash) const {
+                size_t groups = capacity / kGroupWidth;
+                size_t group = (hash >> 7) & (groups - 1);
+
+                for (size_t i = 0; i < groups; i++) {
+                    if (std::uint32_t mask = Group(pControl + group * kGroupWidth).matchFree(); mask != 0) {
+                        return group * kGroupWidth + std::countr_zero(mask);
+                    }
+
+                    group = (group + i + 1) & (groups - 1);
+                }
+
+                NEVER("flat table has no free slots");
+            }
+
+            void rehash(size_t newCapacity) {
+                std::int8_t *pOldControl = pControl;
+                value_type *pOldSlots = pSlots;
+                size_t oldCapacity = capacity;
+
+                pControl = new std::int8_t[newCapacity];
+                pSlots = std::allocator<value_type>().allocate(newCapacity);
+                capacity = newCapacity;
+
+                std::memset(pControl, kEmpty, newCapacity);
+                growthLeft = getMaxLoad(newCapacity) - used;
+
+                for (size_t i = 0; i < oldCapacity; i++) {
+                    if (pOldControl[i] < 0) { continue; }
+
+                    size_t hash = getHash(P::getKey(pOldSlots[i]));
+                    size_t index = findFree(hash);
+
+                    pControl[index] = getControl(hash);
+                    std::construct_at(pSlots + index, std::move(pOldSlots[i]));
+                    std::destroy_at(pOldSlots + i);
+                }
+
+                if (oldCapacity > 0) {
+                    delete[] pOldControl;
+                    std::allocator<value_type>().deallocate(pOldSlots, oldCapacity);
+                }
+            }
+
+            void destroy() {
+                if (capacity == 0) { return; }
+
+                clear();
+
+                delete[] pControl;
+                std::allocator<value_type>().deallocate(pSlots, capacity);
+
+                pControl = nullptr;
+                pSlots = nullptr;
+                capacity = 0;
+                growthLeft = 0;
+            }
+
+            void take(FlatTable&& other) {
+                pControl = std::exchange(other.pControl, nullptr);
+                pSlots = std::exchange(other.pSlots, nullptr);
+                capacity = std::exchange(other.capacity, 0);
+                used = std::exchange(other.used, 0);
+                growthLeft = std::exchange(other.growthLeft, 0);
+            }
+
+            std::int8_t *pControl = nullptr;
+            value_type *pSlots = nullptr;
+
+            size_t capacity = 0; // 0 or a power of 2 no smaller than a group
+            size_t used = 0;
+            size_t growthLeft = 0; // inserts into empty slots left before a rehash
+        };
+
+        template<typename K, typename V>
+        struct MapPolicy {
+            using Key = K;
+            using Value = std::pair<K, V>;
+
+            static const K& getKey(const Value& value) { return value.first; }
+        };
+
+        template<typename K>
+        struct SetPolicy {
+            using Key = K;
+            using Value = K;
+
+            static const K& getKey(const Value& value) { return value; }
+        };
+    }
+
+    // keys are stored in place, changing the key of an item through an iterator is not allowed
+    template<typename K, typename V, typename H = std::hash<K>, typename E = std::equal_to<K>>
+    struct FlatMap final : detail::FlatTable<detail::MapPolicy<K, V>, H, E> {
+        using Super = detail::FlatTable<detail::MapPolicy<K, V>, H, E>;
+        using typename Super::value_type;
+        using typename Super::iterator;
+        using typename Super::const_iterator;
+
+        using mapped_type = V;
+
+        FlatMap() = default;
+
+        FlatMap(std::initializer_list<value_type> items) {
+            this->reserve(items.size());
+            for (const auto& item : items) {
+                insert(item);
+            }
+        }
+
+        template<typename... A>
+        std::pair<iterator, bool> try_emplace(const K& key, A&&... args) {
+            return this->emplaceWithKey(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<A>(args)...));
+        }
+
+        std::pair<iterator, bool> insert(const value_type& item) {
+            return this->emplaceWithKey(item.first, item);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& item) {
+            const K key = item.first;
+            return this->emplaceWithKey(key, std::move(item));
+        }
+
+        V& operator[](const K& key) {
+            return try_emplace(key).first->second;
+        }
+
+        V& at(const K& key) {
+            auto it = this->find(key);
+            ASSERT(it != this->end());
+            return it->second;
+        }
+
+        const V& at(const K& key) const {
+            auto it = this->find(key);
+            ASSERT(it != this->end());
+            return it->second;
+        }
+    };
+
+    template<typename K, typename H = std::hash<K>, typename E = std::equal_to<K>>
+    struct FlatSet final : detail::FlatTable<detail::SetPolicy<K>, H, E> {
+        using Super = detail::FlatTable<detail::SetPolicy<K>, H, E>;
+        using typename Super::iterator;
+
+        FlatSet() = default;
+
+        FlatSet(std::initializer_list<K> items) {
+            this->reserve(items.size());
+            for (const auto& item : items) {
+                insert(item);
+            }
+        }
+
+        std::pair<iterator, bool> insert(const K& key) {
+            return this->emplaceWithKey(key, key);
+        }
+    };
+}
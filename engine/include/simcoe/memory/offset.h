@@ -0,0 +1,105 @@
+#pragma once
+
+#include "simcoe/core/units.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace simcoe::memory {
+    // two level segregated fit allocator over a range of offsets.
+    // it never touches the memory it manages so it can sub allocate
+    // gpu heaps as well as cpu memory, alloc and release are O(1)
+    struct OffsetAllocator final {
+        enum struct Index : std::uint32_t { eInvalid = UINT32_MAX };
+
+        struct Allocation {
+            size_t offset = SIZE_MAX;
+            Index index = Index::eInvalid;
+        };
+
+        struct Stats {
+            units::Memory size;
+            units::Memory used;
+            units::Memory peak;
+            units::Memory free;
+            units::Memory largestFree;
+
+            // 0 when all free space is contiguous, approaches 1 as it splinters
+            float fragmentation;
+
+            size_t allocations;
+        };
+
+        // sizes and alignments are rounded up to granularity, which must be a power of 2
+        OffsetAllocator(size_t size, size_t granularity = 256);
+
+        Allocation alloc(size_t size, size_t align = 1);
+        void release(Index index);
+
+        size_t getSize() const { return totalSize * granularity; }
+
+        Stats getStats() const;
+
+    private:
+        constexpr static inline std::uint32_t kNone = UINT32_MAX;
+        constexpr static inline size_t kSecondBits = 5;
+        constexpr static inline size_t kSecondCount = 1 << kSecondBits;
+        constexpr static inline size_t kFirstCount = 64 - kSecondBits;
+
+        struct Block {
+            // offset and size are in granularity units
+            size_t offset;
+            size_t size;
+
+            std::uint32_t prevPhysical = kNone;
+            std::uint32_t nextPhysical = kNone;
+
+            std::uint32_t prevFree = kNone;
+            std::uint32_t nextFree = kNone;
+
+            bool free = true;
+        };
+
+        struct Bin {
+            size_t first;
+            size_t second;
+        };
+
+        // the bin a block of size belongs in
+        static Bin getBin(size_t size);
+
+        // the first bin where every block is at least size
+        static Bin getSearchBin(size_t size);
+
+        std::uint32_t findFree(size_t size) const;
+
+        std::uint32_t newBlock(size_t offset, size_t size);
+        void deleteBlock(std::uint32_t index);
+
+        void insertFree(std::uint32_t index);
+        void removeFree(std::uint32_t index);
+
+        // split the tail of a block off into a new free block
+        void splitBack(std::uint32_t index, size_t size);
+
+        // split the front of a block off into a new free block
+        void splitFront(std::uint32_t index, size_t size);
+
+        // absorb other into index, other must directly follow index
+        void merge(std::uint32_t index, std::uint32_t other);
+
+        size_t granularity;
+        size_t totalSize;
+
+        size_t usedSize = 0;
+        size_t peakSize = 0;
+        size_t allocations = 0;
+
+        std::uint64_t firstBitmap = 0;
+        std::uint32_t secondBitmap[kFirstCount] = {};
+        std::uint32_t freeHeads[kFirstCount][kSecondCount];
+
+        std::vector<Block> blocks;
+        std::vector<std::uint32_t> unusedBlocks;
+    };
+}
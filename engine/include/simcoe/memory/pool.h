@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace simcoe::memory {
+    namespace detail {
+        // size classes are powers of two from 16 to 1024 bytes
+        // larger allocations go straight to the global heap
+        constexpr size_t kMinSizeClass = 16;
+        constexpr size_t kMaxSizeClass = 1024;
+
+        // each thread caches freed objects in magazines per size class.
+        // memory freed on one thread is reused by that thread, full magazines
+        // are traded through a shared depot so no thread hoards memory
+        void *poolAlloc(size_t size);
+        void poolFree(void *ptr, size_t size);
+    }
+
+    // inherit to route new and delete through the pool
+    // types must have a virtual destructor if deleted through a base pointer
+    struct Pooled {
+        static void *operator new(size_t size) {
+            return detail::poolAlloc(size);
+        }
+
+        static void operator delete(void *ptr, size_t size) {
+            detail::poolFree(ptr, size);
+        }
+
+        // overaligned types bypass the pool
+        static void *operator new(size_t size, std::align_val_t align) {
+            return ::operator new(size, align);
+        }
+
+        static void operator delete(void *ptr, size_t size, std::align_val_t align) {
+            ::operator delete(ptr, size, align);
+        }
+    };
+
+    // typed access to the pool, objects must be destroyed as the type they were created as
+    template<typename T>
+    struct ObjectPool {
+        static_assert(alignof(T) <= detail::kMinSizeClass, "overaligned types cannot be pooled");
+
+        template<typename... A>
+        static T *create(A&&... args) {
+            void *ptr = detail::poolAlloc(sizeof(T));
+            return new (ptr) T(std::forward<A>(args)...);
+        }
+
+        static void destroy(T *ptr) {
+            if (ptr == nullptr) { return; }
+
+            ptr->~T();
+            detail::poolFree(ptr, sizeof(T));
+        }
+
+        struct Delete {
+            void operator()(T *ptr) const { destroy(ptr); }
+        };
+
+        using Unique = std::unique_ptr<T, Delete>;
+
+        template<typename... A>
+        static Unique unique(A&&... args) {
+            return Unique(create(std::forward<A>(args)...));
+        }
+    };
+}
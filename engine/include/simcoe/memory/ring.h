@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simcoe::memory {
+    // a monotonic counter the gpu advances as it finishes work
+    struct IFence {
+        virtual ~IFence() = default;
+
+        virtual std::uint64_t getCompletedValue() const = 0;
+    };
+
+    // linear allocator over fixed size chunks for transient per frame data.
+    // chunks used during a frame are retired with the fence value that frame
+    // signals and only handed out again once the fence has passed it.
+    // backend agnostic, chunks are just indices so the owner decides what
+    // memory backs them. not thread safe
+    struct ChunkRing final {
+        struct Allocation {
+            size_t chunk;
+            size_t offset;
+        };
+
+        ChunkRing(IFence& fence, size_t chunkSize);
+
+        // size must fit in a single chunk.
+        // if the returned chunk is >= the previous chunk count the owner must back it
+        Allocation alloc(size_t size, size_t align);
+
+        // call once the frame is submitted with the value its fence will signal
+        void retire(std::uint64_t value);
+
+        size_t getChunkSize() const { return chunkSize; }
+        size_t getChunkCount() const { return chunkCount; }
+
+        // chunks in use by the current frame or waiting on the fence
+        size_t getBusyCount() const { return chunkCount - freeChunks.size(); }
+
+    private:
+        constexpr static inline size_t kNone = SIZE_MAX;
+
+        struct Retired {
+            size_t chunk;
+            std::uint64_t value;
+        };
+
+        size_t nextChunk();
+
+        // move chunks whose fence value has completed back onto the free list
+        void reclaim();
+
+        IFence& fence;
+        size_t chunkSize;
+        size_t chunkCount = 0;
+
+        size_t current = kNone;
+        size_t offset = 0;
+
+        std::vector<size_t> frameChunks;
+        std::vector<Retired> retired;
+        std::vector<size_t> freeChunks;
+    };
+}
@@ -1,66 +1,128 @@
 #pragma once
 
-#include <memory>
+#include "simcoe/core/panic.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
 
 namespace simcoe::memory {
-    namespace detail {
-        template<typename T, T Empty>
-        struct Storage {
-            constexpr Storage(size_t bits): size(bits), pSlots(new T[wordCount()]) {
-                reset();
-            }
+    // generational slot map
+    // handles are a 32 bit slot index and a 32 bit generation, a slot bumps its
+    // generation on release so stale handles fail test() rather than aliasing.
+    // values are kept packed in a dense array so iteration never skips holes
+    template<typename T>
+    struct SlotMap final {
+        enum struct Index : std::uint64_t { eInvalid = UINT64_MAX };
+
+        SlotMap(size_t size = 0) {
+            slots.reserve(size);
+            values.reserve(size);
+            owners.reserve(size);
+        }
 
-            constexpr size_t getSize() const { return size; }
+        template<typename... A>
+        Index alloc(A&&... args) {
+            std::uint32_t slot = freeHead;
 
-        protected:
-            constexpr void reset() {
-                std::fill_n(pSlots.get(), getSize(), Empty);
+            if (slot == kNone) {
+                ASSERT(slots.size() < kNone);
+                slot = std::uint32_t(slots.size());
+                slots.push_back({ kNone, 0 });
+            } else {
+                freeHead = slots[slot].target;
             }
 
-            size_t size;
-            std::unique_ptr<T[]> pSlots;
-        };
-    }
+            slots[slot].target = std::uint32_t(values.size());
+            values.emplace_back(std::forward<A>(args)...);
+            owners.push_back(slot);
 
-    template<typename T, T Empty = T()>
-    struct SlotMap final : detail::Storage<T, Empty> {
-        using Super = detail::Storage<T, Empty>;
-        using Super::Super;
+            return newIndex(slot, slots[slot].generation);
+        }
 
-        enum struct Index : size_t { eInvalid = SIZE_MAX };
+        void release(Index index) {
+            ASSERT(test(index));
 
-        SlotMap(size_t size) : Super(size) { }
+            std::uint32_t slot = getSlot(index);
+            std::uint32_t dense = slots[slot].target;
+            std::uint32_t last = std::uint32_t(values.size() - 1);
 
-        Index alloc(const T& value) {
-            for (size_t i = 0; i < Super::getSize(); ++i) {
-                if (Super::pSlots[i] == Empty) {
-                    Super::pSlots[i] = value;
-                    return Index(i);
-                }
+            // move the last value into the hole to keep the array packed
+            if (dense != last) {
+                values[dense] = std::move(values[last]);
+                owners[dense] = owners[last];
+                slots[owners[dense]].target = dense;
             }
 
-            return Index::eInvalid;
-        }
+            values.pop_back();
+            owners.pop_back();
 
-        void release(Index index) {
-            ASSERT(get(index) != Empty);
-            set(index, Empty);
+            slots[slot].generation += 1;
+            slots[slot].target = freeHead;
+            freeHead = slot;
         }
 
-        bool test(Index index, const T& expected) const {
-            return Super::pSlots[size_t(index)] == expected;
+        bool test(Index index) const {
+            if (index == Index::eInvalid) { return false; }
+
+            std::uint32_t slot = getSlot(index);
+            if (slot >= slots.size()) { return false; }
+
+            const auto& [target, generation] = slots[slot];
+            return generation == getGeneration(index) && target < values.size() && owners[target] == slot;
         }
 
-        T get(Index index) const {
-            ASSERT(index != Index::eInvalid);
+        T& get(Index index) {
+            ASSERT(test(index));
+            return values[slots[getSlot(index)].target];
+        }
 
-            return Super::pSlots[size_t(index)];
+        const T& get(Index index) const {
+            ASSERT(test(index));
+            return values[slots[getSlot(index)].target];
         }
 
         void set(Index index, const T& value) {
-            ASSERT(index != Index::eInvalid);
+            get(index) = value;
+        }
 
-            Super::pSlots[size_t(index)] = value;
+        // the handle of a value in the dense array
+        Index getIndex(size_t dense) const {
+            std::uint32_t slot = owners[dense];
+            return newIndex(slot, slots[slot].generation);
         }
+
+        size_t getSize() const { return values.size(); }
+        bool empty() const { return values.empty(); }
+
+        std::span<T> getValues() { return values; }
+        std::span<const T> getValues() const { return values; }
+
+        auto begin() { return values.begin(); }
+        auto end() { return values.end(); }
+        auto begin() const { return values.begin(); }
+        auto end() const { return values.end(); }
+
+    private:
+        constexpr static inline std::uint32_t kNone = UINT32_MAX;
+
+        struct Slot {
+            // index into values when live, next free slot when released
+            std::uint32_t target;
+            std::uint32_t generation;
+        };
+
+        static constexpr Index newIndex(std::uint32_t slot, std::uint32_t generation) {
+            return Index((std::uint64_t(generation) << 32) | slot);
+        }
+
+        static constexpr std::uint32_t getSlot(Index index) { return std::uint32_t(std::uint64_t(index)); }
+        static constexpr std::uint32_t getGeneration(Index index) { return std::uint32_t(std::uint64_t(index) >> 32); }
+
+        std::vector<Slot> slots;
+        std::vector<T> values;
+        std::vector<std::uint32_t> owners;
+
+        std::uint32_t freeHead = kNone;
     };
-}
\ No newline at end of file
+}
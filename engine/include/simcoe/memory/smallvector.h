@@ -0,0 +1,214 @@
+#pragma once
+
+#include "simcoe/core/panic.h"
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace simcoe::memory {
+    // vector that stores up to N items inline and only touches the heap once it grows past that.
+    // meant for the many tiny lists in hot structures that almost never hold more than a handful
+    template<typename T, size_t N>
+    struct SmallVector final {
+        static_assert(N > 0, "use std::vector if there is no inline storage");
+
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() = default;
+
+        SmallVector(std::initializer_list<T> items) {
+            append(items.begin(), items.end());
+        }
+
+        template<std::input_iterator I>
+        SmallVector(I first, I last) {
+            append(first, last);
+        }
+
+        explicit SmallVector(std::span<const T> items) {
+            append(items.begin(), items.end());
+        }
+
+        SmallVector(const SmallVector& other) {
+            append(other.begin(), other.end());
+        }
+
+        SmallVector(SmallVector&& other) noexcept {
+            take(std::move(other));
+        }
+
+        SmallVector& operator=(const SmallVector& other) {
+            if (this != &other) {
+                clear();
+                append(other.begin(), other.end());
+            }
+
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept {
+            if (this != &other) {
+                clear();
+                deallocate();
+                take(std::move(other));
+            }
+
+            return *this;
+        }
+
+        ~SmallVector() {
+            clear();
+            deallocate();
+        }
+
+        template<typename... A>
+        T& emplace_back(A&&... args) {
+            if (used == limit) {
+                return growEmplace(std::forward<A>(args)...);
+            }
+
+            T *pItem = std::construct_at(pData + used, std::forward<A>(args)...);
+            used += 1;
+            return *pItem;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() {
+            ASSERT(used > 0);
+            used -= 1;
+            std::destroy_at(pData + used);
+        }
+
+        void clear() {
+            std::destroy_n(pData, used);
+            used = 0;
+        }
+
+        void reserve(size_t count) {
+            if (count > limit) {
+                relocate(count);
+            }
+        }
+
+        void resize(size_t count) {
+            reserve(count);
+
+            while (used < count) {
+                emplace_back();
+            }
+
+            while (used > count) {
+                pop_back();
+            }
+        }
+
+        T *data() { return pData; }
+        const T *data() const { return pData; }
+
+        size_t size() const { return used; }
+        size_t capacity() const { return limit; }
+        bool empty() const { return used == 0; }
+
+        // true while nothing has spilled to the heap
+        bool isInline() const { return pData == getInline(); }
+
+        T& operator[](size_t index) { ASSERT(index < used); return pData[index]; }
+        const T& operator[](size_t index) const { ASSERT(index < used); return pData[index]; }
+
+        T& front() { return (*this)[0]; }
+        const T& front() const { return (*this)[0]; }
+
+        T& back() { return (*this)[used - 1]; }
+        const T& back() const { return (*this)[used - 1]; }
+
+        iterator begin() { return pData; }
+        iterator end() { return pData + used; }
+        const_iterator begin() const { return pData; }
+        const_iterator end() const { return pData + used; }
+
+        operator std::span<T>() { return { pData, used }; }
+        operator std::span<const T>() const { return { pData, used }; }
+
+    private:
+        T *getInline() { return reinterpret_cast<T*>(storage); }
+        const T *getInline() const { return reinterpret_cast<const T*>(storage); }
+
+        template<typename I>
+        void append(I first, I last) {
+            if constexpr (std::forward_iterator<I>) {
+                reserve(used + size_t(std::distance(first, last)));
+            }
+
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+
+        // construct the new item before moving the old ones so args may alias an existing item
+        template<typename... A>
+        T& growEmplace(A&&... args) {
+            size_t newLimit = limit * 2;
+            T *pNew = std::allocator<T>().allocate(newLimit);
+            T *pItem = std::construct_at(pNew + used, std::forward<A>(args)...);
+
+            std::uninitialized_move_n(pData, used, pNew);
+            std::destroy_n(pData, used);
+            deallocate();
+
+            pData = pNew;
+            limit = newLimit;
+            used += 1;
+            return *pItem;
+        }
+
+        void relocate(size_t newLimit) {
+            T *pNew = std::allocator<T>().allocate(newLimit);
+
+            std::uninitialized_move_n(pData, used, pNew);
+            std::destroy_n(pData, used);
+            deallocate();
+
+            pData = pNew;
+            limit = newLimit;
+        }
+
+        void deallocate() {
+            if (!isInline()) {
+                std::allocator<T>().deallocate(pData, limit);
+                pData = getInline();
+                limit = N;
+            }
+        }
+
+        // steal a heap buffer outright, inline items have to be moved one at a time
+        void take(SmallVector&& other) {
+            if (!other.isInline()) {
+                pData = std::exchange(other.pData, other.getInline());
+                limit = std::exchange(other.limit, N);
+                used = std::exchange(other.used, 0);
+                return;
+            }
+
+            std::uninitialized_move_n(other.pData, other.used, pData);
+            used = other.used;
+            other.clear();
+        }
+
+        alignas(T) std::byte storage[sizeof(T) * N];
+
+        T *pData = getInline();
+        size_t used = 0;
+        size_t limit = N;
+    };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "simcoe/core/units.h"
+
+#include <cstddef>
+
+// replaces global operator new/delete to attribute heap use to subsystems.
+// when 0 the scopes below compile to nothing and the allocator is untouched
+#ifndef SIMCOE_ALLOC_TRACKING
+#   define SIMCOE_ALLOC_TRACKING 0
+#endif
+
+namespace simcoe::memory {
+    enum Tag {
+        eUntagged,
+        eRender,
+        eAssets,
+        eInput,
+        eLogging,
+        eImGui,
+
+        eTagCount
+    };
+
+    struct TagStats {
+        units::Memory live;
+        units::Memory peak;
+        size_t allocs;
+        size_t frees;
+    };
+
+    constexpr bool kAllocTracking = SIMCOE_ALLOC_TRACKING;
+
+    const char *getTagName(Tag tag);
+
+    // all zero when tracking is compiled out
+    TagStats getTagStats(Tag tag);
+
+#if SIMCOE_ALLOC_TRACKING
+    // attribute heap allocations made by this thread to a tag until the scope ends
+    struct TagScope final {
+        TagScope(Tag tag);
+        ~TagScope();
+
+        TagScope(const TagScope&) = delete;
+
+    private:
+        Tag previous;
+    };
+
+    // PANICs if this thread allocates from the heap while the scope is active
+    struct ZeroAllocScope final {
+        ZeroAllocScope(const char *pzName, bool enabled = true);
+        ~ZeroAllocScope();
+
+        ZeroAllocScope(const ZeroAllocScope&) = delete;
+
+    private:
+        const char *pzPrevious;
+    };
+
+    // suspends any enclosing ZeroAllocScope, for diagnostics like logging and debug ui
+    struct AllowAllocScope final {
+        AllowAllocScope();
+        ~AllowAllocScope();
+
+        AllowAllocScope(const AllowAllocScope&) = delete;
+
+    private:
+        const char *pzPrevious;
+    };
+#else
+    struct TagScope final {
+        TagScope(Tag) { }
+    };
+
+    struct ZeroAllocScope final {
+        ZeroAllocScope(const char *, bool = true) { }
+    };
+
+    struct AllowAllocScope final {
+        AllowAllocScope() { }
+    };
+#endif
+}
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "simcoe/core/framestats.h"
 #include "simcoe/core/system.h"
+#include "simcoe/core/topology.h"
 #include "simcoe/core/logging.h"
 #include "simcoe/core/util.h"
+#include "simcoe/core/units.h"
+
+#include "simcoe/memory/arena.h"
+#include "simcoe/memory/offset.h"
 
 #include "simcoe/render/heap.h"
+#include "simcoe/render/upload.h"
+
+#include "simcoe/threads/mutex.h"
 
 #include "simcoe/simcoe.h"
 
@@ -12,6 +21,10 @@
 #include <dxgi1_6.h>
 #include <dxgidebug.h>
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace simcoe::render {
     struct CommandQueue {
         void newCommandQueue(ID3D12Device *pDevice, D3D12_COMMAND_LIST_TYPE type, const char *pzName);
@@ -20,14 +33,15 @@ namespace simcoe::render {
         ID3D12CommandQueue *pQueue = nullptr;
     };
 
-    struct Fence {
+    struct Fence final : memory::IFence {
         void newFence(ID3D12Device *pDevice, const char *pzName);
         void deleteFence();
 
         void wait(CommandQueue& queue);
 
+        std::uint64_t getCompletedValue() const override;
+
         ID3D12Fence *pFence = nullptr;
-        HANDLE hEvent = nullptr;
         UINT value = 1;
     };
 
@@ -44,6 +58,26 @@ namespace simcoe::render {
         Fence fence;
     };
 
+    // a large gpu heap that placed resources are sub allocated from
+    struct ResourceHeap {
+        using Index = memory::OffsetAllocator::Index;
+
+        void newResourceHeap(ID3D12Device *pDevice, D3D12_HEAP_TYPE type, D3D12_HEAP_FLAGS flags, size_t size, const char *pzName);
+        void deleteResourceHeap();
+
+        // returns nullptr if there is no space left in the heap
+        ID3D12Resource *newResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state, const D3D12_CLEAR_VALUE *pClear, Index& index);
+        void deleteResource(Index index);
+
+        memory::OffsetAllocator::Stats getStats();
+
+        ID3D12Device *pDevice = nullptr;
+        ID3D12Heap *pHeap = nullptr;
+
+        threads::Mutex lock;
+        std::unique_ptr<memory::OffsetAllocator> pAllocator;
+    };
+
     struct Context {
         constexpr static inline size_t kDefaultAdapter = SIZE_MAX;
 
@@ -52,8 +86,19 @@ namespace simcoe::render {
             size_t frames = 2; // number of back buffers
 
             size_t heapSize = 1024;
+            size_t textureTableSize = 512; // scene texture descriptors, taken out of the cbv heap
             size_t queueSize = 1024;
-            size_t workerThreads = 2;
+            size_t workerThreads = os::threads::getDefaultWorkerCount(); // job scheduler workers, the creating thread also runs jobs while it waits
+
+            size_t frameArenaSize = units::Memory::kMegabyte; // size of each per frame arena block
+
+            size_t uploadHeapSize = 64 * units::Memory::kMegabyte; // placed upload buffers
+            size_t bufferHeapSize = 128 * units::Memory::kMegabyte; // placed gpu only buffers
+            size_t textureHeapSize = 256 * units::Memory::kMegabyte; // placed non render target textures
+
+            size_t uploadChunkSize = 64 * units::Memory::kKilobyte; // size of each per frame constant chunk
+
+            size_t frameStatsWindow = 1024; // frames of timing history kept
         };
 
         Context(os::Window& window, const Info& info);
@@ -61,6 +106,8 @@ namespace simcoe::render {
 
         void update(const Info& info);
 
+        const Info& getInfo() const { return info; }
+
         void beginRender();
         void endRender();
 
@@ -76,6 +123,18 @@ namespace simcoe::render {
         Heap& getRtvHeap() { return rtvHeap; }
         Heap& getDsvHeap() { return dsvHeap; }
 
+        // transient memory for the current frame, released once the frame is presented
+        memory::FrameArena& getFrameArena() { return frameArena; }
+
+        // gpu visible constants for the current frame, recycled once the frame is presented
+        UploadRing& getUploadRing() { return *pUploadRing; }
+
+        ResourceHeap& getUploadHeap() { return uploadHeap; }
+        ResourceHeap& getBufferHeap() { return bufferHeap; }
+        ResourceHeap& getTextureHeap() { return textureHeap; }
+
+        // placed in the upload or buffer heap when pProps is one of those types.
+        // falls back to a committed resource using flags otherwise
         ID3D12Resource *newBuffer(
             size_t size,
             const D3D12_HEAP_PROPERTIES *pProps,
@@ -83,11 +142,27 @@ namespace simcoe::render {
             D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_CREATE_NOT_ZEROED
         );
 
+        // placed in the texture heap, cannot be a render target or depth stencil
+        ID3D12Resource *newTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state);
+
+        // release a resource from newBuffer or newTexture and its placement
+        void deleteResource(ID3D12Resource *pResource);
+
         CommandBuffer newCommandBuffer(D3D12_COMMAND_LIST_TYPE type, const char *pzName = "command-buffer");
 
         void submitDirectCommands(CommandBuffer& buffer);
         void submitCopyCommands(CommandBuffer& buffer);
 
+        // bracket the gpu work of a frame on the direct queue, end also resolves the timestamps
+        void beginGpuTimer(ID3D12GraphicsCommandList *pCommands);
+        void endGpuTimer(ID3D12GraphicsCommandList *pCommands);
+
+        // time between the two timestamps, only valid once the commands have finished
+        Duration getGpuTime();
+
+        // only touched on the render thread, or once it has stopped
+        FrameStats& getFrameStats() { return frameStats; }
+
     private:
         void newFactory();
         void deleteFactory();
@@ -112,9 +187,24 @@ namespace simcoe::render {
         void newHeaps();
         void deleteHeaps();
 
+        void newResourceHeaps();
+        void deleteResourceHeaps();
+
+        ID3D12Resource *newPlacedResource(
+            ResourceHeap& heap,
+            const D3D12_RESOURCE_DESC& desc,
+            D3D12_RESOURCE_STATES state
+        );
+
         void newFence();
         void deleteFence();
 
+        void newUploadRing();
+        void deleteUploadRing();
+
+        void newTimestamps();
+        void deleteTimestamps();
+
         void waitForFence();
         void nextFrame();
 
@@ -151,5 +241,37 @@ namespace simcoe::render {
         Heap rtvHeap;
         Heap cbvHeap;
         Heap dsvHeap;
+
+        struct Placement {
+            ResourceHeap *pHeap;
+            ResourceHeap::Index index;
+        };
+
+        ResourceHeap uploadHeap;
+        ResourceHeap bufferHeap;
+        ResourceHeap textureHeap;
+
+        threads::Mutex placementLock;
+        std::unordered_map<ID3D12Resource*, Placement> placements;
+        util::DoOnce reportHeapExhausted;
+
+        std::unique_ptr<UploadRing> pUploadRing;
+
+        enum Timestamp : UINT {
+            eFrameBegin,
+            eFrameEnd,
+
+            eTimestampCount
+        };
+
+        ID3D12QueryHeap *pTimestampHeap = nullptr;
+        ID3D12Resource *pTimestampBuffer = nullptr; // readback
+        UINT64 timestampFrequency = 0;
+
+        memory::FrameArena frameArena;
+        size_t arenaOverflows = 0;
+        util::DoOnce reportArenaOverflow;
+
+        FrameStats frameStats;
     };
 }
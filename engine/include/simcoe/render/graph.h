@@ -2,8 +2,14 @@
 
 #include "simcoe/render/context.h"
 
+#include "simcoe/core/metrics.h"
+#include "simcoe/core/name.h"
+
+#include "simcoe/memory/flatmap.h"
+#include "simcoe/memory/pool.h"
+#include "simcoe/memory/smallvector.h"
+
 #include <d3d12.h>
-#include <unordered_map>
 
 // TODO: need some way to specify input state requirements
 // and output state specifications
@@ -12,23 +18,27 @@
 // and pass A binds X, Y, and Z 
 
 namespace simcoe::render {
+    // passes record their own draws so they count them here
+    extern metrics::Counter gDrawCalls;
+
     struct Graph;
     struct GraphObject;
     struct Pass;
     struct Edge;
 
-    struct GraphObject {
-        GraphObject(const std::string& name, Graph& graph);
+    // passes and edges are allocated from the object pool
+    struct GraphObject : memory::Pooled {
+        GraphObject(util::Name name, Graph& graph);
         GraphObject(const GraphObject& other);
 
         virtual ~GraphObject() = default;
 
-        const char *getName() const;
+        util::Name getName() const;
         Graph& getGraph() const;
         Context& getContext() const;
 
     private:
-        std::string name;
+        util::Name name;
         struct Graph& graph;
     };
 
@@ -90,8 +100,8 @@ namespace simcoe::render {
     };
 
     struct Pass : GraphObject {
-        using InEdgeVec = std::vector<std::unique_ptr<InEdge>>;
-        using OutEdgeVec = std::vector<std::unique_ptr<OutEdge>>;
+        using InEdgeVec = memory::SmallVector<std::unique_ptr<InEdge>, 4>;
+        using OutEdgeVec = memory::SmallVector<std::unique_ptr<OutEdge>, 4>;
 
         Pass(const GraphObject& other) : GraphObject(other) {}
 
@@ -104,12 +114,12 @@ namespace simcoe::render {
 
     protected:
         template<typename T> requires (std::is_base_of_v<InEdge, T>)
-        T *in(const std::string& name, auto&&... args) {
+        T *in(util::Name name, auto&&... args) {
             return static_cast<T*>(addInput(new T(GraphObject(name, getGraph()), this, args...)));
         }
 
         template<typename T> requires (std::is_base_of_v<OutEdge, T>)
-        T *out(const std::string& name, auto&&... args) {
+        T *out(util::Name name, auto&&... args) {
             return static_cast<T*>(addOutput(new T(GraphObject(name, getGraph()), this, args...)));
         }
 
@@ -122,8 +132,9 @@ namespace simcoe::render {
     };
 
     struct Graph {
-        using PassMap = std::unordered_map<std::string, std::unique_ptr<Pass>>;
-        using EdgeMap = std::unordered_map<InEdge*, OutEdge*>;
+        using PassMap = memory::FlatMap<util::Name, std::unique_ptr<Pass>>;
+        using EdgeMap = memory::FlatMap<InEdge*, OutEdge*>;
+        using VisitedSet = memory::FlatSet<Pass*>;
 
         Graph(Context& context);
 
@@ -141,7 +152,7 @@ namespace simcoe::render {
         void execute(Pass *pRoot);
 
         template<typename T> requires (std::is_base_of_v<Pass, T>)
-        T *addPass(const std::string& name, auto&&... args) {
+        T *addPass(util::Name name, auto&&... args) {
             T *pPass = new T(GraphObject(name, *this), args...);
             passes[name] = std::unique_ptr<Pass>(pPass);
             return pPass;
@@ -153,5 +164,8 @@ namespace simcoe::render {
 
         PassMap passes;
         EdgeMap edges;
+
+        // passes already recorded this frame, cleared rather than rebuilt so it keeps its capacity
+        VisitedSet visited;
     };
 }
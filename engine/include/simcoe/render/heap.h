@@ -1,6 +1,7 @@
 #pragma once
 
 #include "simcoe/render/render.h"
+#include "simcoe/core/metrics.h"
 #include "simcoe/memory/bitmap.h"
 
 namespace simcoe::render {
@@ -9,7 +10,8 @@ namespace simcoe::render {
         using CpuHandle = D3D12_CPU_DESCRIPTOR_HANDLE;
         using GpuHandle = D3D12_GPU_DESCRIPTOR_HANDLE;
 
-        Heap(size_t size);
+        // pUsed tracks how many descriptors are allocated when set
+        Heap(size_t size, metrics::Gauge *pUsed = nullptr);
 
         void newHeap(ID3D12Device *pDevice, D3D12_DESCRIPTOR_HEAP_FLAGS flags, D3D12_DESCRIPTOR_HEAP_TYPE type);
         void deleteHeap();
@@ -17,6 +19,10 @@ namespace simcoe::render {
         Index alloc();
         void release(Index index);
 
+        // contiguous descriptors for tables
+        Index allocRange(size_t count);
+        void releaseRange(Index index, size_t count);
+
         CpuHandle cpuHandle() const;
         GpuHandle gpuHandle() const;
 
@@ -26,7 +32,10 @@ namespace simcoe::render {
         ID3D12DescriptorHeap *getHeap() const { return pHeap; }
 
     private:
+        void track(Index index, int64_t count);
+
         memory::AtomicBitMap map;
+        metrics::Gauge *pUsed;
         
         ID3D12DescriptorHeap *pHeap = nullptr;
         UINT descriptorSize = 0;
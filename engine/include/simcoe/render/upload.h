@@ -0,0 +1,52 @@
+#pragma once
+
+#include "simcoe/memory/ring.h"
+
+#include "simcoe/render/render.h"
+
+#include <vector>
+
+namespace simcoe::render {
+    struct Context;
+
+    // persistently mapped upload memory for constants that only live for a frame.
+    // each allocation is fresh memory so writing it never races the gpu reading
+    // a previous frames copy. only use from the render thread
+    struct UploadRing {
+        template<typename T>
+        struct Constant {
+            T *pData;
+            D3D12_GPU_VIRTUAL_ADDRESS address;
+        };
+
+        UploadRing(Context& context, memory::IFence& fence, size_t chunkSize);
+        ~UploadRing();
+
+        template<typename T>
+        Constant<T> allocate() {
+            auto [pData, address] = allocate(sizeof(T), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+            return { static_cast<T*>(pData), address };
+        }
+
+        Constant<void> allocate(size_t size, size_t align);
+
+        // called by the context once a frame is submitted
+        void retire(std::uint64_t value) { ring.retire(value); }
+
+        size_t getChunkCount() const { return ring.getChunkCount(); }
+        size_t getBusyCount() const { return ring.getBusyCount(); }
+
+    private:
+        struct Chunk {
+            ID3D12Resource *pResource;
+            std::byte *pData;
+            D3D12_GPU_VIRTUAL_ADDRESS address;
+        };
+
+        void newChunk();
+
+        Context& context;
+        memory::ChunkRing ring;
+        std::vector<Chunk> chunks;
+    };
+}
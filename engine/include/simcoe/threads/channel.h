@@ -0,0 +1,280 @@
+#pragma once
+
+#include "simcoe/core/panic.h"
+
+#include "concurrentqueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <thread>
+
+namespace simcoe::threads {
+    enum struct ChannelKind {
+        eSPSC, // one producer thread, one consumer thread
+        eMPSC, // any thread produces, one consumer thread
+        eMPMC  // any thread on either side
+    };
+
+    namespace detail {
+        // route the queue's blocks through operator new so allocation tracking sees them
+        struct ChannelTraits : moodycamel::ConcurrentQueueDefaultTraits {
+            static void *malloc(size_t size) { return ::operator new(size, std::nothrow); }
+            static void free(void *ptr) { ::operator delete(ptr); }
+        };
+
+        // sleep/wake on a counter with std::atomic wait, a futex or WaitOnAddress underneath.
+        // wakers only pay for a notify when someone is actually asleep
+        struct Waiters {
+            // call after making the condition true
+            void wake() {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (sleeping.load(std::memory_order_relaxed) > 0) {
+                    epoch.fetch_add(1, std::memory_order_release);
+                    epoch.notify_all();
+                }
+            }
+
+            // sleep until ready() returns true or someone wakes us, callers loop around this.
+            // gives the other side a few chances to run first since parking costs a syscall on both ends
+            template<typename F>
+            void wait(F&& ready) {
+                for (size_t i = 0; i < kYieldCount; i++) {
+                    if (ready()) { return; }
+                    std::this_thread::yield();
+                }
+
+                sleeping.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                uint32_t current = epoch.load(std::memory_order_acquire);
+                if (!ready()) {
+                    epoch.wait(current, std::memory_order_acquire);
+                }
+
+                sleeping.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+        private:
+            static constexpr size_t kYieldCount = 16;
+
+            std::atomic_uint32_t epoch = 0;
+            std::atomic_uint32_t sleeping = 0;
+        };
+    }
+
+    // typed lock free queue between threads built on moodycamel::ConcurrentQueue.
+    // single producer and single consumer kinds use the queue's tokens which skip the
+    // per thread producer lookup, the caller promises only one thread uses that side at a time.
+    // bounded channels fail or block pushes once capacity items are queued, unbounded ones allocate.
+    // close() wakes everyone, pushes then fail and pops drain what is left
+    template<typename T, ChannelKind K = ChannelKind::eMPMC>
+    struct Channel {
+        static constexpr size_t kUnbounded = SIZE_MAX;
+
+        // items preallocated up front by an unbounded channel
+        static constexpr size_t kInitialSize = 1024;
+
+        static constexpr bool kSingleProducer = K == ChannelKind::eSPSC;
+        static constexpr bool kSingleConsumer = K != ChannelKind::eMPMC;
+
+        Channel(size_t capacity = kUnbounded)
+            : capacity(capacity)
+            , queue(capacity == kUnbounded ? kInitialSize : capacity)
+        {
+            ASSERT(capacity > 0);
+
+            if constexpr (kSingleProducer) { producer.emplace(queue); }
+            if constexpr (kSingleConsumer) { consumer.emplace(queue); }
+        }
+
+        Channel(const Channel&) = delete;
+        Channel& operator=(const Channel&) = delete;
+
+        /// producers
+
+        bool tryPush(T item) {
+            if (isClosed() || !reserve(1)) { return false; }
+
+            enqueue(std::move(item));
+            readable.wake();
+            return true;
+        }
+
+        // blocks while the channel is full, false if it closed first
+        bool push(T item) {
+            if (!waitReserve(1)) { return false; }
+
+            enqueue(std::move(item));
+            readable.wake();
+            return true;
+        }
+
+        // all or nothing. items are moved out of the range
+        template<typename It>
+        bool tryPushBulk(It first, size_t count) {
+            if (isClosed() || !reserve(count)) { return false; }
+
+            enqueueBulk(first, count);
+            readable.wake();
+            return true;
+        }
+
+        template<typename It>
+        bool pushBulk(It first, size_t count) {
+            ASSERTF(count <= capacity, "bulk push of {} can never fit in a channel of {}", count, capacity);
+            if (!waitReserve(count)) { return false; }
+
+            enqueueBulk(first, count);
+            readable.wake();
+            return true;
+        }
+
+        void close() {
+            closed.store(true, std::memory_order_release);
+            readable.wake();
+            writable.wake();
+        }
+
+        /// consumers
+
+        bool tryPop(T& item) {
+            if (!dequeue(item)) { return false; }
+
+            release(1);
+            return true;
+        }
+
+        // blocks until an item arrives, false once the channel is closed and empty
+        bool pop(T& item) {
+            while (!tryPop(item)) {
+                if (isClosed()) {
+                    // anything pushed before the close is still visible
+                    return tryPop(item);
+                }
+
+                readable.wait([&] { return isClosed() || getSizeApprox() > 0; });
+            }
+
+            return true;
+        }
+
+        // up to max items, returns how many were taken
+        template<typename It>
+        size_t tryPopBulk(It first, size_t max) {
+            size_t count = dequeueBulk(first, max);
+            if (count > 0) { release(count); }
+            return count;
+        }
+
+        // blocks until at least one item arrives, zero once the channel is closed and empty
+        template<typename It>
+        size_t popBulk(It first, size_t max) {
+            while (true) {
+                if (size_t count = tryPopBulk(first, max); count > 0) {
+                    return count;
+                }
+
+                if (isClosed()) {
+                    return tryPopBulk(first, max);
+                }
+
+                readable.wait([&] { return isClosed() || getSizeApprox() > 0; });
+            }
+        }
+
+        bool isClosed() const { return closed.load(std::memory_order_acquire); }
+        bool isBounded() const { return capacity != kUnbounded; }
+
+        // may be stale by the time it returns
+        size_t getSizeApprox() const { return queue.size_approx(); }
+
+    private:
+        using Queue = moodycamel::ConcurrentQueue<T, detail::ChannelTraits>;
+
+        // claim room for count items, unbounded channels always have room
+        bool reserve(size_t count) {
+            if (!isBounded()) { return true; }
+
+            size_t current = used.load(std::memory_order_relaxed);
+            do {
+                if (current + count > capacity) { return false; }
+            } while (!used.compare_exchange_weak(current, current + count, std::memory_order_acquire, std::memory_order_relaxed));
+
+            return true;
+        }
+
+        bool waitReserve(size_t count) {
+            while (!isClosed()) {
+                if (reserve(count)) { return true; }
+
+                writable.wait([&] {
+                    return isClosed() || used.load(std::memory_order_relaxed) + count <= capacity;
+                });
+            }
+
+            return false;
+        }
+
+        void release(size_t count) {
+            if (!isBounded()) { return; }
+
+            used.fetch_sub(count, std::memory_order_release);
+            writable.wake();
+        }
+
+        void enqueue(T&& item) {
+            bool ok;
+            if constexpr (kSingleProducer) {
+                ok = queue.enqueue(*producer, std::move(item));
+            } else {
+                ok = queue.enqueue(std::move(item));
+            }
+
+            ASSERTF(ok, "channel failed to allocate a block");
+        }
+
+        template<typename It>
+        void enqueueBulk(It first, size_t count) {
+            bool ok;
+            if constexpr (kSingleProducer) {
+                ok = queue.enqueue_bulk(*producer, std::make_move_iterator(first), count);
+            } else {
+                ok = queue.enqueue_bulk(std::make_move_iterator(first), count);
+            }
+
+            ASSERTF(ok, "channel failed to allocate {} items", count);
+        }
+
+        bool dequeue(T& item) {
+            if constexpr (kSingleConsumer) {
+                return queue.try_dequeue(*consumer, item);
+            } else {
+                return queue.try_dequeue(item);
+            }
+        }
+
+        template<typename It>
+        size_t dequeueBulk(It first, size_t max) {
+            if constexpr (kSingleConsumer) {
+                return queue.try_dequeue_bulk(*consumer, first, max);
+            } else {
+                return queue.try_dequeue_bulk(first, max);
+            }
+        }
+
+        size_t capacity;
+
+        alignas(64) std::atomic_size_t used = 0;
+        std::atomic_bool closed = false;
+
+        detail::Waiters readable;
+        detail::Waiters writable;
+
+        Queue queue;
+        std::optional<moodycamel::ProducerToken> producer;
+        std::optional<moodycamel::ConsumerToken> consumer;
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace simcoe::threads {
+    // single producer single consumer handoff of whole frames.
+    // the producer fills a slot and publishes it, the consumer reads it then releases it.
+    // published slots are never written again until released, so readers see an immutable snapshot.
+    // the producer can run at most N frames ahead of the consumer before it blocks
+    template<typename T, size_t N>
+    struct FrameQueue {
+        static_assert(N > 0, "frame queue needs at least one slot");
+
+        /// producer
+
+        // blocks while every slot is still waiting to be read
+        T& beginWrite() {
+            uint32_t h = head.load(std::memory_order_relaxed);
+            uint32_t t = tail.load(std::memory_order_acquire);
+
+            while (h - t >= N) {
+                tail.wait(t, std::memory_order_acquire);
+                t = tail.load(std::memory_order_acquire);
+            }
+
+            return slots[h % N];
+        }
+
+        void endWrite() {
+            head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            wake();
+        }
+
+        // the consumer drains what is left then stops
+        void close() {
+            closed.store(true, std::memory_order_release);
+            wake();
+        }
+
+        /// consumer
+
+        // blocks until a frame is published, null once closed and drained
+        const T *beginRead() {
+            uint32_t t = tail.load(std::memory_order_relaxed);
+
+            while (true) {
+                uint32_t current = signal.load(std::memory_order_acquire);
+
+                if (head.load(std::memory_order_acquire) != t) {
+                    return &slots[t % N];
+                }
+
+                if (closed.load(std::memory_order_acquire)) {
+                    return nullptr;
+                }
+
+                signal.wait(current, std::memory_order_acquire);
+            }
+        }
+
+        void endRead() {
+            tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            tail.notify_one();
+        }
+
+        // frames published but not yet released
+        size_t getPending() const {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        // the consumer sleeps on this rather than head so close can wake it too
+        void wake() {
+            signal.fetch_add(1, std::memory_order_release);
+            signal.notify_one();
+        }
+
+        alignas(64) std::atomic_uint32_t head = 0;
+        alignas(64) std::atomic_uint32_t tail = 0;
+        alignas(64) std::atomic_uint32_t signal = 0;
+        std::atomic_bool closed = false;
+
+        std::array<T, N> slots;
+    };
+}
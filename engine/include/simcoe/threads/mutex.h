@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#   include <immintrin.h>
+#endif
+
+// counts how often locks hit their slow path. off by default since it
+// touches shared counters whenever a lock is contended
+#ifndef SIMCOE_LOCK_STATS
+#   define SIMCOE_LOCK_STATS 0
+#endif
+
+namespace simcoe::threads {
+    constexpr bool kLockStats = SIMCOE_LOCK_STATS;
+
+    struct LockStats {
+        size_t contended; // acquires that missed the fast path
+        size_t spun; // contended acquires that got the lock while spinning
+        size_t parked; // times a thread went to sleep on a lock, event or latch
+    };
+
+    // zeroed when lock stats are compiled out
+    LockStats getLockStats();
+
+    namespace detail {
+        // how many rounds to spin before parking. each round pauses twice as long as the last, up to a cap
+        constexpr size_t kSpinRounds = 10;
+        constexpr size_t kMaxPause = 64;
+
+        inline void pause() {
+#if defined(_M_X64) || defined(__x86_64__)
+            _mm_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
+        void onContended();
+        void onSpun();
+        void onParked();
+    }
+
+    // spin with backoff until ready() is true or the spin budget runs out.
+    // returns ready() so the caller knows whether it still needs to block
+    template<typename F>
+    bool spinUntil(F&& ready) {
+        size_t pauses = 1;
+        for (size_t round = 0; round < detail::kSpinRounds; round++) {
+            if (ready()) { return true; }
+
+            for (size_t i = 0; i < pauses; i++) {
+                detail::pause();
+            }
+
+            pauses = std::min(pauses * 2, detail::kMaxPause);
+        }
+
+        return ready();
+    }
+
+    // one word mutex. spins briefly when contended then parks on the word,
+    // a futex on linux and WaitOnAddress on windows.
+    // usable with std::lock_guard and std::unique_lock
+    struct Mutex {
+        constexpr Mutex() = default;
+
+        Mutex(const Mutex&) = delete;
+        Mutex& operator=(const Mutex&) = delete;
+
+        void lock() {
+            uint32_t expected = eUnlocked;
+            if (!state.compare_exchange_strong(expected, eLocked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                lockSlow();
+            }
+        }
+
+        bool try_lock() {
+            uint32_t expected = eUnlocked;
+            return state.compare_exchange_strong(expected, eLocked, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() {
+            if (state.exchange(eUnlocked, std::memory_order_release) == eContended) {
+                state.notify_one();
+            }
+        }
+
+    private:
+        enum : uint32_t {
+            eUnlocked,
+            eLocked, // held, nobody asleep
+            eContended // held, someone may be asleep
+        };
+
+        void lockSlow();
+
+        std::atomic_uint32_t state = eUnlocked;
+    };
+
+    // one word manual reset event. wait blocks until set is called, it stays set until reset
+    struct Event {
+        constexpr Event(bool signalled = false)
+            : state(signalled ? eSet : eClear)
+        { }
+
+        Event(const Event&) = delete;
+        Event& operator=(const Event&) = delete;
+
+        // the waiter may destroy the event once this stores, only the wake touches the address after
+        void set() {
+            if (state.exchange(eSet, std::memory_order_release) == eWaiting) {
+                state.notify_all();
+            }
+        }
+
+        void reset() {
+            uint32_t expected = eSet;
+            state.compare_exchange_strong(expected, eClear, std::memory_order_relaxed);
+        }
+
+        bool isSet() const { return state.load(std::memory_order_acquire) == eSet; }
+
+        void wait() {
+            if (!isSet()) { waitSlow(); }
+        }
+
+    private:
+        enum : uint32_t {
+            eClear,
+            eSet,
+            eWaiting // clear with someone asleep
+        };
+
+        void waitSlow();
+
+        std::atomic_uint32_t state;
+    };
+
+    // one word countdown. wait blocks until arrivals bring the count to zero, it can't be reused
+    struct Latch {
+        constexpr Latch(uint32_t count)
+            : count(count)
+        { }
+
+        Latch(const Latch&) = delete;
+        Latch& operator=(const Latch&) = delete;
+
+        void arrive(uint32_t n = 1) {
+            if (count.fetch_sub(n, std::memory_order_acq_rel) == n) {
+                count.notify_all();
+            }
+        }
+
+        bool isDone() const { return count.load(std::memory_order_acquire) == 0; }
+
+        void wait() {
+            if (!isDone()) { waitSlow(); }
+        }
+
+        void arriveAndWait(uint32_t n = 1) {
+            arrive(n);
+            wait();
+        }
+
+    private:
+        void waitSlow();
+
+        std::atomic_uint32_t count;
+    };
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "simcoe/core/topology.h"
+
+#include "simcoe/memory/pool.h"
+
+#include "simcoe/threads/channel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace simcoe::threads {
+    struct Scheduler;
+
+    // number of outstanding jobs in a group, wait on it to join them
+    struct Counter {
+        bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend Scheduler;
+
+        std::atomic_size_t pending = 0;
+    };
+
+    namespace detail {
+        struct Job : memory::Pooled {
+            virtual ~Job() = default;
+            virtual void execute() = 0;
+
+            Counter *pCounter = nullptr;
+        };
+
+        template<typename F>
+        struct JobImpl final : Job {
+            JobImpl(F&& func) : func(std::move(func)) { }
+
+            void execute() override { func(); }
+
+        private:
+            F func;
+        };
+
+        // chase-lev deque. the owning thread pushes and pops the bottom, everyone else steals from the top.
+        // fixed capacity, the owner runs the job itself when it is full
+        struct WorkDeque {
+            static constexpr int64_t kCapacity = 1 << 12;
+
+            bool push(Job *pJob);
+            Job *pop();
+            Job *steal();
+
+            bool empty() const;
+
+        private:
+            alignas(64) std::atomic_int64_t top = 0;
+            alignas(64) std::atomic_int64_t bottom = 0;
+            std::atomic<Job*> items[kCapacity] = {};
+        };
+    }
+
+    // work stealing job system. the thread that creates the scheduler is a participant
+    // with its own deque, it runs jobs whenever it waits on a counter.
+    // jobs submitted from any other thread go through a shared queue
+    struct Scheduler {
+        // workers are named and placed using the worker role in placement
+        Scheduler(size_t workers, const os::threads::Info& placement = { });
+        ~Scheduler();
+
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+
+        template<typename F>
+        void submit(F&& func, Counter *pCounter = nullptr) {
+            auto *pJob = new detail::JobImpl<std::decay_t<F>>(std::forward<F>(func));
+            pJob->pCounter = pCounter;
+            enqueue(pJob);
+        }
+
+        // run jobs until the counter reaches zero
+        void wait(Counter& counter);
+
+        // calls func(i) for every i in [first, last) and waits for all of them.
+        // ranges are split in half until they reach grain so idle threads steal the largest pieces left.
+        // a grain of 0 picks one based on the thread count
+        template<typename F>
+        void parallelFor(size_t first, size_t last, F&& func, size_t grain = 0) {
+            if (first >= last) { return; }
+
+            if (grain == 0) {
+                grain = std::max<size_t>(1, (last - first) / (getThreadCount() * 8));
+            }
+
+            Counter counter;
+            splitRange(first, last, grain, func, counter);
+            wait(counter);
+        }
+
+        // workers plus the owning thread
+        size_t getThreadCount() const { return workers.size() + 1; }
+
+    private:
+        template<typename F>
+        void splitRange(size_t first, size_t last, size_t grain, F& func, Counter& counter) {
+            while (last - first > grain) {
+                size_t middle = first + (last - first) / 2;
+                submit([this, middle, last, grain, &func, &counter] {
+                    splitRange(middle, last, grain, func, counter);
+                }, &counter);
+
+                last = middle;
+            }
+
+            for (size_t i = first; i < last; i++) {
+                func(i);
+            }
+        }
+
+        void enqueue(detail::Job *pJob);
+        void execute(detail::Job *pJob);
+
+        detail::Job *findJob(size_t self);
+        void workerMain(size_t index, const os::threads::Info& placement);
+
+        // deque index of the calling thread, or SIZE_MAX if it does not belong to this scheduler
+        size_t getCurrentIndex() const;
+
+        // index 0 belongs to the owning thread
+        std::vector<std::unique_ptr<detail::WorkDeque>> deques;
+        std::vector<std::jthread> workers;
+
+        // jobs submitted from threads outside the scheduler
+        Channel<detail::Job*> shared;
+
+        // bumped on every submit, idle workers sleep on it
+        std::atomic_uint32_t epoch = 0;
+        std::atomic_size_t sleeping = 0;
+        std::atomic_bool running = true;
+    };
+}
@@ -6,11 +6,18 @@
 
 #include "simcoe/core/util.h"
 #include "simcoe/core/io.h"
+#include "simcoe/core/metrics.h"
 #include "simcoe/core/progress.h"
+#include "simcoe/core/trace.h"
 
-#include "simcoe/simcoe.h"
+#include "simcoe/async/when.h"
+
+#include "simcoe/threads/mutex.h"
+
+#include "simcoe/memory/flatmap.h"
+#include "simcoe/memory/tracking.h"
 
-#include <unordered_map>
+#include "simcoe/simcoe.h"
 
 using namespace simcoe;
 using namespace simcoe::assets;
@@ -50,6 +57,10 @@ struct std::equal_to<assets::Vertex> {
     }
 };
 namespace {
+    metrics::Counter gTextures { "assets.textures" };
+    metrics::Counter gTextureBytes { "assets.texture_bytes" };
+    metrics::Histogram gDecodeTime { "assets.decode_us" };
+
     constexpr fastgltf::Options kOptions = fastgltf::Options::LoadGLBBuffers | fastgltf::Options::LoadExternalBuffers;
 
     constexpr const char *gltfErrorToString(fastgltf::Error err) {
@@ -103,58 +114,83 @@ namespace {
     };
 
     struct GltfUpload final : IUpload {
-        GltfUpload(IScene& scene)
-            : scene(scene)
+        GltfUpload(threads::Scheduler& scheduler, IScene& scene)
+            : scheduler(scheduler)
+            , executor(scheduler)
+            , scene(scene)
         { }
 
+        ~GltfUpload() override {
+            finished.wait();
+        }
+
         void detach(const std::filesystem::path& path) {
-            thread = std::jthread([this, path] {
-                fastgltf::Parser parser;
-                fastgltf::GltfDataBuffer buffer;
-                std::unique_ptr<fastgltf::glTF> data;
-
-                buffer.loadFromFile(path);
-
-                switch (fastgltf::determineGltfFileType(&buffer)) {
-                case fastgltf::GltfType::glTF:
-                    gAssetLog.info("Loading glTF file: {}", path.string());
-                    data = parser.loadGLTF(&buffer, path.parent_path(), kOptions);
-                    break;
-                case fastgltf::GltfType::GLB:
-                    gAssetLog.info("Loading GLB file: {}", path.string());
-                    data = parser.loadBinaryGLTF(&buffer, path.parent_path(), kOptions);
-                    break;
-
-                default:
-                    gAssetLog.warn("Unknown glTF file type");
-                    return;
-                }
+            async::spawn(executor, run(path));
+        }
 
-                if (fastgltf::Error err = parser.getError(); err != fastgltf::Error::None) {
-                    gAssetLog.warn("Failed to load glTF file: {} ({})", gltfErrorToString(err), fastgltf::to_underlying(err));
-                    return;
-                }
+    private:
+        // memory tags and trace zones are per thread, so their scopes are only opened between suspension points
 
-                if (fastgltf::Error err = data->parse(); err != fastgltf::Error::None) {
-                    gAssetLog.warn("Failed to parse glTF file: {} ({})", gltfErrorToString(err), fastgltf::to_underlying(err));
-                    return;
-                }
+        async::Task<> run(std::filesystem::path path) {
+            co_await load(std::move(path));
 
-                asset = data->getParsedAsset();
+            finished.set();
+        }
 
-                scene.beginUpload();
-                load();
-                scene.endUpload();
-            });
+        async::Task<> load(std::filesystem::path path) {
+            if (!parse(path)) { co_return; }
+
+            scene.beginUpload();
+
+            co_await loadTextures();
+            loadScene();
+
+            scene.endUpload();
         }
 
-        void load() {
-            const auto& images = asset->images;
+        bool parse(const std::filesystem::path& path) {
+            SIMCOE_ZONE("GltfUpload::parse");
+            memory::TagScope tag(memory::eAssets);
+
+            fastgltf::Parser parser;
+            fastgltf::GltfDataBuffer buffer;
+            std::unique_ptr<fastgltf::glTF> data;
+
+            buffer.loadFromFile(path);
+
+            switch (fastgltf::determineGltfFileType(&buffer)) {
+            case fastgltf::GltfType::glTF:
+                gAssetLog.info("Loading glTF file: {}", path.string());
+                data = parser.loadGLTF(&buffer, path.parent_path(), kOptions);
+                break;
+            case fastgltf::GltfType::GLB:
+                gAssetLog.info("Loading GLB file: {}", path.string());
+                data = parser.loadBinaryGLTF(&buffer, path.parent_path(), kOptions);
+                break;
+
+            default:
+                gAssetLog.warn("Unknown glTF file type");
+                return false;
+            }
 
-            for (size_t i : util::progress(texProgress, images.size())) {
-                loadTexture(i, images[i]);
+            if (fastgltf::Error err = parser.getError(); err != fastgltf::Error::None) {
+                gAssetLog.warn("Failed to load glTF file: {} ({})", gltfErrorToString(err), fastgltf::to_underlying(err));
+                return false;
             }
 
+            if (fastgltf::Error err = data->parse(); err != fastgltf::Error::None) {
+                gAssetLog.warn("Failed to parse glTF file: {} ({})", gltfErrorToString(err), fastgltf::to_underlying(err));
+                return false;
+            }
+
+            asset = data->getParsedAsset();
+            return true;
+        }
+
+        void loadScene() {
+            SIMCOE_ZONE("GltfUpload::loadScene");
+            memory::TagScope tag(memory::eAssets);
+
             const auto& meshes = asset->meshes;
 
             for (size_t i : util::progress(meshProgress, meshes.size())) {
@@ -169,7 +205,7 @@ namespace {
 
             for (size_t i = 0; i < nodes.size(); i++) {
                 const auto& node = nodes[i];
-                std::vector<size_t> children;
+                IndexList children;
                 for (const auto& child : node.children) {
                     children.push_back(nodeMap[child]);
                 }
@@ -178,28 +214,76 @@ namespace {
             }
         }
 
-    private:
-        void loadTextures() {
+        struct ImageData {
+            stbi_uc *pImage = nullptr;
+            int width = 0;
+            int height = 0;
+        };
+
+        // decoding is the slow part so images are decoded on every thread a batch at a time.
+        // uploads go through the scene which is single threaded, so those stay in order here
+        async::Task<> loadTextures() {
             const auto& images = asset->images;
+            texProgress = util::Progress<size_t>(images.size());
+
+            size_t batchSize = scheduler.getThreadCount();
+
+            for (size_t first = 0; first < images.size(); first += batchSize) {
+                size_t count = std::min(batchSize, images.size() - first);
+
+                std::vector<async::Task<ImageData>> decodes;
+                decodes.reserve(count);
+
+                for (size_t i = 0; i < count; i++) {
+                    decodes.push_back(decodeImage(images[first + i]));
+                }
+
+                auto batch = co_await async::when_all(std::move(decodes));
+
+                for (size_t i = 0; i < count; i++) {
+                    addTexture(first + i, images[first + i], batch[i]);
+                }
 
-            for (size_t i : util::progress(texProgress, images.size())) {
-                loadTexture(i, images[i]);
+                texProgress.update(first + count);
             }
         }
 
-        void loadTexture(size_t i, const fastgltf::Image& image) {
+        async::Task<ImageData> decodeImage(const fastgltf::Image& image) {
+            co_await async::schedule(executor);
+
+            SIMCOE_ZONE("GltfUpload::decodeImage");
+            memory::TagScope tag(memory::eAssets);
+
             BufferData buffer = getBufferData(image.data, image.name);
-            if (buffer.empty()) { return; }
+            if (buffer.empty()) { co_return ImageData { }; }
+
+            auto start = std::chrono::steady_clock::now();
+
+            ImageData result;
+            int channels;
+            result.pImage = stbi_load_from_memory(buffer.data(), static_cast<int>(buffer.size_bytes()), &result.width, &result.height, &channels, 4);
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            gDecodeTime.record(uint64_t(elapsed.count()));
 
-            int width, height, channels;
-            stbi_uc *pImage = stbi_load_from_memory(buffer.data(), static_cast<int>(buffer.size_bytes()), &width, &height, &channels, 4);
-            if (pImage == nullptr) {
+            co_return result;
+        }
+
+        void addTexture(size_t i, const fastgltf::Image& image, const ImageData& data) {
+            SIMCOE_ZONE("GltfUpload::addTexture");
+            memory::TagScope tag(memory::eAssets);
+
+            if (data.pImage == nullptr) {
                 gAssetLog.warn("Failed to load image ({})", image.name);
                 textureMap[i] = scene.getDefaultTexture();
                 return;
             }
 
-            textureMap[i] = scene.addTexture({ pImage, size2::from(width, height) });
+            textureMap[i] = scene.addTexture({ data.pImage, size2::from(data.width, data.height) });
+            stbi_image_free(data.pImage);
+
+            gTextures.add();
+            gTextureBytes.add(uint64_t(data.width) * uint64_t(data.height) * 4);
         }
 
         void loadNode(size_t index, const fastgltf::Node& node) {
@@ -224,7 +308,7 @@ namespace {
 
             auto primitives = node.meshIndex.has_value()
                 ? primitiveMap[node.meshIndex.value()]
-                : std::vector<size_t>();
+                : IndexList();
 
             nodeMap[index] = scene.addNode({
                 .transform = transform,
@@ -307,7 +391,7 @@ namespace {
                 return PrimitiveData();
             }
 
-            std::unordered_map<Vertex, uint32_t> indexCache;
+            memory::FlatMap<Vertex, uint32_t> indexCache;
 
             std::vector<Vertex> vertices;
             std::vector<uint32_t> indices = getIndexBuffer(primitive);
@@ -324,12 +408,12 @@ namespace {
                 if (bHasIndices) {
                     vertices.push_back(vertex);
                 } else {
-                    if (indexCache.find(vertex) == indexCache.end()) {
-                        indexCache[vertex] = static_cast<uint32_t>(vertices.size());
+                    auto [it, bInserted] = indexCache.try_emplace(vertex, static_cast<uint32_t>(vertices.size()));
+                    if (bInserted) {
                         vertices.push_back(vertex);
                     }
 
-                    indices.push_back(indexCache[vertex]);
+                    indices.push_back(it->second);
                 }
             }
 
@@ -357,12 +441,15 @@ namespace {
             }
         }
 
-        std::jthread thread;
+        threads::Scheduler& scheduler;
+        async::SchedulerExecutor executor;
+
+        threads::Event finished;
 
-        std::unordered_map<size_t, size_t> textureMap;
-        std::unordered_map<size_t, size_t> nodeMap;
-        std::unordered_map<size_t, std::vector<size_t>> primitiveMap;
-        std::unordered_map<size_t, size_t> materialMap;
+        memory::FlatMap<size_t, size_t> textureMap;
+        memory::FlatMap<size_t, size_t> nodeMap;
+        memory::FlatMap<size_t, IndexList> primitiveMap;
+        memory::FlatMap<size_t, size_t> materialMap;
 
         std::unique_ptr<fastgltf::Asset> asset;
         IScene& scene;
@@ -383,7 +470,7 @@ namespace {
 }
 
 std::shared_ptr<IUpload> Manager::gltf(const std::filesystem::path& path, IScene& scene) {
-    auto result = std::make_shared<GltfUpload>(scene);
+    auto result = std::make_shared<GltfUpload>(scheduler, scene);
     result->detach(path);
     return result;
 }
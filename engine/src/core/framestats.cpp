@@ -0,0 +1,145 @@
+#include "simcoe/core/framestats.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <string>
+
+using namespace simcoe;
+
+namespace {
+    // log2 of the buckets per power of two
+    constexpr size_t kSubBits = 2;
+    constexpr uint64_t kLinear = 1 << kSubBits;
+
+    // nearest rank, the smallest sample at least percent of the window is at or below
+    size_t getRank(size_t count, size_t percent) {
+        return std::max<size_t>((count * percent + 99) / 100, 1) - 1;
+    }
+
+    double toMicros(Duration time) {
+        return std::chrono::duration<double, std::micro>(time).count();
+    }
+}
+
+FrameStats::FrameStats(const Info& info)
+    : window(info.window)
+{
+    ASSERT(window > 0);
+
+    for (auto& series : samples) {
+        series.resize(window);
+    }
+
+    scratch.resize(window);
+}
+
+void FrameStats::add(const FrameTimes& times) {
+    const Duration values[eSeriesCount] = { times.cpu, times.presentWait, times.gpu };
+
+    size_t slot = total % window;
+    bool full = total >= window;
+
+    for (size_t i = 0; i < eSeriesCount; i++) {
+        if (full) {
+            histograms[i][getBucket(samples[i][slot])] -= 1;
+        }
+
+        samples[i][slot] = values[i];
+        histograms[i][getBucket(values[i])] += 1;
+    }
+
+    total += 1;
+}
+
+FrameStats::Summary FrameStats::getSummary(Series series) const {
+    size_t count = getCount();
+    if (count == 0) { return Summary { }; }
+
+    auto begin = scratch.begin();
+    auto end = begin + ptrdiff_t(count);
+    std::copy_n(samples[series].begin(), count, begin);
+
+    // each percentile only needs to look past the last one, which must stay put.
+    // small windows can give two percentiles the same rank
+    auto select = [&](auto from, size_t percent) {
+        auto it = begin + ptrdiff_t(getRank(count, percent));
+        std::nth_element(std::min(from, it), it, end);
+        return it;
+    };
+
+    auto p50 = select(begin, 50);
+    auto p95 = select(p50 + 1, 95);
+    auto p99 = select(p95 + 1, 99);
+
+    return Summary {
+        .p50 = *p50,
+        .p95 = *p95,
+        .p99 = *p99,
+        .max = *std::max_element(p99, end)
+    };
+}
+
+size_t FrameStats::getCount() const {
+    return std::min(total, window);
+}
+
+size_t FrameStats::getBucket(Duration time) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    uint64_t value = uint64_t(std::max<decltype(micros)>(micros, 0));
+
+    if (value < kLinear) { return size_t(value); }
+
+    // the leading bit picks the power of two, the next kSubBits bits pick the bucket within it
+    size_t octave = size_t(std::bit_width(value)) - 1;
+    size_t sub = size_t(value >> (octave - kSubBits)) & (kLinear - 1);
+    size_t bucket = (octave - kSubBits + 1) * kLinear + sub;
+
+    return std::min(bucket, kBucketCount - 1);
+}
+
+Duration FrameStats::getBucketStart(size_t bucket) {
+    if (bucket < kLinear) { return std::chrono::microseconds(bucket); }
+
+    size_t octave = bucket / kLinear + kSubBits - 1;
+    uint64_t sub = bucket % kLinear;
+
+    return std::chrono::microseconds((kLinear + sub) << (octave - kSubBits));
+}
+
+const char *FrameStats::getSeriesName(Series series) {
+    switch (series) {
+    case eCpu: return "cpu";
+    case ePresentWait: return "present wait";
+    case eGpu: return "gpu";
+    default: return "unknown";
+    }
+}
+
+bool FrameStats::writeCsv(const char *pzPath) const {
+    FILE *pFile = std::fopen(pzPath, "w");
+    if (pFile == nullptr) { return false; }
+
+    std::string out = "frame,cpu_us,present_wait_us,gpu_us\n";
+    auto it = std::back_inserter(out);
+
+    size_t count = getCount();
+    for (size_t frame = total - count; frame < total; frame++) {
+        size_t slot = frame % window;
+
+        std::format_to(it, "{},{:.1f},{:.1f},{:.1f}\n", frame,
+            toMicros(samples[eCpu][slot]),
+            toMicros(samples[ePresentWait][slot]),
+            toMicros(samples[eGpu][slot])
+        );
+    }
+
+    bool written = std::fwrite(out.data(), 1, out.size(), pFile) == out.size();
+    std::fclose(pFile);
+
+    return written;
+}
@@ -1,8 +1,18 @@
 #include "simcoe/core/logging.h"
-#include "simcoe/core/win32.h"
+#include "simcoe/core/logwriter.h"
 #include "simcoe/core/panic.h"
+#include "simcoe/core/units.h"
+
+#include "simcoe/memory/tracking.h"
+
+#include <algorithm>
+#include <cstdio>
 #include <ranges>
 
+#if _WIN32
+#   include "simcoe/core/win32.h"
+#endif
+
 using namespace simcoe;
 using namespace simcoe::logging;
 
@@ -14,6 +24,43 @@ namespace {
 
     constexpr const char *kpzAnsiReset = "\x1b[0m";
 
+#if _WIN32
+    constexpr const char *kpzNullFile = "\\\\.\\NUL";
+#else
+    constexpr const char *kpzNullFile = "/dev/null";
+#endif
+
+    // where each thread formats its messages, so the common case never touches the heap
+    constexpr size_t kFormatSize = units::Memory::kKilobyte * 4;
+
+    thread_local char tlsFormatBuffer[kFormatSize];
+    thread_local bool tlsFormatBusy = false; // a sink may log while the buffer is being sent
+
+    constinit std::atomic<BinarySink*> gBinarySink = nullptr;
+
+    constexpr std::string_view kSuppressedFormat = "suppressed {} repeats of \"{}\"";
+
+    uint64_t getClockTime() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    // binary log thread ids, handed out the first time a thread writes
+    constinit std::atomic_uint32_t gThreadCount = 0;
+    constexpr uint32_t kNoThread = UINT32_MAX;
+    thread_local uint32_t tlsThreadIndex = kNoThread;
+
+    thread_local binary::Buffer tlsBinaryScratch;
+    thread_local std::string tlsBinaryText;
+
+    uint32_t getThreadIndex() {
+        if (tlsThreadIndex == kNoThread) {
+            tlsThreadIndex = gThreadCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return tlsThreadIndex;
+    }
+
     constexpr LevelFormat getLevelFormat(Level level) {
         switch (level) {
         case eInfo: return { "info", "\x1b[32m" };
@@ -24,18 +71,151 @@ namespace {
     }
 }
 
+void Category::format(Level level, std::string_view fmt, std::format_args args) {
+    // sinks are free to allocate, logging in a zero allocation scope is not a leak
+    memory::TagScope tag(memory::eLogging);
+    memory::AllowAllocScope allow;
+
+    std::string message = std::vformat(fmt, args);
+    send(level, message.c_str());
+}
+
+std::span<char> Category::getFormatBuffer() {
+    if (tlsFormatBusy) { return { }; }
+
+    return tlsFormatBuffer;
+}
+
+void Category::sendFormatBuffer(Level level, size_t length) {
+    memory::TagScope tag(memory::eLogging);
+    memory::AllowAllocScope allow;
+
+    tlsFormatBuffer[length] = '\0';
+
+    tlsFormatBusy = true;
+    send(level, tlsFormatBuffer);
+    tlsFormatBusy = false;
+}
+
 void Category::send(Level level, const char *pzMessage) {
-    for (ISink *pSink : sinks) {
+    if (Writer *pWriter = getWriter(); pWriter != nullptr && pWriter->post(*this, level, pzMessage)) {
+        return;
+    }
+
+    dispatch(level, pzMessage);
+}
+
+void Category::dispatch(Level level, const char *pzMessage) {
+    std::lock_guard guard(pSinks->lock);
+
+    for (ISink *pSink : pSinks->sinks) {
         pSink->send(*this, level, pzMessage);
     }
 }
 
 void Category::addSink(ISink *pSink) {
-    sinks.insert(pSink);
+    std::lock_guard guard(pSinks->lock);
+
+    pSinks->sinks.insert(pSink);
+    pSinks->count.store(pSinks->sinks.size(), std::memory_order_relaxed);
 }
 
 void Category::removeSink(ISink *pSink) {
-    sinks.erase(pSink);
+    std::lock_guard guard(pSinks->lock);
+
+    pSinks->sinks.erase(pSink);
+    pSinks->count.store(pSinks->sinks.size(), std::memory_order_relaxed);
+}
+
+Category::SinkSet Category::getSinks() const {
+    std::lock_guard guard(pSinks->lock);
+    return pSinks->sinks;
+}
+
+void Category::sendSuppressed(Level level, std::string_view fmt, size_t count) {
+    if (BinarySink *pBinary = getBinarySink()) {
+        pBinary->write(*this, level, kSuppressedFormat, count, fmt);
+    }
+
+    if (hasSinks()) {
+        format(level, kSuppressedFormat, std::make_format_args(count, fmt));
+    }
+}
+
+///
+/// rate limiting
+///
+
+void RateLimiter::configure(RateLimit limit) {
+    if (limit.perSecond <= 0.f) {
+        interval.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t step = std::max<uint64_t>(1, uint64_t(1e9 / double(limit.perSecond)));
+    uint64_t burst = std::max<uint32_t>(limit.burst, 1);
+
+    tolerance.store((burst - 1) * step, std::memory_order_relaxed);
+    minLevel.store(limit.minLevel, std::memory_order_relaxed);
+    interval.store(step, std::memory_order_relaxed);
+}
+
+RateLimit RateLimiter::getLimit() const {
+    uint64_t step = interval.load(std::memory_order_relaxed);
+    if (step == 0) { return { }; }
+
+    return {
+        .perSecond = float(1e9 / double(step)),
+        .burst = uint32_t(tolerance.load(std::memory_order_relaxed) / step + 1),
+        .minLevel = minLevel.load(std::memory_order_relaxed)
+    };
+}
+
+bool RateLimiter::allow(const void *pKey, size_t& suppressed) {
+    uint64_t step = interval.load(std::memory_order_relaxed);
+    if (step == 0) { return true; }
+
+    Site *pSite = getSite(pKey);
+    if (pSite == nullptr) { return true; }
+
+    uint64_t burst = tolerance.load(std::memory_order_relaxed);
+    uint64_t now = getClockTime();
+
+    // the site may log if its bucket would not overflow, each message pushes the arrival time one step on
+    uint64_t arrival = pSite->arrival.load(std::memory_order_relaxed);
+    do {
+        if (arrival > now + burst) {
+            pSite->suppressed.fetch_add(1, std::memory_order_relaxed);
+            totalSuppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!pSite->arrival.compare_exchange_weak(arrival, std::max(arrival, now) + step, std::memory_order_relaxed));
+
+    if (pSite->suppressed.load(std::memory_order_relaxed) > 0) {
+        suppressed = pSite->suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
+RateLimiter::Site *RateLimiter::getSite(const void *pKey) {
+    // fibonacci hashing, literals are packed together so the low bits alone cluster
+    uint64_t hash = (uint64_t(reinterpret_cast<uintptr_t>(pKey)) * 0x9E3779B97F4A7C15ull) >> 32;
+
+    for (size_t i = 0; i < kMaxSites; i++) {
+        Site& site = sites[(hash + i) % kMaxSites];
+
+        const void *pCurrent = site.pKey.load(std::memory_order_acquire);
+        if (pCurrent == pKey) { return &site; }
+
+        if (pCurrent == nullptr) {
+            if (site.pKey.compare_exchange_strong(pCurrent, pKey, std::memory_order_acq_rel) || pCurrent == pKey) {
+                return &site;
+            }
+        }
+    }
+
+    return nullptr;
 }
 
 void IFilterSink::send(Category &category, Level level, const char *pzMessage) {
@@ -53,27 +233,249 @@ ConsoleSink::ConsoleSink(const char *pzName)
 void ConsoleSink::accept(Category &category, Level level, const char *pzMessage) {
     const auto& [name, colour] = getLevelFormat(level);
 
-    printf("[%s%s:%s%s] %s%s\n", colour, category.getName(), name, kpzAnsiReset, pzMessage, kpzAnsiReset);
+    printf("[%s%s:%s%s] %s%s\n", colour, category.getName().c_str(), name, kpzAnsiReset, pzMessage, kpzAnsiReset);
 }
 
 FileSink::FileSink(const char *pzName, const char *pzPath): IFilterSink(pzName) { 
-    errno_t err = fopen_s(&pFile, pzPath, "w");
+    pFile = std::fopen(pzPath, "w");
     
-    if (err != 0) {
-        err = fopen_s(&pFile, "\\\\.\\NUL", "a");
+    if (pFile == nullptr) {
+        pFile = std::fopen(kpzNullFile, "a");
     }
 
-    ASSERT(err == 0);
+    ASSERT(pFile != nullptr);
 }
 
 void FileSink::accept(Category &category, Level level, const char *pzMessage) {
     const auto& [name, _] = getLevelFormat(level);
 
-    fprintf(pFile, "[%s:%s] %s\n", category.getName(), name, pzMessage);
+    fprintf(pFile, "[%s:%s] %s\n", category.getName().c_str(), name, pzMessage);
 }
 
 void DebugSink::accept(Category &category, Level level, const char *pzMessage) {
     const auto& [name, _] = getLevelFormat(level);
 
+#if _WIN32
     OutputDebugStringA(std::format("[{}:{}] {}\n", category.getName(), name, pzMessage).c_str());
+#else
+    // no debugger output channel off windows
+    (void)category;
+    (void)name;
+    (void)pzMessage;
+#endif
+}
+
+///
+/// binary sink
+///
+
+BinarySink *logging::getBinarySink() {
+    return gBinarySink.load(std::memory_order_acquire);
+}
+
+// a full buffer on its way to the file. queued from the hand off until the writer has run it,
+// a flush that gets there first writes the buffer itself and the writer finds it empty
+struct BinarySink::PendingWrite final : IWriterTask {
+    PendingWrite(BinarySink& sink) : sink(sink) { }
+
+    void run() override { sink.writePending(); }
+
+    BinarySink& sink;
+    binary::Buffer buffer;
+    std::atomic_bool queued = false;
+};
+
+BinarySink::BinarySink(const char *pzPath)
+    : start(std::chrono::steady_clock::now())
+    , pPending(std::make_unique<PendingWrite>(*this))
+{
+    pFile = std::fopen(pzPath, "wb");
+    ASSERTF(pFile != nullptr, "failed to open binary log {}", pzPath);
+
+    buffer.reserve(kFlushSize * 2);
+    pPending->buffer.reserve(kFlushSize * 2);
+
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+
+    binary::FileHeader header = {
+        .magic = { binary::kMagic[0], binary::kMagic[1], binary::kMagic[2], binary::kMagic[3] },
+        .version = binary::kVersion,
+        .headerSize = sizeof(binary::FileHeader),
+        .reserved = 0,
+        .startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()
+    };
+
+    binary::write(buffer, header);
+
+    BinarySink *pExpected = nullptr;
+    bool registered = gBinarySink.compare_exchange_strong(pExpected, this, std::memory_order_acq_rel);
+    ASSERTF(registered, "only one binary log may be open at a time");
+}
+
+BinarySink::~BinarySink() {
+    // sinks on the writer thread may still log, let them finish while this is published
+    if (Writer *pWriter = getWriter()) {
+        pWriter->flush();
+    }
+
+    gBinarySink.store(nullptr, std::memory_order_release);
+
+    // waits out a message another thread is still in the middle of sending
+    {
+        std::lock_guard guard(lock);
+        flushLocked();
+    }
+
+    // that message may have handed off a buffer, the writer has to be done with it before we go
+    if (Writer *pWriter = getWriter()) {
+        pWriter->flush();
+    }
+
+    fclose(pFile);
+}
+
+void BinarySink::flush() {
+    std::lock_guard guard(lock);
+    flushLocked();
+    fflush(pFile);
+}
+
+bool BinarySink::tryFlush() {
+    if (!lock.try_lock()) { return false; }
+
+    bool flushed = fileLock.try_lock();
+    if (flushed) {
+        writeLocked();
+        fflush(pFile);
+        fileLock.unlock();
+    }
+
+    lock.unlock();
+    return flushed;
+}
+
+binary::Buffer& BinarySink::getScratch() {
+    return tlsBinaryScratch;
+}
+
+void BinarySink::send(Category& category, Level level, std::string_view fmt, const binary::Buffer& args, size_t count) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    binary::Message message = {
+        .kind = binary::eMessage,
+        .level = uint8_t(level),
+        .argCount = uint8_t(count),
+        .reserved = 0,
+        .category = 0,
+        .thread = uint16_t(getThreadIndex()),
+        .format = 0,
+        .size = uint32_t(args.size()),
+        .time = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+    };
+
+    std::lock_guard guard(lock);
+
+    // definitions go into the buffer ahead of the first message that uses them
+    message.format = getFormatId(fmt);
+    message.category = uint16_t(getCategoryId(category));
+
+    binary::write(buffer, message);
+    buffer.insert(buffer.end(), args.begin(), args.end());
+
+    if (buffer.size() >= kFlushSize && !handOff()) {
+        flushLocked();
+    }
+}
+
+void BinarySink::writeFormatted(Category& category, Level level, std::string_view fmt, std::format_args args) {
+    std::string& text = tlsBinaryText;
+    text.clear();
+    std::vformat_to(std::back_inserter(text), fmt, args);
+
+    binary::Buffer& scratch = getScratch();
+    scratch.clear();
+    binary::writeString(scratch, text);
+
+    send(category, level, binary::kTextFormat, scratch, 1);
+}
+
+uint32_t BinarySink::getFormatId(std::string_view fmt) {
+    auto [it, inserted] = formats.try_emplace(fmt.data(), uint32_t(formats.size()));
+    if (inserted) {
+        define(binary::eFormat, it->second, fmt);
+    }
+
+    return it->second;
+}
+
+uint32_t BinarySink::getCategoryId(Category& category) {
+    auto [it, inserted] = categories.try_emplace(&category, uint32_t(categories.size()));
+    if (inserted) {
+        define(binary::eCategory, it->second, category.getName().view());
+    }
+
+    return it->second;
+}
+
+void BinarySink::define(binary::Kind kind, uint32_t id, std::string_view text) {
+    binary::Define header = {
+        .kind = kind,
+        .reserved = { },
+        .id = id,
+        .length = uint32_t(text.size())
+    };
+
+    binary::write(buffer, header);
+    binary::writeText(buffer, text);
+}
+
+bool BinarySink::handOff() {
+    // the last buffer is still on its way out, keep filling this one rather than wait for it
+    if (pPending->queued.load(std::memory_order_acquire)) { return true; }
+
+    Writer *pWriter = getWriter();
+    if (pWriter == nullptr) { return false; }
+
+    std::swap(buffer, pPending->buffer);
+    pPending->queued.store(true, std::memory_order_relaxed);
+
+    if (pWriter->post(pPending.get())) { return true; }
+
+    // on the writer thread or the writer is shutting down, the caller writes it instead
+    pPending->queued.store(false, std::memory_order_relaxed);
+    std::swap(buffer, pPending->buffer);
+    return false;
+}
+
+void BinarySink::writePending() {
+    {
+        std::lock_guard guard(fileLock);
+
+        binary::Buffer& pending = pPending->buffer;
+        if (!pending.empty()) {
+            fwrite(pending.data(), 1, pending.size(), pFile);
+            pending.clear();
+        }
+    }
+
+    pPending->queued.store(false, std::memory_order_release);
+}
+
+void BinarySink::writeLocked() {
+    // a handed off buffer the writer hasn't reached yet holds older messages
+    binary::Buffer& pending = pPending->buffer;
+    if (!pending.empty()) {
+        fwrite(pending.data(), 1, pending.size(), pFile);
+        pending.clear();
+    }
+
+    if (!buffer.empty()) {
+        fwrite(buffer.data(), 1, buffer.size(), pFile);
+        buffer.clear();
+    }
+}
+
+void BinarySink::flushLocked() {
+    std::lock_guard guard(fileLock);
+    writeLocked();
 }
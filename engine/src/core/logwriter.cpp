@@ -0,0 +1,197 @@
+#include "simcoe/core/logwriter.h"
+
+#include "simcoe/core/metrics.h"
+#include "simcoe/core/panic.h"
+
+#include "simcoe/memory/tracking.h"
+
+#include "simcoe/threads/mutex.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::logging;
+
+namespace {
+    constinit std::atomic<Writer*> gWriter = nullptr;
+
+    metrics::Counter gDropped { "logging.dropped" };
+
+    constexpr std::string_view kEllipsis = "...";
+
+    // how long a timed flush sleeps between checks
+    constexpr auto kFlushPoll = std::chrono::milliseconds(1);
+}
+
+// shared by a flushing thread and the writer, whoever lets go last frees it.
+// the flushing thread may give up waiting and leave before the writer gets to the marker
+struct detail::FlushState final : IWriterTask {
+    threads::Event done;
+    std::atomic_uint32_t refs = 2;
+
+    void run() override {
+        done.set();
+        release();
+    }
+
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+};
+
+Writer *logging::getWriter() {
+    return gWriter.load(std::memory_order_acquire);
+}
+
+Writer::Writer(const Info& info)
+    : overflow(info.overflow)
+    , channel(info.capacity)
+{
+    Writer *pExpected = nullptr;
+    bool registered = gWriter.compare_exchange_strong(pExpected, this, std::memory_order_acq_rel);
+    ASSERTF(registered, "only one log writer may exist at a time");
+
+    thread = std::jthread([this, threads = info.threads] { run(threads); });
+}
+
+Writer::~Writer() {
+    // anything logged from here on goes straight to the sinks
+    gWriter.store(nullptr, std::memory_order_release);
+
+    channel.close();
+    thread.join();
+}
+
+bool Writer::post(Category& category, Level level, std::string_view message) {
+    if (channel.isClosed() || isWriterThread()) { return false; }
+
+    Record record;
+    record.pCategory = &category;
+    record.level = level;
+    record.pTask = nullptr;
+
+    if (message.size() < Record::kMessageSize) {
+        record.length = uint32_t(message.size());
+    } else {
+        size_t keep = Record::kMessageSize - kEllipsis.size() - 1;
+        std::memcpy(record.message + keep, kEllipsis.data(), kEllipsis.size());
+        record.length = uint32_t(keep + kEllipsis.size());
+        message = message.substr(0, keep);
+    }
+
+    std::memcpy(record.message, message.data(), message.size());
+    record.message[record.length] = '\0';
+
+    bool pushed = (overflow == Overflow::eBlock)
+        ? channel.push(record)
+        : channel.tryPush(record);
+
+    if (pushed) { return true; }
+
+    // a failed blocking push means the writer shut down under us
+    if (channel.isClosed()) { return false; }
+
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    gDropped.add();
+    pLastDropped.store(&category, std::memory_order_relaxed);
+    return true;
+}
+
+bool Writer::post(IWriterTask *pTask) {
+    if (channel.isClosed() || isWriterThread()) { return false; }
+
+    Record record;
+    record.pCategory = nullptr;
+    record.pTask = pTask;
+
+    // a failed push means the writer shut down under us
+    return channel.push(record);
+}
+
+bool Writer::flush(std::chrono::milliseconds timeout) {
+    // the writer never posts to itself so there is nothing of its own to wait for.
+    // draining here would re-enter dispatch from inside a sink, which panic does when a sink fails
+    if (isWriterThread()) { return true; }
+
+    // the marker queues behind everything this thread posted, once the writer reaches it they have all been sent.
+    // markers are never dropped so they block regardless of the overflow policy
+    auto *pState = new detail::FlushState();
+
+    Record marker;
+    marker.pCategory = nullptr;
+    marker.pTask = pState;
+
+    if (!channel.push(marker)) {
+        // closed, the writer drains everything before exiting
+        delete pState;
+        return true;
+    }
+
+    bool done = true;
+    if (timeout == std::chrono::milliseconds::max()) {
+        pState->done.wait();
+    } else {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!pState->done.isSet()) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                done = false;
+                break;
+            }
+
+            std::this_thread::sleep_for(kFlushPoll);
+        }
+    }
+
+    pState->release();
+    return done;
+}
+
+void Writer::run(const os::threads::Info& threads) {
+    os::threads::setup(os::threads::eLogging, threads);
+
+    memory::TagScope tag(memory::eLogging);
+
+    std::vector<Record> batch(kBatchSize);
+
+    while (true) {
+        size_t count = channel.tryPopBulk(batch.begin(), kBatchSize);
+        if (count == 0) {
+            // caught up, a good time to own up to anything lost
+            reportDropped();
+
+            count = channel.popBulk(batch.begin(), kBatchSize);
+            if (count == 0) { break; }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            deliver(batch[i]);
+        }
+    }
+
+    reportDropped();
+}
+
+void Writer::deliver(const Record& record) {
+    if (record.pCategory == nullptr) {
+        record.pTask->run();
+        return;
+    }
+
+    record.pCategory->dispatch(record.level, record.message);
+}
+
+void Writer::reportDropped() {
+    if (overflow != Overflow::eReport) { return; }
+
+    size_t total = dropped.load(std::memory_order_relaxed);
+    if (total == reported) { return; }
+
+    size_t missing = total - reported;
+    reported = total;
+
+    auto message = std::format("log writer fell behind, dropped {} messages", missing);
+    pLastDropped.load(std::memory_order_relaxed)->dispatch(eWarn, message.c_str());
+}
@@ -0,0 +1,49 @@
+#include "simcoe/core/loop.h"
+
+#include "simcoe/core/panic.h"
+
+using namespace simcoe;
+
+Duration SteadyClock::now() {
+    return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+GameLoop::GameLoop(const Info& info, IClock& clock)
+    : clock(clock)
+    , delta(std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / info.tickRate)))
+    , maxSteps(info.maxSteps)
+    , last(clock.now())
+{
+    ASSERT(info.tickRate > 0.0);
+    ASSERT(info.maxSteps > 0);
+}
+
+float GameLoop::getTickDelta() const {
+    return std::chrono::duration<float>(delta).count();
+}
+
+float GameLoop::getAlpha() const {
+    return float(accumulator.count()) / float(delta.count());
+}
+
+size_t GameLoop::advance() {
+    Duration now = clock.now();
+    accumulator += now - last;
+    last = now;
+
+    // integer time so the same total elapsed always gives the same tick count
+    size_t steps = size_t(accumulator / delta);
+
+    if (steps > maxSteps) {
+        // keep the partial tick so the interpolation stays smooth
+        Duration partial = accumulator % delta;
+        dropped += accumulator - partial - delta * Duration::rep(maxSteps);
+        accumulator = partial + delta * Duration::rep(maxSteps);
+        steps = maxSteps;
+    }
+
+    accumulator -= delta * Duration::rep(steps);
+    tick += steps;
+
+    return steps;
+}
@@ -0,0 +1,259 @@
+#include "simcoe/core/metrics.h"
+
+#include "simcoe/core/panic.h"
+
+#include "simcoe/simcoe.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <mutex>
+#include <string>
+
+using namespace simcoe;
+using namespace simcoe::metrics;
+
+namespace {
+    constinit std::atomic<Metric*> gMetrics = nullptr;
+    constinit std::atomic_size_t gNextShard = 0;
+
+    // the percentiles written for each histogram
+    constexpr size_t kPercentiles[] = { 50, 90, 99 };
+}
+
+size_t detail::newShard() {
+    return gNextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+}
+
+Metric::Metric(const char *pzName, Kind kind)
+    : pzName(pzName)
+    , kind(kind)
+    , pNext(nullptr)
+{ }
+
+void Metric::publish() {
+    // metrics are usually globals so this can run before main on any thread
+    pNext = gMetrics.load(std::memory_order_relaxed);
+    while (!gMetrics.compare_exchange_weak(pNext, this, std::memory_order_release, std::memory_order_relaxed)) { }
+}
+
+Metric *metrics::getMetrics() {
+    return gMetrics.load(std::memory_order_acquire);
+}
+
+uint64_t Counter::get() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+int64_t Gauge::get() const {
+    int64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+Histogram::Snapshot Histogram::get() const {
+    Snapshot result = { };
+
+    for (const Shard& shard : shards) {
+        result.sum += shard.sum.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < kBucketCount; i++) {
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (uint64_t count : result.buckets) {
+        result.count += count;
+    }
+
+    return result;
+}
+
+uint64_t Histogram::Snapshot::getPercentile(size_t percent) const {
+    if (count == 0) { return 0; }
+
+    uint64_t rank = std::max<uint64_t>((count * percent + 99) / 100, 1);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return getBucketLimit(i);
+        }
+    }
+
+    return getBucketLimit(kBucketCount - 1);
+}
+
+///
+/// sampler
+///
+
+Sampler::Sampler(const Info& info)
+    : info(info)
+    , start(std::chrono::steady_clock::now())
+{
+    ASSERT(info.interval.count() > 0);
+
+    pFile = std::fopen(info.pzPath, "w");
+    if (pFile == nullptr) {
+        gLog.warn("could not open {} for metrics", info.pzPath);
+        return;
+    }
+
+    refresh();
+    writeHeader();
+
+    thread = std::jthread([this, threads = info.threads](std::stop_token stop) { run(stop, threads); });
+}
+
+Sampler::~Sampler() {
+    if (pFile == nullptr) { return; }
+
+    thread.request_stop();
+    thread.join();
+
+    std::fclose(pFile);
+}
+
+void Sampler::run(std::stop_token stop, const os::threads::Info& threads) {
+    os::threads::setup(os::threads::eMetrics, threads);
+
+    std::unique_lock guard(lock);
+
+    while (true) {
+        // wakes early when asked to stop
+        wake.wait_for(guard, stop, info.interval, [] { return false; });
+        if (stop.stop_requested()) { break; }
+
+        writeSample();
+    }
+
+    // the last sample is always taken, even if stopped before the first interval ran out
+    writeSample();
+}
+
+bool Sampler::refresh() {
+    Metric *pNewest = getMetrics();
+    if (pNewest == pHead) { return false; }
+
+    for (Metric *pMetric = pNewest; pMetric != pHead; pMetric = pMetric->getNext()) {
+        entries.push_back({ pMetric, { } });
+    }
+
+    pHead = pNewest;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return std::strcmp(lhs.pMetric->getName(), rhs.pMetric->getName()) < 0;
+    });
+
+    return true;
+}
+
+void Sampler::writeHeader() {
+    if (info.format != Format::eCsv) { return; }
+
+    std::string out = "time";
+    auto it = std::back_inserter(out);
+
+    for (const Entry& entry : entries) {
+        Metric *pMetric = entry.pMetric;
+        if (pMetric->getKind() != eHistogram) {
+            std::format_to(it, ",{}", pMetric->getName());
+            continue;
+        }
+
+        std::format_to(it, ",{0}.count,{0}.sum", pMetric->getName());
+        for (size_t percent : kPercentiles) {
+            std::format_to(it, ",{}.p{}", pMetric->getName(), percent);
+        }
+    }
+
+    out += '\n';
+    std::fwrite(out.data(), 1, out.size(), pFile);
+}
+
+void Sampler::writeSample() {
+    if (refresh()) {
+        writeHeader();
+    }
+
+    bool json = info.format == Format::eJsonLines;
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::string out;
+    auto it = std::back_inserter(out);
+
+    if (json) {
+        std::format_to(it, "{{\"time\":{:.3f}", time);
+    } else {
+        std::format_to(it, "{:.3f}", time);
+    }
+
+    for (Entry& entry : entries) {
+        Metric *pMetric = entry.pMetric;
+        const char *pzName = pMetric->getName();
+
+        if (json) {
+            std::format_to(it, ",\"{}\":", pzName);
+        } else {
+            out += ',';
+        }
+
+        switch (pMetric->getKind()) {
+        case eCounter:
+            std::format_to(it, "{}", static_cast<Counter*>(pMetric)->get());
+            break;
+
+        case eGauge:
+            std::format_to(it, "{}", static_cast<Gauge*>(pMetric)->get());
+            break;
+
+        case eHistogram: {
+            // only whats new since the last sample
+            Histogram::Snapshot total = static_cast<Histogram*>(pMetric)->get();
+            Histogram::Snapshot interval = total;
+
+            interval.count -= entry.previous.count;
+            interval.sum -= entry.previous.sum;
+            for (size_t bucket = 0; bucket < Histogram::kBucketCount; bucket++) {
+                interval.buckets[bucket] -= entry.previous.buckets[bucket];
+            }
+
+            entry.previous = total;
+
+            if (json) {
+                std::format_to(it, "{{\"count\":{},\"sum\":{}", interval.count, interval.sum);
+                for (size_t percent : kPercentiles) {
+                    std::format_to(it, ",\"p{}\":{}", percent, interval.getPercentile(percent));
+                }
+                out += '}';
+            } else {
+                std::format_to(it, "{},{}", interval.count, interval.sum);
+                for (size_t percent : kPercentiles) {
+                    std::format_to(it, ",{}", interval.getPercentile(percent));
+                }
+            }
+            break;
+        }
+
+        default:
+            NEVER("unknown metric kind {}", int(pMetric->getKind()));
+        }
+    }
+
+    out += json ? "}\n" : "\n";
+
+    // flushed every sample so a crash keeps everything up to it
+    std::fwrite(out.data(), 1, out.size(), pFile);
+    std::fflush(pFile);
+}
@@ -0,0 +1,148 @@
+#include "simcoe/core/name.h"
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace simcoe;
+using namespace simcoe::util;
+
+namespace {
+    constexpr size_t kMaxNames = 1 << 18;
+    constexpr size_t kSlotCount = kMaxNames * 2; // keep the load factor under half
+    constexpr size_t kBlockSize = units::Memory::kKilobyte * 16;
+
+    struct Text {
+        const char *pzText;
+        uint32_t length;
+        uint32_t hash;
+    };
+
+    // each thread copies text into its own block, blocks are never freed
+    struct Block {
+        char *pCursor = nullptr;
+        size_t remaining = 0;
+    };
+
+    constinit std::atomic_uint32_t gNextId = 1;
+    constinit std::atomic_size_t gTextBytes = 0;
+
+    // open addressed table of ids, 0 is an empty slot
+    constinit std::atomic_uint32_t gSlots[kSlotCount] = {};
+
+    // id -> text, published before the id is written to a slot
+    constinit std::atomic<const Text*> gTexts[kMaxNames] = {};
+
+    thread_local Block tlsBlock;
+
+    uint32_t hashText(std::string_view text) {
+        // fnv-1a
+        uint32_t hash = 2166136261u;
+        for (char c : text) {
+            hash = (hash ^ uint8_t(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    void *allocText(size_t size) {
+        size = (size + alignof(Text) - 1) & ~(alignof(Text) - 1);
+
+        // big strings get their own allocation rather than wasting the rest of a block
+        if (size > kBlockSize / 4) {
+            gTextBytes += size;
+            return std::malloc(size);
+        }
+
+        auto& [pCursor, remaining] = tlsBlock;
+        if (size > remaining) {
+            pCursor = static_cast<char*>(std::malloc(kBlockSize));
+            remaining = kBlockSize;
+            gTextBytes += kBlockSize;
+        }
+
+        void *pData = pCursor;
+        pCursor += size;
+        remaining -= size;
+        return pData;
+    }
+
+    uint32_t newText(std::string_view text, uint32_t hash) {
+        uint32_t id = gNextId.fetch_add(1);
+        ASSERTF(id < kMaxNames, "name table is full ({} names)", kMaxNames);
+
+        auto *pData = static_cast<char*>(allocText(sizeof(Text) + text.size() + 1));
+        char *pzText = pData + sizeof(Text);
+        std::memcpy(pzText, text.data(), text.size());
+        pzText[text.size()] = '\0';
+
+        Text *pText = new (pData) Text { pzText, uint32_t(text.size()), hash };
+        gTexts[id].store(pText, std::memory_order_release);
+
+        return id;
+    }
+
+    const Text *getText(uint32_t id) {
+        return gTexts[id].load(std::memory_order_acquire);
+    }
+
+    bool matches(const Text *pText, std::string_view text, uint32_t hash) {
+        return pText->hash == hash
+            && pText->length == text.size()
+            && std::memcmp(pText->pzText, text.data(), text.size()) == 0;
+    }
+
+    uint32_t intern(std::string_view text) {
+        if (text.empty()) { return 0; }
+
+        uint32_t hash = hashText(text);
+
+        // the text is only copied once we find an empty slot. if another thread fills
+        // the slot first with the same text its id wins and ours is left unused
+        uint32_t pending = 0;
+
+        for (size_t i = 0; i < kSlotCount; i++) {
+            auto& slot = gSlots[(hash + i) & (kSlotCount - 1)];
+            uint32_t id = slot.load(std::memory_order_acquire);
+
+            if (id == 0) {
+                if (pending == 0) {
+                    pending = newText(text, hash);
+                }
+
+                if (slot.compare_exchange_strong(id, pending, std::memory_order_acq_rel)) {
+                    return pending;
+                }
+            }
+
+            if (matches(getText(id), text, hash)) {
+                return id;
+            }
+        }
+
+        NEVER("name table is full");
+    }
+}
+
+Name::Name(std::string_view text)
+    : id(intern(text))
+{ }
+
+const char *Name::c_str() const {
+    return id == 0 ? "" : getText(id)->pzText;
+}
+
+std::string_view Name::view() const {
+    if (id == 0) { return { }; }
+
+    const Text *pText = getText(id);
+    return { pText->pzText, pText->length };
+}
+
+Name::Stats Name::getStats() {
+    return {
+        .names = gNextId.load() - 1,
+        .text = gTextBytes.load()
+    };
+}
@@ -1,14 +1,43 @@
 #include "simcoe/core/panic.h"
-#include "simcoe/core/system.h"
+#include "simcoe/core/logwriter.h"
 
+#include "simcoe/threads/mutex.h"
+
+#include <cstdio>
 #include <iostream>
 
-#include <dbghelp.h>
+#if _WIN32
+#   include "simcoe/core/win32.h"
+#   include <dbghelp.h>
+#endif
 
 using namespace simcoe;
 
 namespace {
-    std::mutex critical;
+    // long enough for the writer to empty a full queue, short enough that a wedged sink doesn't hang the crash
+    constexpr auto kFlushTimeout = std::chrono::seconds(2);
+
+    // a sink that panics while we flush would otherwise flush again forever
+    std::atomic_bool gFlushing = false;
+
+    // get queued log messages out before we abort, they are usually what explains the panic
+    void flushLog() {
+        if (gFlushing.exchange(true)) { return; }
+
+        if (logging::Writer *pWriter = logging::getWriter()) {
+            pWriter->flush(kFlushTimeout);
+        }
+
+        if (logging::BinarySink *pBinary = logging::getBinarySink()) {
+            pBinary->tryFlush();
+        }
+
+        // the file and console sinks go through stdio buffers that abort won't write out
+        std::fflush(nullptr);
+    }
+
+#if _WIN32
+    threads::Mutex critical;
     constexpr size_t kSymbolSize = MAX_SYM_NAME;
 
     auto newSymbol() {
@@ -91,9 +120,15 @@ namespace {
             pipe << std::format("frame@{}: {}", frame.AddrPC.Offset, name) << std::endl;
         }
     }
+#else
+    // tests and tools off windows run under a debugger or sanitizer that prints its own
+    void printBacktrace(std::ostream&) { }
+#endif
 }
 
 void simcoe::panic(const PanicInfo& info, std::string_view msg) {
+    flushLog();
+
     auto it = std::format("[{}:{}@{}]: {}", info.file, info.fn, info.line, msg);
     std::cerr << it << std::endl;
     printBacktrace(std::cerr);
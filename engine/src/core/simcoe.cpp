@@ -6,8 +6,12 @@ using namespace simcoe;
 namespace {
     std::unordered_set<logging::ISink *> gSinks;
 
-    logging::Category category(const char *pzName) {
-        auto logger = logging::Category(logging::eInfo, pzName);
+    // render and asset warnings tend to repeat every frame or for every texture
+    constexpr logging::RateLimit kNoisyLimit = { .perSecond = 5.f, .burst = 20 };
+
+    logging::Category category(util::Name name, logging::RateLimit limit = { }) {
+        auto logger = logging::Category(logging::eInfo, name);
+        logger.setRateLimit(limit);
         logger.addSink(&gFileSink);
         logger.addSink(&gConsoleSink);
         logger.addSink(&gDebugSink);
@@ -20,15 +24,16 @@ logging::ConsoleSink simcoe::gConsoleSink = logging::ConsoleSink("console");
 logging::DebugSink simcoe::gDebugSink = logging::DebugSink();
 
 logging::Category simcoe::gLog = category("general");
-logging::Category simcoe::gRenderLog = category("render");
+logging::Category simcoe::gRenderLog = category("render", kNoisyLimit);
 logging::Category simcoe::gInputLog = category("input");
-logging::Category simcoe::gAssetLog = category("asset");
+logging::Category simcoe::gAssetLog = category("asset", kNoisyLimit);
 
 void simcoe::addSink(logging::ISink *pSink) {
     gSinks.insert(pSink);
     gLog.addSink(pSink);
     gRenderLog.addSink(pSink);
     gInputLog.addSink(pSink);
+    gAssetLog.addSink(pSink);
 }
 
 void simcoe::removeSink(logging::ISink *pSink) {
@@ -36,4 +41,5 @@ void simcoe::removeSink(logging::ISink *pSink) {
     gLog.removeSink(pSink);
     gRenderLog.removeSink(pSink);
     gInputLog.removeSink(pSink);
+    gAssetLog.removeSink(pSink);
 }
@@ -0,0 +1,355 @@
+#include "simcoe/core/topology.h"
+
+#include "simcoe/core/panic.h"
+#include "simcoe/core/trace.h"
+
+#include <algorithm>
+#include <format>
+#include <string>
+
+#if _WIN32
+#   include "simcoe/core/win32.h"
+#else
+#   include <cerrno>
+#   include <fstream>
+#   include <pthread.h>
+#   include <sched.h>
+#   include <sys/resource.h>
+#   include <unistd.h>
+#endif
+
+using namespace simcoe;
+using namespace simcoe::os::threads;
+
+namespace {
+    // logical processors reserved for the main and render threads
+    constexpr size_t kReservedThreads = 2;
+
+    void sortCores(Topology& topology) {
+        std::stable_sort(topology.cores.begin(), topology.cores.end(), [](const Core& lhs, const Core& rhs) {
+            return lhs.type < rhs.type;
+        });
+    }
+
+    // logical processors a thread may run on, empty for anywhere
+    std::vector<size_t> getPlacement(const Placement& placement) {
+        const auto& topology = getTopology();
+
+        switch (placement.affinity) {
+        case Affinity::eAny:
+            return { };
+
+        case Affinity::ePerformance:
+            return topology.getLogical(ePerformance);
+
+        case Affinity::eEfficiency:
+            if (topology.isHybrid()) {
+                return topology.getLogical(eEfficiency);
+            }
+
+            return topology.getLogical(ePerformance);
+
+        case Affinity::ePinned:
+            return topology.cores[placement.core % topology.cores.size()].logical;
+
+        default:
+            NEVER("invalid affinity");
+        }
+    }
+}
+
+#if _WIN32
+
+///
+/// windows
+///
+
+namespace {
+    Topology detectTopology() {
+        DWORD size = 0;
+        GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &size);
+
+        std::vector<std::byte> buffer(size);
+        auto *pInfo = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+        if (!GetLogicalProcessorInformationEx(RelationProcessorCore, pInfo, &size)) {
+            return { { Core { ePerformance, { 0 } } }, 1 };
+        }
+
+        Topology topology = { };
+        BYTE maxClass = 0;
+        std::vector<BYTE> classes;
+
+        for (DWORD offset = 0; offset < size; ) {
+            auto *pEntry = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+            offset += pEntry->Size;
+
+            if (pEntry->Relationship != RelationProcessorCore) { continue; }
+
+            const auto& processor = pEntry->Processor;
+
+            Core core = { ePerformance, { } };
+            for (WORD i = 0; i < processor.GroupCount; i++) {
+                const auto& group = processor.GroupMask[i];
+                for (size_t bit = 0; bit < sizeof(KAFFINITY) * 8; bit++) {
+                    if (group.Mask & (KAFFINITY(1) << bit)) {
+                        core.logical.push_back(group.Group * sizeof(KAFFINITY) * 8 + bit);
+                    }
+                }
+            }
+
+            topology.logicalCount += core.logical.size();
+            topology.cores.push_back(core);
+
+            // higher efficiency classes are the faster cores, every core reports 0 on non hybrid parts
+            classes.push_back(processor.EfficiencyClass);
+            maxClass = std::max(maxClass, processor.EfficiencyClass);
+        }
+
+        for (size_t i = 0; i < topology.cores.size(); i++) {
+            topology.cores[i].type = (classes[i] == maxClass) ? ePerformance : eEfficiency;
+        }
+
+        sortCores(topology);
+        return topology;
+    }
+
+    int getThreadPriority(Priority priority) {
+        switch (priority) {
+        case Priority::eLow: return THREAD_PRIORITY_BELOW_NORMAL;
+        case Priority::eNormal: return THREAD_PRIORITY_NORMAL;
+        case Priority::eHigh: return THREAD_PRIORITY_ABOVE_NORMAL;
+        case Priority::eCritical: return THREAD_PRIORITY_TIME_CRITICAL;
+        default: NEVER("invalid priority");
+        }
+    }
+}
+
+bool os::threads::setName(std::string_view name) {
+    std::wstring wide(name.size(), L'\0');
+    int length = MultiByteToWideChar(CP_UTF8, 0, name.data(), int(name.size()), wide.data(), int(wide.size()));
+    wide.resize(size_t(length));
+
+    return SUCCEEDED(SetThreadDescription(GetCurrentThread(), wide.c_str()));
+}
+
+bool os::threads::setAffinity(std::span<const size_t> logical) {
+    if (logical.empty()) { return true; }
+
+    // a thread can only be bound to one processor group, use the group of the first processor
+    constexpr size_t kGroupSize = sizeof(KAFFINITY) * 8;
+    GROUP_AFFINITY affinity = { .Group = WORD(logical[0] / kGroupSize) };
+
+    for (size_t id : logical) {
+        if (id / kGroupSize == affinity.Group) {
+            affinity.Mask |= KAFFINITY(1) << (id % kGroupSize);
+        }
+    }
+
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+}
+
+Applied os::threads::setPriority(Priority priority) {
+    if (SetThreadPriority(GetCurrentThread(), getThreadPriority(priority))) {
+        return Applied::eAll;
+    }
+
+    return (GetLastError() == ERROR_ACCESS_DENIED) ? Applied::eDenied : Applied::eFailed;
+}
+
+#else
+
+///
+/// linux
+///
+
+namespace {
+    constexpr const char *kCpuPath = "/sys/devices/system/cpu";
+
+    // parses sysfs cpu lists such as "0-3,8,10-11"
+    std::vector<size_t> readList(const std::string& path) {
+        std::ifstream file(path);
+        std::string text;
+        if (!std::getline(file, text)) { return { }; }
+
+        std::vector<size_t> result;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find(',', pos);
+            if (end == std::string::npos) { end = text.size(); }
+
+            std::string range = text.substr(pos, end - pos);
+            size_t dash = range.find('-');
+
+            size_t first = std::stoul(range.substr(0, dash));
+            size_t last = (dash == std::string::npos) ? first : std::stoul(range.substr(dash + 1));
+
+            for (size_t i = first; i <= last; i++) {
+                result.push_back(i);
+            }
+
+            pos = end + 1;
+        }
+
+        return result;
+    }
+
+    size_t readNumber(const std::string& path, size_t fallback) {
+        std::ifstream file(path);
+        size_t value = 0;
+        return (file >> value) ? value : fallback;
+    }
+
+    Topology detectTopology() {
+        std::vector<size_t> online = readList(std::format("{}/online", kCpuPath));
+        if (online.empty()) {
+            return { { Core { ePerformance, { 0 } } }, 1 };
+        }
+
+        // intel hybrid parts list their atom cores separately, arm reports a capacity per cpu
+        std::vector<size_t> atoms = readList("/sys/devices/cpu_atom/cpus");
+
+        size_t maxCapacity = 0;
+        std::vector<size_t> capacity;
+        for (size_t cpu : online) {
+            capacity.push_back(readNumber(std::format("{}/cpu{}/cpu_capacity", kCpuPath, cpu), 0));
+            maxCapacity = std::max(maxCapacity, capacity.back());
+        }
+
+        Topology topology = { { }, online.size() };
+        std::vector<bool> seen(online.back() + 1, false);
+
+        for (size_t i = 0; i < online.size(); i++) {
+            size_t cpu = online[i];
+            if (seen[cpu]) { continue; }
+
+            std::vector<size_t> siblings = readList(std::format("{}/cpu{}/topology/thread_siblings_list", kCpuPath, cpu));
+            if (siblings.empty()) { siblings = { cpu }; }
+
+            Core core = { ePerformance, { } };
+            for (size_t sibling : siblings) {
+                if (sibling < seen.size() && !seen[sibling]) {
+                    seen[sibling] = true;
+                    core.logical.push_back(sibling);
+                }
+            }
+
+            bool isAtom = std::find(atoms.begin(), atoms.end(), cpu) != atoms.end();
+            bool isLittle = capacity[i] != 0 && capacity[i] < maxCapacity;
+            core.type = (isAtom || isLittle) ? eEfficiency : ePerformance;
+
+            topology.cores.push_back(core);
+        }
+
+        sortCores(topology);
+        return topology;
+    }
+
+    int getNiceValue(Priority priority) {
+        switch (priority) {
+        case Priority::eLow: return 5;
+        case Priority::eNormal: return 0;
+        case Priority::eHigh: return -5;
+        case Priority::eCritical: return -15;
+        default: NEVER("invalid priority");
+        }
+    }
+}
+
+bool os::threads::setName(std::string_view name) {
+    // linux thread names are capped at 15 characters
+    std::string truncated { name.substr(0, 15) };
+    return pthread_setname_np(pthread_self(), truncated.c_str()) == 0;
+}
+
+bool os::threads::setAffinity(std::span<const size_t> logical) {
+    if (logical.empty()) { return true; }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t id : logical) {
+        CPU_SET(id, &set);
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+Applied os::threads::setPriority(Priority priority) {
+    // nice values are per thread on linux, raising priority needs CAP_SYS_NICE.
+    // without it the kernel refuses with EACCES (EPERM on older kernels) and the nice value stays put
+    if (setpriority(PRIO_PROCESS, id_t(gettid()), getNiceValue(priority)) == 0) {
+        return Applied::eAll;
+    }
+
+    return (errno == EACCES || errno == EPERM) ? Applied::eDenied : Applied::eFailed;
+}
+
+#endif
+
+///
+/// common
+///
+
+bool Topology::isHybrid() const {
+    return getCoreCount(eEfficiency) > 0 && getCoreCount(ePerformance) > 0;
+}
+
+size_t Topology::getCoreCount(CoreType type) const {
+    return size_t(std::count_if(cores.begin(), cores.end(), [type](const Core& core) {
+        return core.type == type;
+    }));
+}
+
+std::vector<size_t> Topology::getLogical(CoreType type) const {
+    std::vector<size_t> result;
+    for (const Core& core : cores) {
+        if (core.type == type) {
+            result.insert(result.end(), core.logical.begin(), core.logical.end());
+        }
+    }
+
+    return result;
+}
+
+const Topology& os::threads::getTopology() {
+    static const Topology topology = detectTopology();
+    return topology;
+}
+
+size_t os::threads::getDefaultWorkerCount() {
+    const auto& topology = getTopology();
+
+    // workers are compute bound, smt siblings and efficiency cores add little
+    size_t cores = topology.getCoreCount(ePerformance);
+    return std::max<size_t>(1, cores > kReservedThreads ? cores - kReservedThreads : 1);
+}
+
+const char *os::threads::getRoleName(Role role) {
+    switch (role) {
+    case eMain: return "main";
+    case eRender: return "render";
+    case eWorker: return "worker";
+    case eLogging: return "logging";
+    case eMetrics: return "metrics";
+    default: return "unknown";
+    }
+}
+
+Applied os::threads::setup(Role role, const Info& info, size_t index) {
+    const Placement& placement = info.roles[role];
+
+    std::string name = (role == eWorker)
+        ? std::format("{} {}", getRoleName(role), index)
+        : std::string(getRoleName(role));
+
+    bool named = setName(name);
+    trace::setThreadName(name);
+
+    std::vector<size_t> logical = getPlacement(placement);
+
+    bool placed = setAffinity(logical);
+    Applied prioritised = setPriority(placement.priority);
+
+    if (!named || !placed) { return Applied::eFailed; }
+
+    return prioritised;
+}
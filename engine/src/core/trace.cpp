@@ -0,0 +1,307 @@
+#include "simcoe/core/trace.h"
+
+
+#include "simcoe/memory/tracking.h"
+
+#include "simcoe/threads/mutex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::trace;
+
+std::atomic_bool detail::gRecording = false;
+
+#if SIMCOE_TRACE
+
+namespace {
+    struct Event {
+        const char *pzName;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    // frame markers are zero length events with this name, compared by address
+    constexpr char kFrameName[] = "frame";
+
+    // save copies slots while their thread may be writing them, so the fields are relaxed atomics.
+    // a copy that raced with a write is thrown away by the head check in copyEvents
+    struct Slot {
+        std::atomic<const char*> pzName;
+        std::atomic_uint64_t begin;
+        std::atomic_uint64_t end;
+    };
+
+    // only its own thread writes to a ring. head counts every event the thread has written
+    // and is published with release, so a reader only sees complete events below it
+    struct Ring {
+        std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(kRingSize);
+        std::atomic_uint64_t head = 0;
+
+        // guarded by gLock
+        uint64_t first = 0; // head when the capture started
+        size_t id;
+        std::string name;
+    };
+
+    threads::Mutex gLock;
+    std::vector<std::unique_ptr<Ring>> gRings;
+
+    // guarded by gLock, the ticks and time are sampled together to convert ticks to time
+    uint64_t gStartTicks = 0;
+    uint64_t gStopTicks = 0;
+    std::chrono::steady_clock::time_point gStartTime;
+    std::chrono::steady_clock::time_point gStopTime;
+
+    std::atomic_size_t gFramesLeft = 0;
+
+    constinit thread_local Ring *tlsRing = nullptr;
+    thread_local std::string tlsName;
+
+    Ring *newRing() {
+        // the first zone on a thread may be inside a zero allocation frame
+        memory::AllowAllocScope allow;
+
+        std::lock_guard guard(gLock);
+        auto& ring = gRings.emplace_back(std::make_unique<Ring>());
+        ring->id = gRings.size();
+        ring->name = tlsName.empty() ? std::format("thread {}", ring->id) : tlsName;
+
+        tlsRing = ring.get();
+        return tlsRing;
+    }
+
+    // copy out what the ring holds for this capture. its thread may still be writing,
+    // anything it could have overwritten while this copied is dropped
+    void copyEvents(const Ring& ring, std::vector<Event>& out) {
+        out.clear();
+
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t first = std::max(ring.first, (head > kRingSize) ? head - kRingSize : 0);
+
+        for (uint64_t i = first; i < head; i++) {
+            const Slot& slot = ring.slots[i % kRingSize];
+            out.push_back({
+                .pzName = slot.pzName.load(std::memory_order_relaxed),
+                .begin = slot.begin.load(std::memory_order_relaxed),
+                .end = slot.end.load(std::memory_order_relaxed)
+            });
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // the slot for the next event held the one kRingSize before it
+        uint64_t after = ring.head.load(std::memory_order_relaxed);
+        uint64_t valid = (after + 1 > kRingSize) ? after + 1 - kRingSize : 0;
+
+        if (valid > first) {
+            out.erase(out.begin(), out.begin() + ptrdiff_t(std::min(valid - first, uint64_t(out.size()))));
+        }
+    }
+
+    void appendString(std::string& out, std::string_view text) {
+        out += '"';
+        for (char c : text) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            default:
+                if (uint8_t(c) < 0x20) {
+                    std::format_to(std::back_inserter(out), "\\u{:04x}", unsigned(c));
+                } else {
+                    out += c;
+                }
+                break;
+            }
+        }
+        out += '"';
+    }
+
+    bool stopLocked() {
+        if (!detail::gRecording.load(std::memory_order_relaxed)) { return false; }
+
+        detail::gRecording.store(false, std::memory_order_relaxed);
+        gFramesLeft.store(0, std::memory_order_relaxed);
+
+        gStopTicks = detail::now();
+        gStopTime = std::chrono::steady_clock::now();
+        return true;
+    }
+}
+
+void detail::record(const char *pzName, uint64_t begin, uint64_t end) {
+    // zones that end after the capture stops are thrown away when saving anyway,
+    // dropping them here keeps threads off the rings while they are copied
+    if (!gRecording.load(std::memory_order_relaxed)) { return; }
+
+    Ring *pRing = tlsRing;
+    if (pRing == nullptr) {
+        pRing = newRing();
+    }
+
+    uint64_t head = pRing->head.load(std::memory_order_relaxed);
+
+    // pairs with the fence in copyEvents. a copy that sees any of these stores also sees
+    // the head from before them, so it knows the slot was being reused
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Slot& slot = pRing->slots[head % kRingSize];
+    slot.pzName.store(pzName, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+
+    pRing->head.store(head + 1, std::memory_order_release);
+}
+
+void trace::start() {
+    std::lock_guard guard(gLock);
+
+    for (auto& ring : gRings) {
+        ring->first = ring->head.load(std::memory_order_acquire);
+    }
+
+    gStartTicks = detail::now();
+    gStartTime = std::chrono::steady_clock::now();
+    gStopTicks = UINT64_MAX;
+
+    detail::gRecording.store(true, std::memory_order_relaxed);
+}
+
+void trace::stop() {
+    std::lock_guard guard(gLock);
+    stopLocked();
+}
+
+void trace::capture(size_t frames) {
+    // set first so a frame that lands right after start already counts
+    gFramesLeft.store(frames, std::memory_order_relaxed);
+    start();
+}
+
+void trace::frame() {
+    if (!detail::gRecording.load(std::memory_order_relaxed)) { return; }
+
+    uint64_t now = detail::now();
+    detail::record(kFrameName, now, now);
+
+    size_t left = gFramesLeft.load(std::memory_order_relaxed);
+    while (left != 0 && !gFramesLeft.compare_exchange_weak(left, left - 1, std::memory_order_relaxed)) { }
+
+    if (left == 1) {
+        stop();
+    }
+}
+
+bool trace::isRecording() {
+    return detail::gRecording.load(std::memory_order_relaxed);
+}
+
+Stats trace::getStats() {
+    std::lock_guard guard(gLock);
+
+    Stats stats = { .threads = gRings.size(), .events = 0, .lost = 0 };
+    for (auto& ring : gRings) {
+        uint64_t count = ring->head.load(std::memory_order_relaxed) - ring->first;
+        uint64_t kept = std::min(count, uint64_t(kRingSize));
+
+        stats.events += size_t(kept);
+        stats.lost += size_t(count - kept);
+    }
+
+    return stats;
+}
+
+bool trace::save(const char *pzPath) {
+    // traces run to megabytes, keep them out of zero allocation frames
+    memory::AllowAllocScope allow;
+
+    std::lock_guard guard(gLock);
+    stopLocked();
+
+    uint64_t ticks = gStopTicks - gStartTicks;
+    auto elapsed = std::chrono::duration<double, std::micro>(gStopTime - gStartTime);
+    double usPerTick = (ticks == 0) ? 0.0 : elapsed.count() / double(ticks);
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    auto it = std::back_inserter(out);
+
+    std::vector<Event> events;
+    events.reserve(kRingSize);
+
+    for (auto& ring : gRings) {
+        std::format_to(it, "{{\"ph\":\"M\",\"pid\":0,\"tid\":{},\"name\":\"thread_name\",\"args\":{{\"name\":", ring->id);
+        appendString(out, ring->name);
+        out += "}},\n";
+
+        copyEvents(*ring, events);
+
+        for (const Event& event : events) {
+            // left over from an earlier capture, or finished after this one stopped
+            if (event.begin < gStartTicks || event.end > gStopTicks) { continue; }
+
+            double ts = double(event.begin - gStartTicks) * usPerTick;
+
+            if (event.pzName == kFrameName) {
+                std::format_to(it, "{{\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"name\":\"frame\"}},\n", ring->id, ts);
+                continue;
+            }
+
+            double dur = double(event.end - event.begin) * usPerTick;
+            std::format_to(it, "{{\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"name\":", ring->id, ts, dur);
+            appendString(out, event.pzName);
+            out += "},\n";
+        }
+    }
+
+    // every event above ends with a comma, close with one that doesn't
+    out += "{\"ph\":\"M\",\"pid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"simcoe\"}}\n]}\n";
+
+    FILE *pFile = std::fopen(pzPath, "wb");
+    if (pFile == nullptr) { return false; }
+
+    bool written = std::fwrite(out.data(), 1, out.size(), pFile) == out.size();
+    std::fclose(pFile);
+
+    return written;
+}
+
+void trace::setThreadName(std::string_view name) {
+    tlsName = name;
+
+    if (Ring *pRing = tlsRing; pRing != nullptr) {
+        std::lock_guard guard(gLock);
+        pRing->name = name;
+    }
+}
+
+#else
+
+void detail::record(const char *, uint64_t, uint64_t) { }
+
+void trace::start() { }
+void trace::stop() { }
+void trace::capture(size_t) { }
+void trace::frame() { }
+
+bool trace::isRecording() {
+    return false;
+}
+
+Stats trace::getStats() {
+    return Stats { };
+}
+
+bool trace::save(const char *) {
+    return false;
+}
+
+void trace::setThreadName(std::string_view) { }
+
+#endif
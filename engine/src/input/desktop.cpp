@@ -1,13 +1,13 @@
 #include "simcoe/input/desktop.h"
 #include "simcoe/core/system.h"
+#include "simcoe/core/trace.h"
 #include "simcoe/core/util.h"
+#include "simcoe/memory/flatmap.h"
 
 #include "simcoe/simcoe.h"
 
 #include "common.h"
 
-#include <unordered_map>
-
 using namespace simcoe;
 using namespace simcoe::input;
 
@@ -47,7 +47,7 @@ namespace {
         return vkCode;
     }
 
-    const std::unordered_map<int, Key> kDesktopKeys = {
+    const memory::FlatMap<int, Key> kDesktopKeys = {
         { 'A', Key::keyA },
         { 'B', Key::keyB },
         { 'C', Key::keyC },
@@ -224,6 +224,8 @@ void Mouse::captureInput(bool capture) {
 }
 
 void Mouse::update(HWND hWnd) {
+    SIMCOE_ZONE("input::Mouse::update");
+
     if (!enabled) {
         absolute = base;
         return;
@@ -1,11 +1,18 @@
 #include "simcoe/input/input.h"
 
+#include "simcoe/core/trace.h"
+
+#include "simcoe/memory/tracking.h"
+
 using namespace simcoe;
 using namespace simcoe::input;
 
 ISource::ISource(Device kind) : kind(kind) { }
 
 void Manager::poll() {
+    SIMCOE_ZONE("input::Manager::poll");
+    memory::TagScope tag(memory::eInput);
+
     bool dirty = false;
     for (ISource *pSource : sources) {
         if (pSource->poll(state)) {
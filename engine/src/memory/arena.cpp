@@ -0,0 +1,93 @@
+#include "simcoe/memory/arena.h"
+
+#include "simcoe/core/panic.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+struct FrameArena::Chunk {
+    Chunk *pNext;
+};
+
+namespace {
+    constexpr size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+}
+
+FrameArena::FrameArena(size_t frames, size_t size)
+    : size(size)
+    , blocks(frames)
+{
+    ASSERT(frames > 0);
+
+    for (Block& block : blocks) {
+        block.pMemory.reset(new std::byte[size]);
+    }
+}
+
+FrameArena::~FrameArena() {
+    for (Block& block : blocks) {
+        freeOverflow(block, nullptr);
+    }
+}
+
+void *FrameArena::alloc(size_t bytes, size_t align) {
+    Block& block = blocks[current];
+
+    // align the address rather than the offset, the block is only max_align_t aligned
+    std::uintptr_t base = std::uintptr_t(block.pMemory.get());
+    size_t offset = alignUp(base + block.offset, align) - base;
+
+    if (offset + bytes > size) {
+        return overflow(bytes, align);
+    }
+
+    block.offset = offset + bytes;
+    return block.pMemory.get() + offset;
+}
+
+void FrameArena::reset(size_t frame) {
+    ASSERT(frame < blocks.size());
+
+    current = frame;
+    rewind({ 0, nullptr });
+}
+
+FrameArena::Mark FrameArena::mark() const {
+    const Block& block = blocks[current];
+    return { block.offset, block.pOverflow };
+}
+
+void FrameArena::rewind(Mark mark) {
+    Block& block = blocks[current];
+
+    block.offset = mark.offset;
+    freeOverflow(block, mark.pOverflow);
+}
+
+void *FrameArena::overflow(size_t bytes, size_t align) {
+    Block& block = blocks[current];
+    overflows += 1;
+
+    // chunk header followed by the aligned allocation
+    auto *pChunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + bytes + align));
+    ASSERT(pChunk != nullptr);
+
+    pChunk->pNext = block.pOverflow;
+    block.pOverflow = pChunk;
+
+    std::uintptr_t data = alignUp(std::uintptr_t(pChunk) + sizeof(Chunk), align);
+    return reinterpret_cast<void*>(data);
+}
+
+void FrameArena::freeOverflow(Block& block, Chunk *pLast) {
+    while (block.pOverflow != pLast) {
+        Chunk *pNext = block.pOverflow->pNext;
+        std::free(block.pOverflow);
+        block.pOverflow = pNext;
+    }
+}
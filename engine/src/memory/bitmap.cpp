@@ -12,14 +12,218 @@ bool BitMap::testSet(size_t index) {
         return false;
     }
 
-    set(index);
+    size_t word = getWord(index);
+    pBits[word] |= getMask(index);
+
+    if (pBits[word] == kFull) {
+        pFull[word / kBits] |= getMask(word);
+    }
+
     return true;
 }
 
+size_t BitMap::claim(size_t word) {
+    std::uint64_t bits = pBits[word];
+    if (bits == kFull) {
+        pFull[word / kBits] |= getMask(word);
+        return SIZE_MAX;
+    }
+
+    size_t bit = std::countr_zero(~bits);
+    pBits[word] = bits | getMask(bit);
+
+    if (pBits[word] == kFull) {
+        pFull[word / kBits] |= getMask(word);
+    }
+
+    return bit;
+}
+
+void BitMap::clear(size_t index) {
+    size_t word = getWord(index);
+
+    pBits[word] &= ~getMask(index);
+    pFull[word / kBits] &= ~getMask(word);
+}
+
 // AtomicBitMap
 
 bool AtomicBitMap::testSet(size_t index) {
     auto mask = getMask(index);
+    size_t word = getWord(index);
+
+    std::uint64_t bits = pBits[word].fetch_or(mask);
+    if (bits & mask) {
+        return false;
+    }
+
+    if ((bits | mask) == kFull) {
+        markFull(word);
+    }
+
+    return true;
+}
+
+size_t AtomicBitMap::claim(size_t word) {
+    std::uint64_t bits = pBits[word].load(std::memory_order_acquire);
+
+    while (bits != kFull) {
+        size_t bit = std::countr_zero(~bits);
+        std::uint64_t next = bits | getMask(bit);
+
+        // on failure bits is reloaded and we try the next free bit
+        if (pBits[word].compare_exchange_weak(bits, next)) {
+            if (next == kFull) {
+                markFull(word);
+            }
+
+            return bit;
+        }
+    }
+
+    markFull(word);
+    return SIZE_MAX;
+}
+
+void AtomicBitMap::clear(size_t index) {
+    size_t word = getWord(index);
+
+    // clear the leaf before the summary so a concurrent markFull
+    // will always see the free bit on its recheck
+    pBits[word].fetch_and(~getMask(index));
+    pFull[word / kBits].fetch_and(~getMask(word));
+}
+
+void AtomicBitMap::markFull(size_t word) {
+    auto mask = getMask(word);
+    auto& summary = pFull[word / kBits];
+
+    summary.fetch_or(mask);
+
+    if (pBits[word].load() != kFull) {
+        summary.fetch_and(~mask);
+    }
+}
+
+AtomicBitMap::Index AtomicBitMap::allocRange(size_t count) {
+    ASSERT(count > 0);
 
-    return !(pBits[getWord(index)].fetch_or(mask) & mask);
+    if (count == 1) {
+        return alloc();
+    }
+
+    size_t start = 0;
+    while (start + count <= getSize()) {
+        size_t first = findRange(start, count);
+        if (first == SIZE_MAX) {
+            break;
+        }
+
+        if (claimRange(first, count)) {
+            return Index(first);
+        }
+
+        // another thread claimed part of the run, rescan from the same place
+        // the bits it took will now be skipped
+        start = first;
+    }
+
+    return Index::eInvalid;
+}
+
+void AtomicBitMap::releaseRange(Index index, size_t count) {
+    ASSERT(index != Index::eInvalid);
+    ASSERT(size_t(index) + count <= getSize());
+
+    clearRange(size_t(index), count);
+}
+
+size_t AtomicBitMap::findRange(size_t start, size_t count) const {
+    size_t bit = start;
+
+    while (bit + count <= getSize()) {
+        size_t word = getWord(bit);
+
+        // skip whole summary words where every leaf is full
+        if (bit % (kBits * kBits) == 0 && pFull[word / kBits].load() == kFull) {
+            bit += kBits * kBits;
+            continue;
+        }
+
+        // ignore bits below the start of the search in this word
+        std::uint64_t bits = pBits[word].load() | (getMask(bit) - 1);
+        if (bits == kFull) {
+            bit = (word + 1) * kBits;
+            continue;
+        }
+
+        bit = word * kBits + std::countr_zero(~bits);
+
+        // measure the run of clear bits starting at bit
+        size_t end = bit;
+        while (end - bit < count && end < getSize()) {
+            size_t offset = end % kBits;
+            std::uint64_t rest = pBits[getWord(end)].load() >> offset;
+
+            size_t clear = (rest == 0) ? (kBits - offset) : std::countr_zero(rest);
+            end += clear;
+
+            if (clear < kBits - offset) {
+                break;
+            }
+        }
+
+        if (end - bit >= count) {
+            return bit;
+        }
+
+        // end is now at a set bit, continue the search after it
+        bit = end;
+    }
+
+    return SIZE_MAX;
+}
+
+bool AtomicBitMap::claimRange(size_t first, size_t count) {
+    size_t bit = first;
+    size_t last = first + count;
+
+    while (bit < last) {
+        size_t word = getWord(bit);
+        size_t offset = bit % kBits;
+        size_t length = std::min(kBits - offset, last - bit);
+        std::uint64_t mask = getRangeMask(offset, length);
+
+        std::uint64_t bits = pBits[word].load(std::memory_order_acquire);
+        do {
+            if (bits & mask) {
+                clearRange(first, bit - first);
+                return false;
+            }
+        } while (!pBits[word].compare_exchange_weak(bits, bits | mask));
+
+        if ((bits | mask) == kFull) {
+            markFull(word);
+        }
+
+        bit += length;
+    }
+
+    return true;
+}
+
+void AtomicBitMap::clearRange(size_t first, size_t count) {
+    size_t bit = first;
+    size_t last = first + count;
+
+    while (bit < last) {
+        size_t word = getWord(bit);
+        size_t offset = bit % kBits;
+        size_t length = std::min(kBits - offset, last - bit);
+
+        pBits[word].fetch_and(~getRangeMask(offset, length));
+        pFull[word / kBits].fetch_and(~getMask(word));
+
+        bit += length;
+    }
 }
@@ -0,0 +1,273 @@
+#include "simcoe/memory/offset.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    constexpr size_t divideUp(size_t value, size_t divisor) {
+        return (value + divisor - 1) / divisor;
+    }
+
+    constexpr size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+}
+
+OffsetAllocator::OffsetAllocator(size_t size, size_t granularity)
+    : granularity(granularity)
+    , totalSize(size / granularity)
+{
+    ASSERT(std::has_single_bit(granularity));
+    ASSERT(totalSize > 0);
+
+    for (auto& heads : freeHeads) {
+        std::fill_n(heads, kSecondCount, kNone);
+    }
+
+    insertFree(newBlock(0, totalSize));
+}
+
+OffsetAllocator::Allocation OffsetAllocator::alloc(size_t bytes, size_t align) {
+    size_t size = std::max<size_t>(divideUp(bytes, granularity), 1);
+    size_t alignment = std::max<size_t>(divideUp(align, granularity), 1);
+    ASSERT(std::has_single_bit(alignment));
+
+    // search for enough space to align the start of the block in the worst case
+    std::uint32_t index = findFree(size + alignment - 1);
+    if (index == kNone) {
+        return Allocation();
+    }
+
+    removeFree(index);
+
+    size_t padding = alignUp(blocks[index].offset, alignment) - blocks[index].offset;
+    if (padding > 0) {
+        splitFront(index, padding);
+    }
+
+    if (blocks[index].size > size) {
+        splitBack(index, size);
+    }
+
+    Block& block = blocks[index];
+    block.free = false;
+
+    usedSize += block.size;
+    peakSize = std::max(peakSize, usedSize);
+    allocations += 1;
+
+    return Allocation { block.offset * granularity, Index(index) };
+}
+
+void OffsetAllocator::release(Index handle) {
+    ASSERT(handle != Index::eInvalid);
+
+    std::uint32_t index = std::uint32_t(handle);
+    ASSERT(!blocks[index].free);
+
+    blocks[index].free = true;
+    usedSize -= blocks[index].size;
+    allocations -= 1;
+
+    // coalesce with free neighbours so free blocks are never adjacent
+    if (std::uint32_t prev = blocks[index].prevPhysical; prev != kNone && blocks[prev].free) {
+        removeFree(prev);
+        merge(prev, index);
+        index = prev;
+    }
+
+    if (std::uint32_t next = blocks[index].nextPhysical; next != kNone && blocks[next].free) {
+        removeFree(next);
+        merge(index, next);
+    }
+
+    insertFree(index);
+}
+
+OffsetAllocator::Stats OffsetAllocator::getStats() const {
+    size_t largest = 0;
+
+    // the largest block is in the highest non empty bin
+    if (firstBitmap != 0) {
+        size_t first = 63 - std::countl_zero(firstBitmap);
+        size_t second = 31 - std::countl_zero(secondBitmap[first]);
+
+        for (std::uint32_t it = freeHeads[first][second]; it != kNone; it = blocks[it].nextFree) {
+            largest = std::max(largest, blocks[it].size);
+        }
+    }
+
+    size_t freeSize = totalSize - usedSize;
+    float fragmentation = freeSize == 0 ? 0.f : 1.f - float(largest) / float(freeSize);
+
+    return Stats {
+        .size = units::Memory(totalSize * granularity),
+        .used = units::Memory(usedSize * granularity),
+        .peak = units::Memory(peakSize * granularity),
+        .free = units::Memory(freeSize * granularity),
+        .largestFree = units::Memory(largest * granularity),
+        .fragmentation = fragmentation,
+        .allocations = allocations
+    };
+}
+
+OffsetAllocator::Bin OffsetAllocator::getBin(size_t size) {
+    // small sizes map linearly into the first bin
+    if (size < kSecondCount) {
+        return { 0, size };
+    }
+
+    size_t msb = std::bit_width(size) - 1;
+    size_t first = msb - kSecondBits + 1;
+    size_t second = (size >> (msb - kSecondBits)) - kSecondCount;
+
+    return { first, second };
+}
+
+OffsetAllocator::Bin OffsetAllocator::getSearchBin(size_t size) {
+    if (size >= kSecondCount) {
+        size_t msb = std::bit_width(size) - 1;
+        size += (size_t(1) << (msb - kSecondBits)) - 1;
+    }
+
+    return getBin(size);
+}
+
+std::uint32_t OffsetAllocator::findFree(size_t size) const {
+    auto [first, second] = getSearchBin(size);
+    if (first >= kFirstCount) {
+        return kNone;
+    }
+
+    std::uint32_t secondMask = secondBitmap[first] & (~std::uint32_t(0) << second);
+    if (secondMask == 0) {
+        // nothing in this first level, move to the next non empty one
+        std::uint64_t firstMask = (first + 1 < 64) ? (firstBitmap & (~std::uint64_t(0) << (first + 1))) : 0;
+        if (firstMask == 0) {
+            return kNone;
+        }
+
+        first = std::countr_zero(firstMask);
+        secondMask = secondBitmap[first];
+    }
+
+    second = std::countr_zero(secondMask);
+    return freeHeads[first][second];
+}
+
+std::uint32_t OffsetAllocator::newBlock(size_t offset, size_t size) {
+    Block block = { .offset = offset, .size = size };
+
+    if (!unusedBlocks.empty()) {
+        std::uint32_t index = unusedBlocks.back();
+        unusedBlocks.pop_back();
+        blocks[index] = block;
+        return index;
+    }
+
+    blocks.push_back(block);
+    return std::uint32_t(blocks.size() - 1);
+}
+
+void OffsetAllocator::deleteBlock(std::uint32_t index) {
+    unusedBlocks.push_back(index);
+}
+
+void OffsetAllocator::insertFree(std::uint32_t index) {
+    Block& block = blocks[index];
+    auto [first, second] = getBin(block.size);
+
+    std::uint32_t head = freeHeads[first][second];
+
+    block.free = true;
+    block.prevFree = kNone;
+    block.nextFree = head;
+
+    if (head != kNone) {
+        blocks[head].prevFree = index;
+    }
+
+    freeHeads[first][second] = index;
+    firstBitmap |= std::uint64_t(1) << first;
+    secondBitmap[first] |= std::uint32_t(1) << second;
+}
+
+void OffsetAllocator::removeFree(std::uint32_t index) {
+    Block& block = blocks[index];
+    auto [first, second] = getBin(block.size);
+
+    if (block.prevFree != kNone) {
+        blocks[block.prevFree].nextFree = block.nextFree;
+    } else {
+        freeHeads[first][second] = block.nextFree;
+    }
+
+    if (block.nextFree != kNone) {
+        blocks[block.nextFree].prevFree = block.prevFree;
+    }
+
+    block.prevFree = kNone;
+    block.nextFree = kNone;
+
+    if (freeHeads[first][second] == kNone) {
+        secondBitmap[first] &= ~(std::uint32_t(1) << second);
+
+        if (secondBitmap[first] == 0) {
+            firstBitmap &= ~(std::uint64_t(1) << first);
+        }
+    }
+}
+
+void OffsetAllocator::splitBack(std::uint32_t index, size_t size) {
+    std::uint32_t tail = newBlock(blocks[index].offset + size, blocks[index].size - size);
+
+    // newBlock may have grown the vector, so dont hold references across it
+    blocks[tail].prevPhysical = index;
+    blocks[tail].nextPhysical = blocks[index].nextPhysical;
+
+    if (blocks[index].nextPhysical != kNone) {
+        blocks[blocks[index].nextPhysical].prevPhysical = tail;
+    }
+
+    blocks[index].nextPhysical = tail;
+    blocks[index].size = size;
+
+    insertFree(tail);
+}
+
+void OffsetAllocator::splitFront(std::uint32_t index, size_t size) {
+    std::uint32_t head = newBlock(blocks[index].offset, size);
+
+    blocks[head].prevPhysical = blocks[index].prevPhysical;
+    blocks[head].nextPhysical = index;
+
+    if (blocks[index].prevPhysical != kNone) {
+        blocks[blocks[index].prevPhysical].nextPhysical = head;
+    }
+
+    blocks[index].prevPhysical = head;
+    blocks[index].offset += size;
+    blocks[index].size -= size;
+
+    insertFree(head);
+}
+
+void OffsetAllocator::merge(std::uint32_t index, std::uint32_t other) {
+    Block& block = blocks[index];
+    Block& next = blocks[other];
+    ASSERT(block.nextPhysical == other);
+
+    block.size += next.size;
+    block.nextPhysical = next.nextPhysical;
+
+    if (next.nextPhysical != kNone) {
+        blocks[next.nextPhysical].prevPhysical = index;
+    }
+
+    deleteBlock(other);
+}
@@ -0,0 +1,243 @@
+#include "simcoe/memory/pool.h"
+
+#include "simcoe/core/panic.h"
+
+#include "simcoe/threads/mutex.h"
+
+#include <bit>
+#include <mutex>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    constexpr size_t kClassCount = std::countr_zero(detail::kMaxSizeClass) - std::countr_zero(detail::kMinSizeClass) + 1;
+    constexpr size_t kMagazineSize = 64;
+    constexpr size_t kSlabSize = 64 * 1024;
+
+    constexpr size_t getSizeClass(size_t size) {
+        if (size <= detail::kMinSizeClass) { return 0; }
+
+        return std::bit_width(size - 1) - std::countr_zero(detail::kMinSizeClass);
+    }
+
+    constexpr size_t getClassSize(size_t index) {
+        return detail::kMinSizeClass << index;
+    }
+
+    struct Magazine {
+        size_t count = 0;
+        void *pItems[kMagazineSize];
+
+        bool empty() const { return count == 0; }
+        bool full() const { return count == kMagazineSize; }
+
+        void *pop() { return pItems[--count]; }
+        void push(void *ptr) { pItems[count++] = ptr; }
+    };
+
+    // shared state per size class, only touched when a thread
+    // runs out of objects or has too many cached
+    struct Depot {
+        threads::Mutex mutex;
+
+        std::vector<Magazine*> full;
+        std::vector<Magazine*> empty;
+
+        // bump allocation out of the current slab
+        std::byte *pCursor = nullptr;
+        std::byte *pEnd = nullptr;
+
+        std::vector<std::unique_ptr<std::byte[]>> slabs;
+
+        Magazine *takeFull() {
+            if (full.empty()) { return nullptr; }
+
+            Magazine *pMagazine = full.back();
+            full.pop_back();
+            return pMagazine;
+        }
+
+        Magazine *takeEmpty() {
+            if (empty.empty()) { return new Magazine(); }
+
+            Magazine *pMagazine = empty.back();
+            empty.pop_back();
+            return pMagazine;
+        }
+
+        void give(Magazine *pMagazine) {
+            if (pMagazine == nullptr) { return; }
+
+            if (pMagazine->empty()) {
+                empty.push_back(pMagazine);
+            } else {
+                full.push_back(pMagazine);
+            }
+        }
+
+        // single objects for threads whose cache is already gone
+        void *allocOne(size_t size) {
+            if (Magazine *pMagazine = takeFull(); pMagazine != nullptr) {
+                void *ptr = pMagazine->pop();
+                give(pMagazine);
+                return ptr;
+            }
+
+            Magazine *pMagazine = takeEmpty();
+            fill(pMagazine, size);
+
+            void *ptr = pMagazine->pop();
+            give(pMagazine);
+            return ptr;
+        }
+
+        void freeOne(void *ptr) {
+            Magazine *pMagazine = (!full.empty() && !full.back()->full()) ? takeFull() : takeEmpty();
+            pMagazine->push(ptr);
+            give(pMagazine);
+        }
+
+        // carve fresh objects out of a slab
+        void fill(Magazine *pMagazine, size_t size) {
+            while (!pMagazine->full()) {
+                if (pCursor + size > pEnd) {
+                    auto& slab = slabs.emplace_back(new std::byte[kSlabSize]);
+                    pCursor = slab.get();
+                    pEnd = pCursor + kSlabSize;
+                }
+
+                pMagazine->push(pCursor);
+                pCursor += size;
+            }
+        }
+    };
+
+    // the depots are leaked on purpose so objects can be freed during static destruction
+    Depot *getDepots() {
+        static Depot *pDepots = new Depot[kClassCount];
+        return pDepots;
+    }
+
+    // set once the thread cache is destroyed. other thread_local destructors
+    // that run after it may still allocate, those go straight to the depot.
+    // a plain bool has no destructor so it stays readable until the thread exits
+    thread_local bool tlsCacheDestroyed = false;
+
+    struct ThreadCache {
+        // two magazines per class so alternating alloc and free at a
+        // magazine boundary doesnt hit the depot every time
+        Magazine *pLoaded[kClassCount] = {};
+        Magazine *pPrevious[kClassCount] = {};
+
+        ~ThreadCache() {
+            Depot *pDepots = getDepots();
+
+            for (size_t i = 0; i < kClassCount; i++) {
+                std::lock_guard guard(pDepots[i].mutex);
+                pDepots[i].give(pLoaded[i]);
+                pDepots[i].give(pPrevious[i]);
+
+                pLoaded[i] = nullptr;
+                pPrevious[i] = nullptr;
+            }
+
+            tlsCacheDestroyed = true;
+        }
+
+        void *alloc(size_t index) {
+            Magazine *&pLoadedMag = pLoaded[index];
+            Magazine *&pPreviousMag = pPrevious[index];
+
+            if (pLoadedMag != nullptr && !pLoadedMag->empty()) {
+                return pLoadedMag->pop();
+            }
+
+            if (pPreviousMag != nullptr && !pPreviousMag->empty()) {
+                std::swap(pLoadedMag, pPreviousMag);
+                return pLoadedMag->pop();
+            }
+
+            Depot& depot = getDepots()[index];
+            std::lock_guard guard(depot.mutex);
+
+            // return the empty magazine and load a full one from the depot
+            depot.give(pPreviousMag);
+            pPreviousMag = pLoadedMag;
+
+            if (Magazine *pFull = depot.takeFull(); pFull != nullptr) {
+                pLoadedMag = pFull;
+            } else {
+                pLoadedMag = depot.takeEmpty();
+                depot.fill(pLoadedMag, getClassSize(index));
+            }
+
+            return pLoadedMag->pop();
+        }
+
+        void free(void *ptr, size_t index) {
+            Magazine *&pLoadedMag = pLoaded[index];
+            Magazine *&pPreviousMag = pPrevious[index];
+
+            if (pLoadedMag != nullptr && !pLoadedMag->full()) {
+                pLoadedMag->push(ptr);
+                return;
+            }
+
+            if (pPreviousMag != nullptr && !pPreviousMag->full()) {
+                std::swap(pLoadedMag, pPreviousMag);
+                pLoadedMag->push(ptr);
+                return;
+            }
+
+            Depot& depot = getDepots()[index];
+            std::lock_guard guard(depot.mutex);
+
+            // hand the full magazine to the depot and start an empty one
+            depot.give(pPreviousMag);
+            pPreviousMag = pLoadedMag;
+            pLoadedMag = depot.takeEmpty();
+
+            pLoadedMag->push(ptr);
+        }
+    };
+
+    thread_local ThreadCache tlsCache;
+}
+
+void *detail::poolAlloc(size_t size) {
+    if (size > kMaxSizeClass) {
+        return ::operator new(size);
+    }
+
+    size_t index = getSizeClass(size);
+
+    if (tlsCacheDestroyed) {
+        Depot& depot = getDepots()[index];
+        std::lock_guard guard(depot.mutex);
+        return depot.allocOne(getClassSize(index));
+    }
+
+    return tlsCache.alloc(index);
+}
+
+void detail::poolFree(void *ptr, size_t size) {
+    if (ptr == nullptr) { return; }
+
+    if (size > kMaxSizeClass) {
+        ::operator delete(ptr, size);
+        return;
+    }
+
+    size_t index = getSizeClass(size);
+
+    if (tlsCacheDestroyed) {
+        Depot& depot = getDepots()[index];
+        std::lock_guard guard(depot.mutex);
+        depot.freeOne(ptr);
+        return;
+    }
+
+    tlsCache.free(ptr, index);
+}
@@ -0,0 +1,77 @@
+#include "simcoe/memory/ring.h"
+
+#include "simcoe/core/panic.h"
+
+#include <bit>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    constexpr size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+}
+
+ChunkRing::ChunkRing(IFence& fence, size_t chunkSize)
+    : fence(fence)
+    , chunkSize(chunkSize)
+{
+    ASSERT(chunkSize > 0);
+}
+
+ChunkRing::Allocation ChunkRing::alloc(size_t size, size_t align) {
+    ASSERT(std::has_single_bit(align));
+    ASSERTF(size <= chunkSize, "allocation of {} bytes does not fit in a {} byte chunk", size, chunkSize);
+
+    size_t start = alignUp(offset, align);
+    if (current == kNone || start + size > chunkSize) {
+        current = nextChunk();
+        start = 0;
+    }
+
+    offset = start + size;
+    return Allocation { current, start };
+}
+
+void ChunkRing::retire(std::uint64_t value) {
+    // fence values only increase so the retired queue stays sorted
+    ASSERT(retired.empty() || retired.back().value <= value);
+
+    for (size_t chunk : frameChunks) {
+        retired.push_back({ chunk, value });
+    }
+
+    frameChunks.clear();
+    current = kNone;
+    offset = 0;
+}
+
+size_t ChunkRing::nextChunk() {
+    reclaim();
+
+    size_t chunk = chunkCount;
+    if (!freeChunks.empty()) {
+        chunk = freeChunks.back();
+        freeChunks.pop_back();
+    } else {
+        chunkCount += 1;
+    }
+
+    frameChunks.push_back(chunk);
+    return chunk;
+}
+
+void ChunkRing::reclaim() {
+    std::uint64_t completed = fence.getCompletedValue();
+
+    // only a few frames are ever in flight, shifting the vector is cheaper than a deque
+    // and never allocates once the ring has warmed up
+    size_t count = 0;
+    while (count < retired.size() && retired[count].value <= completed) {
+        freeChunks.push_back(retired[count].chunk);
+        count += 1;
+    }
+
+    retired.erase(retired.begin(), retired.begin() + ptrdiff_t(count));
+}
@@ -0,0 +1,170 @@
+#include "simcoe/memory/tracking.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+const char *memory::getTagName(Tag tag) {
+    switch (tag) {
+    case eUntagged: return "untagged";
+    case eRender: return "render";
+    case eAssets: return "assets";
+    case eInput: return "input";
+    case eLogging: return "logging";
+    case eImGui: return "imgui";
+    default: return "unknown";
+    }
+}
+
+#if SIMCOE_ALLOC_TRACKING
+
+namespace {
+    struct alignas(64) Counters {
+        std::atomic_size_t live;
+        std::atomic_size_t peak;
+        std::atomic_size_t allocs;
+        std::atomic_size_t frees;
+    };
+
+    // stored directly in front of every allocation
+    struct Header {
+        void *pBase;
+        size_t size;
+        Tag tag;
+    };
+
+    struct ThreadState {
+        Tag tag = eUntagged;
+        const char *pzZeroAlloc = nullptr;
+    };
+
+    constinit Counters gCounters[eTagCount] = {};
+    constinit thread_local ThreadState tlsState = {};
+
+    void *trackedAlloc(size_t size, size_t align) {
+        if (const char *pzScope = tlsState.pzZeroAlloc; pzScope != nullptr) {
+            // the panic handler is allowed to allocate
+            tlsState.pzZeroAlloc = nullptr;
+            PANIC("allocated {} bytes inside zero allocation scope {}", size, pzScope);
+        }
+
+        align = std::max(align, alignof(Header));
+
+        void *pBase = std::malloc(size + align + sizeof(Header));
+        if (pBase == nullptr) {
+            // cant report through PANIC, formatting needs memory we dont have
+            std::abort();
+        }
+
+        uintptr_t address = (uintptr_t(pBase) + sizeof(Header) + align - 1) & ~uintptr_t(align - 1);
+        Header *pHeader = reinterpret_cast<Header*>(address) - 1;
+        *pHeader = { pBase, size, tlsState.tag };
+
+        Counters& counters = gCounters[pHeader->tag];
+        size_t live = counters.live.fetch_add(size, std::memory_order_relaxed) + size;
+        counters.allocs.fetch_add(1, std::memory_order_relaxed);
+
+        size_t peak = counters.peak.load(std::memory_order_relaxed);
+        while (live > peak && !counters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) { }
+
+        return reinterpret_cast<void*>(address);
+    }
+
+    void trackedFree(void *ptr) {
+        if (ptr == nullptr) { return; }
+
+        Header *pHeader = static_cast<Header*>(ptr) - 1;
+
+        // frees count against the tag that allocated so live bytes stay balanced
+        Counters& counters = gCounters[pHeader->tag];
+        counters.live.fetch_sub(pHeader->size, std::memory_order_relaxed);
+        counters.frees.fetch_add(1, std::memory_order_relaxed);
+
+        std::free(pHeader->pBase);
+    }
+}
+
+TagStats memory::getTagStats(Tag tag) {
+    const Counters& counters = gCounters[tag];
+
+    return TagStats {
+        .live = counters.live.load(std::memory_order_relaxed),
+        .peak = counters.peak.load(std::memory_order_relaxed),
+        .allocs = counters.allocs.load(std::memory_order_relaxed),
+        .frees = counters.frees.load(std::memory_order_relaxed)
+    };
+}
+
+TagScope::TagScope(Tag tag)
+    : previous(tlsState.tag)
+{
+    tlsState.tag = tag;
+}
+
+TagScope::~TagScope() {
+    tlsState.tag = previous;
+}
+
+ZeroAllocScope::ZeroAllocScope(const char *pzName, bool enabled)
+    : pzPrevious(tlsState.pzZeroAlloc)
+{
+    if (enabled) {
+        tlsState.pzZeroAlloc = pzName;
+    }
+}
+
+ZeroAllocScope::~ZeroAllocScope() {
+    tlsState.pzZeroAlloc = pzPrevious;
+}
+
+AllowAllocScope::AllowAllocScope()
+    : pzPrevious(tlsState.pzZeroAlloc)
+{
+    tlsState.pzZeroAlloc = nullptr;
+}
+
+AllowAllocScope::~AllowAllocScope() {
+    tlsState.pzZeroAlloc = pzPrevious;
+}
+
+///
+/// global allocation hooks
+///
+
+void *operator new(size_t size) { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new[](size_t size) { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new(size_t size, std::align_val_t align) { return trackedAlloc(size, size_t(align)); }
+void *operator new[](size_t size, std::align_val_t align) { return trackedAlloc(size, size_t(align)); }
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return trackedAlloc(size, size_t(align)); }
+void *operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return trackedAlloc(size, size_t(align)); }
+
+void operator delete(void *ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+
+#else
+
+TagStats memory::getTagStats(Tag) {
+    return TagStats { };
+}
+
+#endif
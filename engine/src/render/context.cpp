@@ -1,11 +1,22 @@
 #include "simcoe/render/context.h"
 #include "dx/d3d12.h"
+#include "simcoe/core/metrics.h"
+#include "simcoe/core/trace.h"
 #include "simcoe/core/util.h"
+#include "simcoe/memory/tracking.h"
+#include "simcoe/threads/mutex.h"
 
 using namespace simcoe;
 using namespace simcoe::render;
 
 namespace {
+    metrics::Histogram gFenceWait { "render.fence_wait_us" };
+    metrics::Counter gFrames { "render.frames" };
+
+    // used against size gives cbv heap occupancy
+    metrics::Gauge gCbvHeapUsed { "render.cbv_heap.used" };
+    metrics::Gauge gCbvHeapSize { "render.cbv_heap.size" };
+
     const char *severityToString(D3D12_MESSAGE_SEVERITY severity) {
         switch (severity) {
         case D3D12_MESSAGE_SEVERITY_CORRUPTION: return "CORRUPTION";
@@ -41,28 +52,97 @@ namespace {
 
 void Fence::newFence(ID3D12Device *pDevice, const char *pzName) {
     HR_CHECK(pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&pFence)));
-    hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (hEvent == nullptr) {
-        HR_CHECK(HRESULT_FROM_WIN32(GetLastError()));
-    }
-
     pFence->SetName(util::widen(std::format("{}-fence", pzName)).c_str());
 }
 
 void Fence::deleteFence() {
-    CloseHandle(hEvent);
     RELEASE(pFence);
 }
 
 void Fence::wait(CommandQueue& queue) {
+    auto begin = std::chrono::steady_clock::now();
+
     HR_CHECK(queue.pQueue->Signal(pFence, value));
 
-    if (pFence->GetCompletedValue() < value) {
-        HR_CHECK(pFence->SetEventOnCompletion(value, hEvent));
-        WaitForSingleObject(hEvent, INFINITE);
+    // the gpu is often nearly done by the time we get here, so poll a little before blocking.
+    // a null event makes SetEventOnCompletion block until the fence is reached
+    bool reached = threads::spinUntil([&] { return pFence->GetCompletedValue() >= value; });
+    if (!reached) {
+        HR_CHECK(pFence->SetEventOnCompletion(value, nullptr));
     }
 
     value += 1;
+
+    auto waited = std::chrono::steady_clock::now() - begin;
+    gFenceWait.record(uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(waited).count()));
+}
+
+std::uint64_t Fence::getCompletedValue() const {
+    return pFence->GetCompletedValue();
+}
+
+///
+/// resource heap api
+///
+
+void ResourceHeap::newResourceHeap(ID3D12Device *pDevice, D3D12_HEAP_TYPE type, D3D12_HEAP_FLAGS flags, size_t size, const char *pzName) {
+    D3D12_HEAP_DESC desc = {
+        .SizeInBytes = size,
+        .Properties = CD3DX12_HEAP_PROPERTIES(type),
+        .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+        .Flags = flags
+    };
+
+    HR_CHECK(pDevice->CreateHeap(&desc, IID_PPV_ARGS(&pHeap)));
+    pHeap->SetName(util::widen(std::format("{}-heap", pzName)).c_str());
+
+    this->pDevice = pDevice;
+
+    // placed resources are at least 64k aligned so thats the smallest useful unit
+    pAllocator = std::make_unique<memory::OffsetAllocator>(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+}
+
+void ResourceHeap::deleteResourceHeap() {
+    pAllocator.reset();
+    RELEASE(pHeap);
+}
+
+ID3D12Resource *ResourceHeap::newResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state, const D3D12_CLEAR_VALUE *pClear, Index& index) {
+    D3D12_RESOURCE_ALLOCATION_INFO info = pDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+    memory::OffsetAllocator::Allocation allocation;
+
+    {
+        std::lock_guard guard(lock);
+        allocation = pAllocator->alloc(info.SizeInBytes, info.Alignment);
+    }
+
+    if (allocation.index == Index::eInvalid) {
+        return nullptr;
+    }
+
+    ID3D12Resource *pResource = nullptr;
+    HR_CHECK(pDevice->CreatePlacedResource(
+        pHeap,
+        allocation.offset,
+        &desc,
+        state,
+        pClear,
+        IID_PPV_ARGS(&pResource)
+    ));
+
+    index = allocation.index;
+    return pResource;
+}
+
+void ResourceHeap::deleteResource(Index index) {
+    std::lock_guard guard(lock);
+    pAllocator->release(index);
+}
+
+memory::OffsetAllocator::Stats ResourceHeap::getStats() {
+    std::lock_guard guard(lock);
+    return pAllocator->getStats();
 }
 
 ///
@@ -122,6 +202,25 @@ ID3D12Resource *Context::newBuffer(
 )
 {
     D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    switch (pProps->Type) {
+    case D3D12_HEAP_TYPE_UPLOAD:
+        // placed resources in upload heaps must start in generic read
+        if (auto *pResource = newPlacedResource(uploadHeap, desc, D3D12_RESOURCE_STATE_GENERIC_READ)) {
+            return pResource;
+        }
+        break;
+
+    case D3D12_HEAP_TYPE_DEFAULT:
+        if (auto *pResource = newPlacedResource(bufferHeap, desc, state)) {
+            return pResource;
+        }
+        break;
+
+    default:
+        break;
+    }
+
     ID3D12Resource *pResource = nullptr;
     HR_CHECK(pDevice->CreateCommittedResource(
         pProps,
@@ -135,6 +234,60 @@ ID3D12Resource *Context::newBuffer(
     return pResource;
 }
 
+ID3D12Resource *Context::newTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state) {
+    ASSERT(!(desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)));
+
+    if (auto *pResource = newPlacedResource(textureHeap, desc, state)) {
+        return pResource;
+    }
+
+    const D3D12_HEAP_PROPERTIES props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+
+    ID3D12Resource *pResource = nullptr;
+    HR_CHECK(pDevice->CreateCommittedResource(
+        &props,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        state,
+        nullptr,
+        IID_PPV_ARGS(&pResource)
+    ));
+
+    return pResource;
+}
+
+void Context::deleteResource(ID3D12Resource *pResource) {
+    if (pResource == nullptr) { return; }
+
+    {
+        std::lock_guard guard(placementLock);
+        if (auto it = placements.find(pResource); it != placements.end()) {
+            auto [pHeap, index] = it->second;
+            placements.erase(it);
+            pHeap->deleteResource(index);
+        }
+    }
+
+    pResource->Release();
+}
+
+ID3D12Resource *Context::newPlacedResource(ResourceHeap& heap, const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state) {
+    ResourceHeap::Index index = ResourceHeap::Index::eInvalid;
+    ID3D12Resource *pResource = heap.newResource(desc, state, nullptr, index);
+
+    if (pResource == nullptr) {
+        reportHeapExhausted([&] { gRenderLog.warn("resource heap exhausted, falling back to committed resources"); });
+        return nullptr;
+    }
+
+    // placements are keyed by the resource pointer, a stale entry here means a placed
+    // resource was released without going through deleteResource and its heap range leaked
+    std::lock_guard guard(placementLock);
+    auto [it, inserted] = placements.emplace(pResource, Placement { &heap, index });
+    ASSERTF(inserted, "placed resource {} is already tracked", (void*)pResource);
+    return pResource;
+}
+
 CommandBuffer Context::newCommandBuffer(D3D12_COMMAND_LIST_TYPE type, const char *pzName) {
     CommandBuffer buffer;
     buffer.newCommandBuffer(pDevice, type, pzName);
@@ -149,12 +302,40 @@ void Context::submitCopyCommands(CommandBuffer& buffer) {
     buffer.execute(copyQueue);
 }
 
+void Context::beginGpuTimer(ID3D12GraphicsCommandList *pCommands) {
+    pCommands->EndQuery(pTimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, eFrameBegin);
+}
+
+void Context::endGpuTimer(ID3D12GraphicsCommandList *pCommands) {
+    pCommands->EndQuery(pTimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, eFrameEnd);
+    pCommands->ResolveQueryData(pTimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0, eTimestampCount, pTimestampBuffer, 0);
+}
+
+Duration Context::getGpuTime() {
+    const D3D12_RANGE read = { 0, sizeof(UINT64) * eTimestampCount };
+    const D3D12_RANGE written = { 0, 0 };
+
+    UINT64 *pTimestamps = nullptr;
+    HR_CHECK(pTimestampBuffer->Map(0, &read, reinterpret_cast<void**>(&pTimestamps)));
+
+    UINT64 begin = pTimestamps[eFrameBegin];
+    UINT64 end = pTimestamps[eFrameEnd];
+
+    pTimestampBuffer->Unmap(0, &written);
+
+    if (end <= begin || timestampFrequency == 0) { return Duration::zero(); }
+
+    return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(double(end - begin) / double(timestampFrequency)));
+}
+
 Context::Context(os::Window &window, const Info& info)
     : window(window)
     , info(info)
     , rtvHeap(getRenderHeapSize())
-    , cbvHeap(info.heapSize)
+    , cbvHeap(info.heapSize, &gCbvHeapUsed)
     , dsvHeap(1)
+    , frameArena(info.frames, info.frameArenaSize)
+    , frameStats({ .window = info.frameStatsWindow })
 {
     newFactory();
     newDevice();
@@ -162,11 +343,17 @@ Context::Context(os::Window &window, const Info& info)
     newCommandQueues();
     newSwapChain();
     newHeaps();
+    newResourceHeaps();
     newFence();
+    newUploadRing();
+    newTimestamps();
 }
 
 Context::~Context() {
+    deleteTimestamps();
+    deleteUploadRing();
     deleteFence();
+    deleteResourceHeaps();
     deleteHeaps();
     deleteSwapChain();
     deleteCommandQueues();
@@ -176,8 +363,25 @@ Context::~Context() {
 }
 
 void Context::present() {
+    SIMCOE_ZONE("Context::present");
+
     HR_CHECK(pSwapChain->Present(0, bTearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0));
+
+    // constants written this frame are in use until the fence passes the value nextFrame signals
+    pUploadRing->retire(presentFence.value);
     nextFrame();
+
+    gFrames.add();
+
+    // the fence has passed so nothing from this frames last use is still in flight
+    if (frameArena.getOverflows() != arenaOverflows) {
+        arenaOverflows = frameArena.getOverflows();
+        reportArenaOverflow([&] { gRenderLog.warn("frame arena overflowed, consider increasing frameArenaSize"); });
+    }
+
+    frameArena.reset(frameIndex);
+
+    trace::frame();
 }
 
 void Context::newFactory() {
@@ -224,6 +428,9 @@ void Context::deleteDevice() {
 void Context::newInfoQueue() {
     if (HRESULT hr = pDevice->QueryInterface(IID_PPV_ARGS(&pInfoQueue)); SUCCEEDED(hr)) {
         D3D12MessageFunc pfn = [](D3D12_MESSAGE_CATEGORY category, D3D12_MESSAGE_SEVERITY severity, D3D12_MESSAGE_ID id, LPCSTR pDescription, void *pUser) {
+            // debug layer messages can arrive mid frame, reporting them may allocate
+            memory::AllowAllocScope allow;
+
             DoOnceGroup& once = *reinterpret_cast<DoOnceGroup*>(pUser);
 
             once(id, [&]{
@@ -337,14 +544,41 @@ void Context::newHeaps() {
     rtvHeap.newHeap(pDevice, D3D12_DESCRIPTOR_HEAP_FLAG_NONE, D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     dsvHeap.newHeap(pDevice, D3D12_DESCRIPTOR_HEAP_FLAG_NONE, D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
     cbvHeap.newHeap(pDevice, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    gCbvHeapSize.add(int64_t(info.heapSize));
 }
 
 void Context::deleteHeaps() {
+    gCbvHeapSize.sub(int64_t(info.heapSize));
+
     rtvHeap.deleteHeap();
     dsvHeap.deleteHeap();
     cbvHeap.deleteHeap();
 }
 
+void Context::newResourceHeaps() {
+    uploadHeap.newResourceHeap(pDevice, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, info.uploadHeapSize, "context-upload");
+    bufferHeap.newResourceHeap(pDevice, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, info.bufferHeapSize, "context-buffer");
+    textureHeap.newResourceHeap(pDevice, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, info.textureHeapSize, "context-texture");
+}
+
+void Context::deleteResourceHeaps() {
+    auto report = [](const char *pzName, ResourceHeap& heap) {
+        auto stats = heap.getStats();
+        gRenderLog.info("{} heap: {} peak of {}, {} live allocations, {:.1f}% fragmented",
+            pzName, stats.peak.string(), stats.size.string(), stats.allocations, stats.fragmentation * 100.f
+        );
+    };
+
+    report("upload", uploadHeap);
+    report("buffer", bufferHeap);
+    report("texture", textureHeap);
+
+    textureHeap.deleteResourceHeap();
+    bufferHeap.deleteResourceHeap();
+    uploadHeap.deleteResourceHeap();
+}
+
 void Context::newFence() {
     presentFence.newFence(pDevice, "context");
 
@@ -355,11 +589,53 @@ void Context::deleteFence() {
     presentFence.deleteFence();
 }
 
+void Context::newUploadRing() {
+    pUploadRing = std::make_unique<UploadRing>(*this, presentFence, info.uploadChunkSize);
+}
+
+void Context::deleteUploadRing() {
+    pUploadRing.reset();
+}
+
+void Context::newTimestamps() {
+    const D3D12_QUERY_HEAP_DESC desc = {
+        .Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+        .Count = eTimestampCount
+    };
+
+    HR_CHECK(pDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(&pTimestampHeap)));
+    pTimestampHeap->SetName(L"timestamp-heap");
+
+    const D3D12_HEAP_PROPERTIES props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+    const D3D12_RESOURCE_DESC buffer = CD3DX12_RESOURCE_DESC::Buffer(sizeof(UINT64) * eTimestampCount);
+
+    HR_CHECK(pDevice->CreateCommittedResource(
+        &props,
+        D3D12_HEAP_FLAG_NONE,
+        &buffer,
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(&pTimestampBuffer)
+    ));
+
+    pTimestampBuffer->SetName(L"timestamp-readback");
+
+    HR_CHECK(directQueue.pQueue->GetTimestampFrequency(&timestampFrequency));
+}
+
+void Context::deleteTimestamps() {
+    RELEASE(pTimestampBuffer);
+    RELEASE(pTimestampHeap);
+}
+
 void Context::waitForFence() {
     presentFence.wait(directQueue);
 }
 
 void Context::nextFrame() {
+    // waits on the gpu, usually the biggest zone in a gpu bound frame
+    SIMCOE_ZONE("Context::nextFrame");
+
     frameIndex = pSwapChain->GetCurrentBackBufferIndex();
 
     presentFence.wait(directQueue);
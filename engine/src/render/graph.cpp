@@ -1,10 +1,19 @@
 #include "simcoe/render/graph.h"
 #include "dx/d3d12.h"
 
+#include "simcoe/core/trace.h"
+
+#include "simcoe/memory/tracking.h"
+
 using namespace simcoe;
 using namespace simcoe::render;
 
+metrics::Counter render::gDrawCalls { "render.draw_calls" };
+
 namespace {
+    metrics::Counter gPasses { "render.passes" };
+    metrics::Counter gBarriers { "render.barriers" };
+
     std::string edgeName(InEdge *pEdge) {
         return std::format("in:{}:{}", pEdge->getPass()->getName(), pEdge->getName());
     }
@@ -14,7 +23,7 @@ namespace {
     }
 }
 
-GraphObject::GraphObject(const std::string& name, Graph& graph)
+GraphObject::GraphObject(util::Name name, Graph& graph)
     : name(name)
     , graph(graph)
 { }
@@ -23,8 +32,8 @@ GraphObject::GraphObject(const GraphObject& other)
     : GraphObject(other.name, other.graph)
 { }
 
-const char *GraphObject::getName() const {
-    return name.c_str();
+util::Name GraphObject::getName() const {
+    return name;
 }
 
 Graph& GraphObject::getGraph() const {
@@ -85,27 +94,39 @@ Graph::Graph(Context& context)
 { }
 
 struct PassTree final {
-    PassTree(Pass *pRoot)
-        : pPass(pRoot) 
+    PassTree(Pass *pRoot, memory::FrameArena& arena)
+        : pPass(pRoot)
+        , children(arena)
     { }
 
     void add(PassTree&& child) { children.push_back(std::move(child)); }
 
     Pass *pPass;
-    std::vector<PassTree> children;
+
+    // PassTree is incomplete here so it cant be stored inline in a SmallVector
+    memory::ArenaVector<PassTree> children;
 };
 
 struct GraphBuilder final {
-    GraphBuilder(Graph& graph, Pass *pRoot, ID3D12GraphicsCommandList* pCommands) : graph(graph) { 
+    GraphBuilder(Graph& graph, Graph::VisitedSet& visited, Pass *pRoot, ID3D12GraphicsCommandList* pCommands)
+        : arena(graph.getContext().getFrameArena())
+        , visited(visited)
+        , graph(graph)
+    { 
+        SIMCOE_ZONE("GraphBuilder");
+
+        visited.clear();
         run(build(pRoot), pCommands);
     }
 
 private:
+
     PassTree build(Pass *pRoot) {
         ASSERT(pRoot != nullptr);
-        PassTree tree(pRoot);
+        PassTree tree(pRoot, arena);
 
-        auto edges = graph.getEdges();
+        const auto& edges = graph.getEdges();
+        tree.children.reserve(pRoot->getInputs().size());
 
         for (auto& input : pRoot->getInputs()) {
             ASSERTF(edges.contains(input.get()), "edge {} was not found", edgeName(input.get()));
@@ -118,8 +139,8 @@ private:
     }
 
     void wireBarriers(Pass *pPass, ID3D12GraphicsCommandList *pCommands) {
-        std::vector<D3D12_RESOURCE_BARRIER> barriers;
-        
+        memory::SmallVector<D3D12_RESOURCE_BARRIER, 8> barriers;
+
         // for each input edge
         for (auto& dest : pPass->getInputs()) {
             // find the source of the input
@@ -137,6 +158,8 @@ private:
         }
 
         if (!barriers.empty()) {
+            gBarriers.add(barriers.size());
+
             pCommands->ResourceBarrier(
                 /* NumBarriers = */ UINT(barriers.size()),
                 /* pBarriers = */ barriers.data()
@@ -146,7 +169,7 @@ private:
 
     void run(const PassTree& tree, ID3D12GraphicsCommandList* pCommands) {
         auto& [pPass, deps] = tree;
-        if (visited[pPass].test_and_set()) {
+        if (!visited.insert(pPass).second) {
             return;
         }
 
@@ -154,12 +177,17 @@ private:
             run(dep, pCommands);
         }
 
+        // pass names are interned so they outlive the trace
+        SIMCOE_ZONE(pPass->getName().c_str());
+
         wireBarriers(pPass, pCommands);
 
         pPass->execute(pCommands);
+        gPasses.add();
     }
 
-    std::unordered_map<Pass*, std::atomic_flag> visited;
+    memory::FrameArena& arena;
+    Graph::VisitedSet& visited;
     Graph& graph;
 };
 
@@ -173,7 +201,7 @@ void Graph::connect(OutEdge *pSource, InEdge *pTarget) {
 void Graph::start() {
     commands = context.newCommandBuffer(D3D12_COMMAND_LIST_TYPE_DIRECT);
     
-    for (auto& [pzName, pPass] : passes) {
+    for (auto& [name, pPass] : passes) {
         pPass->start(commands.pCommandList);
     }
 
@@ -181,19 +209,37 @@ void Graph::start() {
 }
 
 void Graph::stop() {
-    for (auto& [pzName, pPass] : passes) {
+    for (auto& [name, pPass] : passes) {
         pPass->stop();
     }
 }
 
 void Graph::execute(Pass *pRoot) {
+    SIMCOE_ZONE("Graph::execute");
+    memory::TagScope tag(memory::eRender);
+
     // TODO: track effects somehow
     ID3D12DescriptorHeap *ppHeaps[] = { context.getCbvHeap().getHeap() };
     commands.pCommandList->SetDescriptorHeaps(UINT(std::size(ppHeaps)), ppHeaps);
 
-    GraphBuilder graph{*this, pRoot, commands.pCommandList};
+    auto begin = std::chrono::steady_clock::now();
+    context.beginGpuTimer(commands.pCommandList);
+
+    GraphBuilder graph{*this, visited, pRoot, commands.pCommandList};
+
+    context.endGpuTimer(commands.pCommandList);
+    auto recorded = std::chrono::steady_clock::now();
+
+    // submitting waits for the commands to finish so the timestamps are ready after
     context.submitDirectCommands(commands);
     context.present();
+    auto presented = std::chrono::steady_clock::now();
+
+    context.getFrameStats().add({
+        .cpu = recorded - begin,
+        .presentWait = presented - recorded,
+        .gpu = context.getGpuTime()
+    });
 }
 
 Context& Graph::getContext() const {
@@ -4,8 +4,9 @@
 using namespace simcoe;
 using namespace simcoe::render;
 
-Heap::Heap(size_t size) 
+Heap::Heap(size_t size, metrics::Gauge *pUsed)
     : map(size)
+    , pUsed(pUsed)
 { }
 
 void Heap::newHeap(ID3D12Device *pDevice, D3D12_DESCRIPTOR_HEAP_FLAGS flags, D3D12_DESCRIPTOR_HEAP_TYPE type) {
@@ -24,11 +25,31 @@ void Heap::deleteHeap() {
 }
 
 Heap::Index Heap::alloc() {
-    return map.alloc();
+    Index index = map.alloc();
+    track(index, 1);
+    return index;
 }
 
 void Heap::release(Index index) {
     map.release(index);
+    track(index, -1);
+}
+
+Heap::Index Heap::allocRange(size_t count) {
+    Index index = map.allocRange(count);
+    track(index, int64_t(count));
+    return index;
+}
+
+void Heap::releaseRange(Index index, size_t count) {
+    map.releaseRange(index, count);
+    track(index, -int64_t(count));
+}
+
+void Heap::track(Index index, int64_t count) {
+    if (pUsed == nullptr || index == Index::eInvalid) { return; }
+
+    pUsed->add(count);
 }
 
 Heap::CpuHandle Heap::cpuHandle() const {
@@ -0,0 +1,60 @@
+#include "simcoe/render/upload.h"
+#include "simcoe/render/context.h"
+
+#include "simcoe/core/metrics.h"
+
+using namespace simcoe;
+using namespace simcoe::render;
+
+namespace {
+    metrics::Counter gUploadBytes { "render.upload_bytes" };
+    metrics::Gauge gUploadChunks { "render.upload_chunks" };
+
+    const D3D12_HEAP_PROPERTIES kUploadProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+}
+
+UploadRing::UploadRing(Context& context, memory::IFence& fence, size_t chunkSize)
+    : context(context)
+    , ring(fence, chunkSize)
+{ }
+
+UploadRing::~UploadRing() {
+    for (auto& [pResource, pData, address] : chunks) {
+        pResource->Unmap(0, nullptr);
+        context.deleteResource(pResource);
+    }
+
+    gUploadChunks.sub(int64_t(chunks.size()));
+}
+
+UploadRing::Constant<void> UploadRing::allocate(size_t size, size_t align) {
+    auto [chunk, offset] = ring.alloc(size, align);
+
+    // the ring only grows by one chunk at a time
+    if (chunk == chunks.size()) {
+        newChunk();
+    }
+
+    gUploadBytes.add(size);
+
+    const auto& it = chunks[chunk];
+    return { it.pData + offset, it.address + offset };
+}
+
+void UploadRing::newChunk() {
+    ID3D12Resource *pResource = context.newBuffer(
+        ring.getChunkSize(),
+        &kUploadProps,
+        D3D12_RESOURCE_STATE_GENERIC_READ
+    );
+
+    // upload heaps can stay mapped for their whole lifetime
+    void *pData = nullptr;
+    D3D12_RANGE read = { 0, 0 };
+    HR_CHECK(pResource->Map(0, &read, &pData));
+
+    pResource->SetName(util::widen(std::format("upload-ring-chunk-{}", chunks.size())).c_str());
+
+    chunks.push_back({ pResource, static_cast<std::byte*>(pData), pResource->GetGPUVirtualAddress() });
+    gUploadChunks.add(1);
+}
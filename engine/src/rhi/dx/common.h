@@ -2,6 +2,7 @@
 
 #include "simcoe/rhi/rhi.h"
 #include "simcoe/core/system.h"
+#include "simcoe/memory/smallvector.h"
 
 #include "dx/d3d12.h"
 #include <dxgi1_6.h>
@@ -9,6 +10,7 @@
 
 namespace rhi = simcoe::rhi;
 namespace math = simcoe::math;
+namespace memory = simcoe::memory;
 
 #define RELEASE(p) do { if (p != nullptr) { p->Release(); p = nullptr; } } while (0)
 
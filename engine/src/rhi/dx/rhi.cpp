@@ -153,12 +153,15 @@ void DxCommandList::clearRenderTarget(rhi::CpuHandle handle, math::float4 colour
 }
 
 void DxCommandList::transition(std::span<const rhi::Barrier> barriers) {
-    std::vector<D3D12_RESOURCE_BARRIER> dxBarriers{barriers.size()};
-    for (size_t i = 0; i < barriers.size(); i++) {
-        dxBarriers[i] = createBarrier(barriers[i]);
+    // ResourceBarrier copies the barriers so they only need to live for the call
+    memory::SmallVector<D3D12_RESOURCE_BARRIER, 8> results;
+    results.reserve(barriers.size());
+
+    for (const auto& barrier : barriers) {
+        results.push_back(createBarrier(barrier));
     }
 
-    get()->ResourceBarrier(UINT(dxBarriers.size()), dxBarriers.data());
+    get()->ResourceBarrier(UINT(results.size()), results.data());
 }
 
 DxCommandList *DxCommandList::create(d3d::Device *pDevice, D3D12_COMMAND_LIST_TYPE type) {
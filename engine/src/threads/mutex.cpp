@@ -0,0 +1,100 @@
+#include "simcoe/threads/mutex.h"
+
+using namespace simcoe;
+using namespace simcoe::threads;
+
+#if SIMCOE_LOCK_STATS
+
+namespace {
+    constinit std::atomic_size_t gContended = 0;
+    constinit std::atomic_size_t gSpun = 0;
+    constinit std::atomic_size_t gParked = 0;
+}
+
+LockStats threads::getLockStats() {
+    return {
+        .contended = gContended.load(std::memory_order_relaxed),
+        .spun = gSpun.load(std::memory_order_relaxed),
+        .parked = gParked.load(std::memory_order_relaxed)
+    };
+}
+
+void detail::onContended() { gContended.fetch_add(1, std::memory_order_relaxed); }
+void detail::onSpun() { gSpun.fetch_add(1, std::memory_order_relaxed); }
+void detail::onParked() { gParked.fetch_add(1, std::memory_order_relaxed); }
+
+#else
+
+LockStats threads::getLockStats() { return { }; }
+
+void detail::onContended() { }
+void detail::onSpun() { }
+void detail::onParked() { }
+
+#endif
+
+///
+/// mutex, after "futexes are tricky" by ulrich drepper
+///
+
+void Mutex::lockSlow() {
+    detail::onContended();
+
+    bool acquired = spinUntil([&] {
+        uint32_t expected = eUnlocked;
+        return state.load(std::memory_order_relaxed) == eUnlocked
+            && state.compare_exchange_weak(expected, eLocked, std::memory_order_acquire, std::memory_order_relaxed);
+    });
+
+    if (acquired) {
+        detail::onSpun();
+        return;
+    }
+
+    // marking the lock contended makes the holder wake us on unlock.
+    // we may take it in the contended state with nobody asleep, which costs one spare wake
+    while (state.exchange(eContended, std::memory_order_acquire) != eUnlocked) {
+        detail::onParked();
+        state.wait(eContended, std::memory_order_relaxed);
+    }
+}
+
+///
+/// event
+///
+
+void Event::waitSlow() {
+    if (spinUntil([&] { return isSet(); })) {
+        return;
+    }
+
+    while (true) {
+        uint32_t current = state.load(std::memory_order_acquire);
+        if (current == eSet) { return; }
+
+        // tell set() someone needs waking before going to sleep
+        if (current == eClear && !state.compare_exchange_weak(current, eWaiting, std::memory_order_acquire, std::memory_order_acquire)) {
+            continue;
+        }
+
+        detail::onParked();
+        state.wait(eWaiting, std::memory_order_acquire);
+    }
+}
+
+///
+/// latch
+///
+
+void Latch::waitSlow() {
+    if (spinUntil([&] { return isDone(); })) {
+        return;
+    }
+
+    uint32_t current = count.load(std::memory_order_acquire);
+    while (current != 0) {
+        detail::onParked();
+        count.wait(current, std::memory_order_acquire);
+        current = count.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,234 @@
+#include "simcoe/threads/scheduler.h"
+
+#include "simcoe/core/panic.h"
+
+using namespace simcoe;
+using namespace simcoe::threads;
+
+using detail::Job;
+using detail::WorkDeque;
+
+namespace {
+    // how many times an idle worker looks for work before going to sleep
+    constexpr size_t kSpinCount = 64;
+
+    struct Participant {
+        const Scheduler *pScheduler = nullptr;
+        size_t index = 0;
+    };
+
+    thread_local Participant tlsParticipant;
+}
+
+///
+/// chase-lev deque, memory orders follow "correct and efficient work-stealing for weak memory models"
+///
+
+bool WorkDeque::push(Job *pJob) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+
+    if (b - t >= kCapacity) {
+        return false;
+    }
+
+    items[b & (kCapacity - 1)].store(pJob, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+Job *WorkDeque::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // already empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job *pJob = items[b & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // last item, race any thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            pJob = nullptr;
+        }
+
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return pJob;
+}
+
+Job *WorkDeque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Job *pJob = items[t & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+
+    return pJob;
+}
+
+bool WorkDeque::empty() const {
+    return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+}
+
+///
+/// scheduler
+///
+
+Scheduler::Scheduler(size_t count, const os::threads::Info& placement) {
+    deques.reserve(count + 1);
+    for (size_t i = 0; i < count + 1; i++) {
+        deques.push_back(std::make_unique<WorkDeque>());
+    }
+
+    tlsParticipant = { this, 0 };
+
+    workers.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back([this, i, placement] { workerMain(i + 1, placement); });
+    }
+}
+
+Scheduler::~Scheduler() {
+    running.store(false);
+    epoch.fetch_add(1);
+    epoch.notify_all();
+
+    // join before anything the workers touch is destroyed
+    workers.clear();
+
+    // anything still queued never ran, free it without running it
+    for (auto& pDeque : deques) {
+        while (Job *pJob = pDeque->pop()) { delete pJob; }
+    }
+
+    Job *pShared = nullptr;
+    while (shared.tryPop(pShared)) { delete pShared; }
+
+    if (tlsParticipant.pScheduler == this) {
+        tlsParticipant = { };
+    }
+}
+
+void Scheduler::wait(Counter& counter) {
+    size_t self = getCurrentIndex();
+
+    while (!counter.isDone()) {
+        if (Job *pJob = findJob(self)) {
+            execute(pJob);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Scheduler::enqueue(Job *pJob) {
+    if (Counter *pCounter = pJob->pCounter) {
+        pCounter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (size_t self = getCurrentIndex(); self != SIZE_MAX) {
+        // a full deque means there is already plenty of parallel work, just run it here
+        if (!deques[self]->push(pJob)) {
+            execute(pJob);
+            return;
+        }
+    } else {
+        shared.push(pJob);
+    }
+
+    // a worker that went to sleep after this either sees the new epoch or finds the job
+    epoch.fetch_add(1);
+    if (sleeping.load() > 0) {
+        epoch.notify_one();
+    }
+}
+
+void Scheduler::execute(Job *pJob) {
+    pJob->execute();
+
+    Counter *pCounter = pJob->pCounter;
+    delete pJob;
+
+    // the waiter may destroy the counter as soon as this lands, touch nothing after it
+    if (pCounter != nullptr) {
+        pCounter->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+Job *Scheduler::findJob(size_t self) {
+    size_t count = deques.size();
+
+    if (self != SIZE_MAX) {
+        if (Job *pJob = deques[self]->pop()) {
+            return pJob;
+        }
+    }
+
+    if (Job *pJob = nullptr; shared.tryPop(pJob)) {
+        return pJob;
+    }
+
+    // start with our neighbour so thieves spread out over the deques
+    size_t start = (self == SIZE_MAX) ? 0 : self + 1;
+    for (size_t i = 0; i < count; i++) {
+        size_t victim = (start + i) % count;
+        if (victim == self) { continue; }
+
+        if (Job *pJob = deques[victim]->steal()) {
+            return pJob;
+        }
+    }
+
+    return nullptr;
+}
+
+void Scheduler::workerMain(size_t index, const os::threads::Info& placement) {
+    tlsParticipant = { this, index };
+
+    // placement is only a hint, carry on wherever the os put us
+    os::threads::setup(os::threads::eWorker, placement, index);
+
+    while (running.load(std::memory_order_relaxed)) {
+        Job *pJob = nullptr;
+        for (size_t i = 0; i < kSpinCount && pJob == nullptr; i++) {
+            pJob = findJob(index);
+        }
+
+        if (pJob != nullptr) {
+            execute(pJob);
+            continue;
+        }
+
+        sleeping.fetch_add(1);
+        uint32_t current = epoch.load();
+
+        if (Job *pFound = findJob(index)) {
+            sleeping.fetch_sub(1);
+            execute(pFound);
+            continue;
+        }
+
+        if (running.load()) {
+            epoch.wait(current);
+        }
+
+        sleeping.fetch_sub(1);
+    }
+}
+
+size_t Scheduler::getCurrentIndex() const {
+    return tlsParticipant.pScheduler == this ? tlsParticipant.index : SIZE_MAX;
+}
@@ -29,6 +29,9 @@ namespace game {
         void move(float3 offset);
         void rotate(float yawUpdate, float pitchUpdate);
 
+        // point the camera at absolute angles, pitch is clamped
+        void setRotation(float newYaw, float newPitch);
+
         float3 direction;
         float pitch;
         float yaw;
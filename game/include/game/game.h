@@ -6,6 +6,11 @@
 #include "simcoe/core/system.h"
 
 #include "simcoe/core/logging.h"
+#include "simcoe/core/name.h"
+
+#include "simcoe/memory/flatmap.h"
+
+#include "simcoe/threads/mutex.h"
 
 #include "simcoe/input/desktop.h"
 #include "simcoe/input/gamepad.h"
@@ -17,6 +22,9 @@ namespace game {
     namespace os = simcoe::os;
     namespace logging = simcoe::logging;
     namespace assets = simcoe::assets;
+    namespace memory = simcoe::memory;
+    namespace util = simcoe::util;
+    namespace threads = simcoe::threads;
 
     struct Input {
         Input(input::Keyboard& keyboard, input::Mouse& mouse)
@@ -51,14 +59,25 @@ namespace game {
 
         struct Entry {
             logging::Level level;
-            const char *pzCategory;
+            util::Name category;
             std::string message;
         };
 
-        std::unordered_set<const char*> categories;
+        // messages arrive on the log writer thread while the render thread draws them
+        threads::Mutex lock;
+
+        memory::FlatSet<util::Name> categories;
         std::vector<Entry> entries;
     };
 
+    // snapshot of the game state for one frame, built by the game thread and drawn by the render thread.
+    // immutable once published
+    struct FramePacket {
+        size_t frame = 0;
+
+        float4x4 camera; // view projection of the active camera
+    };
+
     struct Info {
         os::Size windowResolution;
         os::Size renderResolution;
@@ -67,6 +86,8 @@ namespace game {
         assets::Manager& assets;
 
         GuiSink& sink;
-        game::ICamera *pCamera = nullptr;
+
+        // only valid on the render thread while the scene executes
+        const FramePacket *pFrame = nullptr;
     };
 }
@@ -1,14 +1,23 @@
 #pragma once
 
+#include "simcoe/core/name.h"
 #include "simcoe/core/util.h"
 
+#include "simcoe/threads/mutex.h"
+
+#include <mutex>
+
 namespace game {
     namespace util = simcoe::util;
 
     struct DebugGui {
-        const char *pzName;
+        util::Name name;
         bool enabled = true;
     };
 
     extern util::Registry<DebugGui> debug;
+
+    // imgui and anything a debug entry edits is shared between the game and render threads.
+    // the render thread holds this while it builds the ui, the game thread while it polls
+    extern simcoe::threads::Mutex guiLock;
 }
@@ -6,6 +6,8 @@
 #include "simcoe/render/context.h"
 #include "simcoe/render/graph.h"
 
+#include "simcoe/memory/slotmap.h"
+
 #include "imgui/imgui.h"
 #include "widgets/imfilebrowser.h"
 
@@ -144,7 +146,7 @@ namespace game {
     };
 
     struct ModelPass final : Pass, assets::IScene {
-        ModelPass(const GraphObject& object, Info& info, const std::filesystem::path& path);
+        ModelPass(const GraphObject& object, Info& info, ScenePass& scenePass, const std::filesystem::path& path);
 
         enum State {
             ePending,
@@ -184,10 +186,10 @@ namespace game {
         void renderNode(ID3D12GraphicsCommandList* cmd, size_t idx, const float4x4& parent);
 
         struct TextureHandle {
-            std::string name;
+            util::Name name;
             math::size2 size;
             ID3D12Resource *pResource = nullptr;
-            render::Heap::Index handle = render::Heap::Index::eInvalid;
+            size_t slot = SIZE_MAX; // in the scene texture table
         };
 
         struct IndexBuffer {
@@ -203,24 +205,27 @@ namespace game {
 
         struct Node {
             assets::Node asset;
-            ID3D12Resource *pResource = nullptr;
-            NodeBuffer *pNodeData = nullptr;
-            render::Heap::Index handle = render::Heap::Index::eInvalid;
         };
 
         std::atomic<State> state = ePending;
 
-        std::string name;
+        ScenePass& scene;
+        util::Name name;
         std::shared_ptr<assets::IUpload> upload;
         std::unique_ptr<util::Entry> debug;
 
         render::CommandBuffer copyCommands;
         render::CommandBuffer directCommands;
 
-        std::vector<assets::Primitive> primitives;
-        std::vector<Node> nodes;
+        // the ids handed back to the loader are slot map handles
+        using PrimitiveMap = memory::SlotMap<assets::Primitive>;
+        using NodeMap = memory::SlotMap<Node>;
+        using TextureMap = memory::SlotMap<TextureHandle>;
+
+        PrimitiveMap primitives;
+        NodeMap nodes;
+        TextureMap textures;
 
-        std::vector<TextureHandle> textures;
         std::vector<IndexBuffer> indices;
         std::vector<VertexBuffer> vertices;
 
@@ -229,15 +234,33 @@ namespace game {
 
     struct ScenePass final : Pass {
         ScenePass(const GraphObject& object, Info& info);
+        ~ScenePass() override;
+
         void start(ID3D12GraphicsCommandList *pCommands) override;
         void stop() override;
 
         void execute(ID3D12GraphicsCommandList *pCommands) override;
 
+        // slots in the texture table, shaders index it with the slot.
+        // models load on loader threads so this may be called from any thread.
+        // returns SIZE_MAX once the table is full. models are never unloaded
+        // so slots are held until the scene pass goes away
+        size_t newTextureSlot();
+
+        render::Heap::CpuHandle getTextureCpuHandle(size_t slot) const;
+        render::Heap::GpuHandle getTextureGpuHandle(size_t slot) const;
+
         IntermediateTargetEdge *pRenderTargetOut = nullptr;
 
         std::vector<ModelPass*> modelPasses;
     private:
+        // one contiguous run of descriptors, held for the life of the pass
+        // so textures already written survive the pass restarting
+        // sized by Context::Info::textureTableSize, t0[] in scene.hlsl is unbounded
+        size_t textureCount;
+        render::Heap::Index textureTable = render::Heap::Index::eInvalid;
+        simcoe::memory::AtomicBitMap textureSlots;
+
         ShaderBlob vs;
         ShaderBlob ps;
 
@@ -246,10 +269,6 @@ namespace game {
 
         ID3D12Resource *pDepthStencil = nullptr;
         render::Heap::Index depthHandle = render::Heap::Index::eInvalid;
-
-        ID3D12Resource *pSceneBuffer = nullptr;
-        SceneBuffer *pSceneData = nullptr;
-        render::Heap::Index sceneHandle = render::Heap::Index::eInvalid;
     };
 
     // copy resource to back buffer
@@ -324,8 +343,11 @@ namespace game {
     struct Scene final : render::Graph {
         Scene(render::Context& context, Info& info);
 
-        void execute() {
+        // called on the render thread, the packet must outlive the call
+        void execute(const FramePacket& frame) {
+            info.pFrame = &frame;
             Graph::execute(pPresentPass);
+            info.pFrame = nullptr;
         }
 
         void load(const std::filesystem::path& path);
@@ -334,7 +356,7 @@ namespace game {
 
     private:
         template<typename T, typename... A>
-        T *newPass(std::string name, A&&... args) {
+        T *newPass(util::Name name, A&&... args) {
             return Graph::addPass<T>(name, info, std::forward<A>(args)...);
         }
 
@@ -8,16 +8,52 @@
 #include "simcoe/math/math.h"
 #include "simcoe/simcoe.h"
 
+#include "simcoe/core/framestats.h"
+#include "simcoe/core/logwriter.h"
+#include "simcoe/core/loop.h"
+#include "simcoe/core/metrics.h"
+#include "simcoe/core/topology.h"
+#include "simcoe/core/trace.h"
+
 #include "simcoe/rhi/rhi.h"
 
+#include "simcoe/memory/tracking.h"
+
+#include "simcoe/threads/frames.h"
+#include "simcoe/threads/scheduler.h"
+
 #include "imgui/imgui.h"
 #include "imgui/backends/imgui_impl_win32.h"
 
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
 #include <filesystem>
+#include <thread>
 
 using namespace simcoe;
 using namespace simcoe::input;
 
+// how many frames the game thread may run ahead of the render thread
+constexpr size_t kFramesAhead = 2;
+
+// most players run without the privileges to raise thread priority, that is worth a note but not a warning
+void setupThread(os::threads::Role role, const os::threads::Info& info) {
+    const char *pzRole = os::threads::getRoleName(role);
+
+    switch (os::threads::setup(role, info)) {
+    case os::threads::Applied::eAll:
+        break;
+    case os::threads::Applied::eDenied:
+        gLog.info("{} thread is running at its default priority, raising it needs more privileges", pzRole);
+        break;
+    default:
+        gLog.warn("could not apply {} thread placement", pzRole);
+        break;
+    }
+}
+
 struct ImGuiRuntime final {
     ImGuiRuntime() {
         IMGUI_CHECKVERSION();
@@ -34,8 +70,13 @@ struct ImGuiRuntime final {
 };
 
 struct Camera final : input::ITarget {
+    // world units per second
+    static constexpr float kMoveSpeed = 60.f;
+
     Camera(game::Input& game, math::float3 position, float fov)
         : camera(position, { 0, 0, 1 }, fov)
+        , position(position)
+        , angles(math::float2::from(camera.yaw, camera.pitch))
         , input(game)
     {
         debug = game::debug.newEntry({ "Camera" }, [&] {
@@ -55,17 +96,41 @@ struct Camera final : input::ITarget {
         ImGui::SetNextFrameWantCaptureKeyboard(console);
         ImGui::SetNextFrameWantCaptureMouse(console);
 
-        if (console) { return; }
+        if (console) {
+            movement = { 0, 0, 0 };
+            return;
+        }
 
         float x = getAxis(state, Key::keyA, Key::keyD);
         float y = getAxis(state, Key::keyS, Key::keyW);
         float z = getAxis(state, Key::keyQ, Key::keyE);
 
-        float yaw = state.axis[Axis::mouseHorizontal] * 0.01f;
-        float pitch = -state.axis[Axis::mouseVertical] * 0.01f;
+        // held keys move at a fixed speed each tick, mouse motion is applied once
+        movement = { x, y, z };
+        yaw += state.axis[Axis::mouseHorizontal] * 0.01f;
+        pitch += -state.axis[Axis::mouseVertical] * 0.01f;
+    }
 
-        camera.move({ x, y, z });
+    void step(float dt) {
+        camera.move(movement * (kMoveSpeed * dt));
         camera.rotate(yaw, pitch);
+        yaw = 0.f;
+        pitch = 0.f;
+
+        position.update(camera.position);
+        angles.update(math::float2::from(camera.yaw, camera.pitch));
+    }
+
+    // blend between the last two ticks so motion stays smooth when frames and ticks don't line up
+    math::float4x4 getMatrix(float alpha, float aspectRatio) const {
+        game::FirstPerson view = camera;
+        view.position = position.get(alpha);
+
+        // yaw is never wrapped so a plain lerp never takes the long way round
+        math::float2 angle = angles.get(alpha);
+        view.setRotation(angle.x, angle.y);
+
+        return view.mvp(math::float4x4::identity(), aspectRatio);
     }
 
     void update(os::Window& window) {
@@ -73,8 +138,6 @@ struct Camera final : input::ITarget {
         window.hideCursor(!console);
     }
 
-    game::ICamera *getCamera() { return &camera; }
-
 private:
     constexpr float getAxis(const input::State& state, Key low, Key high) {
         if (state.key[low] == 0 && state.key[high] == 0) { return 0.f; }
@@ -82,15 +145,185 @@ private:
         return state.key[low] > state.key[high] ? -1.f : 1.f;
     }
 
-    os::Timer timer;
     input::Toggle console = false;
 
+    math::float3 movement = { 0, 0, 0 };
+    float yaw = 0.f;
+    float pitch = 0.f;
+
     game::FirstPerson camera;
+    Interpolated<math::float3> position;
+    Interpolated<math::float2> angles; // yaw, pitch
     game::Input& input;
 
     std::unique_ptr<util::Entry> debug;
 };
 
+struct MemoryDebug final {
+    MemoryDebug() {
+        debug = game::debug.newEntry({ "Memory" }, [&] {
+            if constexpr (!memory::kAllocTracking) {
+                ImGui::Text("Allocation tracking is compiled out");
+                return;
+            }
+
+            ImGui::Checkbox("Zero allocation frames", &zeroAllocFrames);
+
+            if (ImGui::BeginTable("tags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Tag");
+                ImGui::TableSetupColumn("Live");
+                ImGui::TableSetupColumn("Peak");
+                ImGui::TableSetupColumn("Allocs");
+                ImGui::TableSetupColumn("Frees");
+                ImGui::TableHeadersRow();
+
+                for (size_t i = 0; i < memory::eTagCount; i++) {
+                    auto tag = memory::Tag(i);
+                    auto [live, peak, allocs, frees] = memory::getTagStats(tag);
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", memory::getTagName(tag));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", live.string().c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", peak.string().c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%zu", allocs);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%zu", frees);
+                }
+
+                ImGui::EndTable();
+            }
+        });
+    }
+
+    // panic if the scene allocates while this is enabled
+    bool zeroAllocFrames = false;
+
+private:
+    std::unique_ptr<util::Entry> debug;
+};
+
+struct FrameStatsDebug final {
+    FrameStatsDebug(const FrameStats& frameStats)
+        : stats(frameStats)
+    {
+        debug = game::debug.newEntry({ "Frame times" }, [&] {
+            auto toMillis = [](Duration time) { return std::chrono::duration<double, std::milli>(time).count(); };
+
+            ImGui::Text("%zu of the last %zu frames", stats.getCount(), stats.getTotal());
+
+            if (ImGui::BeginTable("summary", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("ms");
+                ImGui::TableSetupColumn("p50");
+                ImGui::TableSetupColumn("p95");
+                ImGui::TableSetupColumn("p99");
+                ImGui::TableSetupColumn("max");
+                ImGui::TableHeadersRow();
+
+                for (size_t i = 0; i < FrameStats::eSeriesCount; i++) {
+                    auto series = FrameStats::Series(i);
+                    auto [p50, p95, p99, max] = stats.getSummary(series);
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", FrameStats::getSeriesName(series));
+
+                    for (Duration time : { p50, p95, p99, max }) {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.2f", toMillis(time));
+                    }
+                }
+
+                ImGui::EndTable();
+            }
+
+            ImGui::Combo("Histogram", &selected, "cpu\0present wait\0gpu\0");
+
+            // only plot the buckets between the fastest and slowest frame
+            const auto& histogram = stats.getHistogram(FrameStats::Series(selected));
+            auto first = std::find_if(histogram.begin(), histogram.end(), [](uint32_t count) { return count != 0; });
+            auto last = std::find_if(histogram.rbegin(), histogram.rend(), [](uint32_t count) { return count != 0; }).base();
+
+            if (first >= last) { return; }
+
+            std::array<float, FrameStats::kBucketCount> counts;
+            std::transform(first, last, counts.begin(), [](uint32_t count) { return float(count); });
+
+            size_t low = size_t(first - histogram.begin());
+            size_t high = size_t(last - histogram.begin());
+
+            ImGui::PlotHistogram("##histogram", counts.data(), int(high - low), 0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 120.f));
+            ImGui::Text("%.3f ms to %.3f ms, log scale", toMillis(FrameStats::getBucketStart(low)), toMillis(FrameStats::getBucketStart(high)));
+        });
+    }
+
+private:
+    const FrameStats& stats;
+    int selected = FrameStats::eCpu;
+
+    std::unique_ptr<util::Entry> debug;
+};
+
+struct TraceDebug final {
+    static constexpr const char *kTracePath = "simcoe.trace.json";
+
+    TraceDebug() {
+        debug = game::debug.newEntry({ "Trace" }, [&] {
+            if constexpr (!trace::kEnabled) {
+                ImGui::Text("Tracing is compiled out");
+                return;
+            }
+
+            bool recording = trace::isRecording();
+
+            // captures stop themselves on the render thread, save on the next draw after
+            if (pending && !recording) {
+                pending = false;
+
+                if (trace::save(kTracePath)) {
+                    gLog.info("saved trace to {}", kTracePath);
+                } else {
+                    gLog.warn("could not save trace to {}", kTracePath);
+                }
+            }
+
+            ImGui::BeginDisabled(recording);
+            ImGui::SliderInt("Frames", &frames, 1, 600);
+
+            if (ImGui::Button("Capture")) {
+                trace::capture(size_t(frames));
+                pending = true;
+            }
+
+            ImGui::SameLine();
+            if (ImGui::Button("Start")) {
+                trace::start();
+                pending = true;
+            }
+            ImGui::EndDisabled();
+
+            ImGui::SameLine();
+            ImGui::BeginDisabled(!recording);
+            if (ImGui::Button("Stop")) {
+                trace::stop();
+            }
+            ImGui::EndDisabled();
+
+            auto [threads, events, lost] = trace::getStats();
+            ImGui::Text("%zu zones from %zu threads, %zu lost", events, threads, lost);
+        });
+    }
+
+private:
+    int frames = 120;
+    bool pending = false;
+
+    std::unique_ptr<util::Entry> debug;
+};
+
 #if 0
 rhi::IContext *getRenderLibrary(const char *path) {
     HMODULE hModule = LoadLibrary(path);
@@ -209,7 +442,24 @@ void commonMain(os::System& system, int nCmdShow) {
     game::GuiSink guiSink{};
     simcoe::addSink(&guiSink);
 
-    assets::Manager assets = { "build\\game\\libgame.a.p" };
+    const os::threads::Info threadInfo = { };
+
+    // the binary log replaces the text file, decode it with logdecode
+    logging::BinarySink binaryLog { "simcoe.bin.log" };
+    simcoe::removeSink(&gFileSink);
+
+    // outlives every thread that logs, declared before them so it is destroyed after
+    logging::Writer logWriter {{ .threads = threadInfo }};
+
+    // writes a last sample on the way out, once everything else has stopped
+    metrics::Sampler metricsSampler {{ .threads = threadInfo }};
+
+    setupThread(os::threads::eMain, threadInfo);
+
+    const render::Context::Info renderInfo = { };
+    threads::Scheduler scheduler { renderInfo.workerThreads, threadInfo };
+
+    assets::Manager assets = { "build\\game\\libgame.a.p", scheduler };
     input::Mouse mouseInput = { false, true };
     input::Keyboard keyboardInput;
     game::GameEvents events = { keyboardInput };
@@ -239,6 +489,8 @@ void commonMain(os::System& system, int nCmdShow) {
 
     ImGuiRuntime imgui;
     Camera camera { input, { 0, 0, 50 }, 90.f };
+    MemoryDebug memoryDebug;
+    TraceDebug traceDebug;
 
     game::Info detail = {
         .windowResolution = window.getSize(),
@@ -247,22 +499,76 @@ void commonMain(os::System& system, int nCmdShow) {
         .input = input,
         .assets = assets,
 
-        .sink = guiSink,
-        .pCamera = camera.getCamera()
+        .sink = guiSink
     };
 
-    render::Context context { window, { } };
+    render::Context context { window, renderInfo };
     game::Scene scene { context, detail };
 
+    FrameStatsDebug frameStatsDebug { context.getFrameStats() };
+
     ImGui_ImplWin32_Init(window.getHandle());
     ImGui_ImplWin32_EnableDpiAwareness();
 
     scene.start();
 
-    while (system.poll()) {
+    threads::FrameQueue<game::FramePacket, kFramesAhead> frames;
+
+    // presenting blocks on the gpu, so drawing gets its own thread and the game thread runs ahead
+    std::jthread renderThread([&] {
+        setupThread(os::threads::eRender, threadInfo);
+
+        while (const game::FramePacket *pFrame = frames.beginRead()) {
+            memory::ZeroAllocScope noAlloc("scene", memoryDebug.zeroAllocFrames);
+            scene.execute(*pFrame);
+            frames.endRead();
+        }
+    });
+
+    float aspectRatio = detail.renderResolution.aspectRatio<float>();
+
+    SteadyClock clock;
+    GameLoop loop { { }, clock };
+
+    for (size_t frame = 0; true; frame++) {
+        // claim a slot first so the lock is never held while waiting on the render thread
+        game::FramePacket& packet = frames.beginWrite();
+
+        SIMCOE_ZONE("game frame");
+
+        std::lock_guard guard(game::guiLock);
+        if (!system.poll()) { break; }
+
         mouseInput.update(window.getHandle());
         input.poll();
-        scene.execute();
+
+        float alpha = loop.update([&](float dt) {
+            camera.step(dt);
+        });
+
+        packet.frame = frame;
+        packet.camera = camera.getMatrix(alpha, aspectRatio);
+
+        frames.endWrite();
+    }
+
+    frames.close();
+    renderThread.join();
+
+    const FrameStats& frameStats = context.getFrameStats();
+    for (size_t i = 0; i < FrameStats::eSeriesCount; i++) {
+        auto series = FrameStats::Series(i);
+        auto [p50, p95, p99, max] = frameStats.getSummary(series);
+        gLog.info("{} frame time: p50 {} p95 {} p99 {} max {}", FrameStats::getSeriesName(series),
+            std::chrono::duration_cast<std::chrono::microseconds>(p50),
+            std::chrono::duration_cast<std::chrono::microseconds>(p95),
+            std::chrono::duration_cast<std::chrono::microseconds>(p99),
+            std::chrono::duration_cast<std::chrono::microseconds>(max)
+        );
+    }
+
+    if (!frameStats.writeCsv("simcoe.frames.csv")) {
+        gLog.warn("could not write simcoe.frames.csv");
     }
 
     scene.stop();
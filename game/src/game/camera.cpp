@@ -33,8 +33,11 @@ void FirstPerson::move(float3 offset) {
 }
 
 void FirstPerson::rotate(float yawUpdate, float pitchUpdate) {
-    float newPitch = std::clamp(pitch + pitchUpdate, -kPitchLimit, kPitchLimit);
-    float newYaw = yaw - yawUpdate;
+    setRotation(yaw - yawUpdate, pitch + pitchUpdate);
+}
+
+void FirstPerson::setRotation(float newYaw, float newPitch) {
+    newPitch = std::clamp(newPitch, -kPitchLimit, kPitchLimit);
 
     float newRotation = std::cos(newPitch);
 
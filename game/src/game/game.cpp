@@ -3,6 +3,8 @@
 using namespace game;
 
 void GuiSink::send(logging::Category &category, logging::Level level, const char *pzMessage) {
+    std::lock_guard guard(lock);
+
     categories.insert(category.getName());
-    entries.push_back({level, category.getName(), pzMessage});
+    entries.push_back({ level, category.getName(), pzMessage });
 }
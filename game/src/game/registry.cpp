@@ -4,3 +4,4 @@
 using namespace simcoe;
 
 util::Registry<game::DebugGui> game::debug = {};
+threads::Mutex game::guiLock;
@@ -279,13 +279,13 @@ Scene::Scene(render::Context& context, Info& info)
 
             for (auto& output : pass->getOutputs()) {
                 ImNodes::BeginOutputAttribute(edgeIndices.at(output.get()));
-                ImGui::Text("%s", output->getName());
+                ImGui::Text("%s", output->getName().c_str());
                 ImNodes::EndOutputAttribute();
             }
 
             for (auto& input : pass->getInputs()) {
                 ImNodes::BeginInputAttribute(edgeIndices.at(input.get()));
-                ImGui::Text("%s", input->getName());
+                ImGui::Text("%s", input->getName().c_str());
                 ImNodes::EndInputAttribute();
             }
 
@@ -301,6 +301,6 @@ Scene::Scene(render::Context& context, Info& info)
 }
 
 void Scene::load(const std::filesystem::path& path) {
-    ModelPass *pModel = newPass<ModelPass>(path.filename().string(), path);
+    ModelPass *pModel = newPass<ModelPass>(path.filename().string(), *pScenePass, path);
     pScenePass->modelPasses.push_back(pModel);
 }
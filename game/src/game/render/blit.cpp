@@ -115,11 +115,16 @@ void BlitPass::start(ID3D12GraphicsCommandList*) {
 }
 
 void BlitPass::stop() {
+    auto& ctx = getContext();
+
     RELEASE(pBlitSignature);
     RELEASE(pBlitPipeline);
 
-    RELEASE(pVertexBuffer);
-    RELEASE(pIndexBuffer);
+    ctx.deleteResource(pVertexBuffer);
+    ctx.deleteResource(pIndexBuffer);
+
+    pVertexBuffer = nullptr;
+    pIndexBuffer = nullptr;
 }
 
 void BlitPass::execute(ID3D12GraphicsCommandList *pCommands) {
@@ -141,4 +146,5 @@ void BlitPass::execute(ID3D12GraphicsCommandList *pCommands) {
     pCommands->SetGraphicsRootDescriptorTable(0, pSceneTargetIn->gpuHandle(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
 
     pCommands->DrawIndexedInstanced(UINT(std::size(kScreenQuadIndices)), 1, 0, 0, 0);
+    render::gDrawCalls.add();
 }
@@ -3,6 +3,8 @@
 
 #include "microsoft/gdk.h"
 
+#include "simcoe/memory/tracking.h"
+
 #include "imgui/imgui.h"
 #include "imgui/imgui_internal.h"
 #include "imgui/backends/imgui_impl_win32.h"
@@ -23,6 +25,32 @@ namespace {
         default: return "unknown";
         }
     }
+
+    // per call site limits, a rate of 0 turns limiting off for the category
+    void drawRateLimit(logging::Category& category) {
+        ImGui::PushID(&category);
+
+        logging::RateLimit limit = category.getRateLimit();
+        int burst = int(limit.burst);
+
+        ImGui::Text("%s: %zu suppressed", category.getName().c_str(), category.getSuppressed());
+
+        bool changed = ImGui::SliderFloat("Per second", &limit.perSecond, 0.f, 100.f, "%.1f");
+        changed |= ImGui::SliderInt("Burst", &burst, 1, 100);
+
+        if (changed) {
+            limit.burst = uint32_t(burst);
+            category.setRateLimit(limit);
+        }
+
+        ImGui::PopID();
+    }
+
+    void drawHeapInfo(const char *pzName, render::ResourceHeap& heap) {
+        auto stats = heap.getStats();
+        ImGui::Text("%s: %s / %s (peak %s)", pzName, stats.used.string().c_str(), stats.size.string().c_str(), stats.peak.string().c_str());
+        ImGui::Text("  %zu allocations, %.1f%% fragmented", stats.allocations, stats.fragmentation * 100.f);
+    }
 }
 
 ImGuiPass::ImGuiPass(const GraphObject& object, Info& info)
@@ -56,6 +84,12 @@ void ImGuiPass::stop() {
 }
 
 void ImGuiPass::execute(ID3D12GraphicsCommandList *pCommands) {
+    // debug ui is exempt from zero allocation frames
+    memory::TagScope tag(memory::eImGui);
+    memory::AllowAllocScope allow;
+
+    std::lock_guard guard(game::guiLock);
+
     ImGui_ImplDX12_NewFrame();
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
@@ -71,7 +105,7 @@ void ImGuiPass::execute(ID3D12GraphicsCommandList *pCommands) {
             continue;
         }
 
-        if (ImGui::Begin(extra.pzName)) {
+        if (ImGui::Begin(extra.name.c_str())) {
             entry->apply();
         }
         ImGui::End();
@@ -181,10 +215,25 @@ void ImGuiPass::drawInfo() {
 
         ImGui::Text("GDK: %s", microsoft::gdk::enabled() ? "Enabled" : "Disabled");
 
+        ImGui::Separator();
+        drawHeapInfo("Upload heap", getContext().getUploadHeap());
+        drawHeapInfo("Buffer heap", getContext().getBufferHeap());
+        drawHeapInfo("Texture heap", getContext().getTextureHeap());
+
         ImGui::Separator();
         ImGui::Text("Logs");
 
+        if (ImGui::TreeNode("Rate limits")) {
+            for (logging::Category *pCategory : { &gLog, &gRenderLog, &gInputLog, &gAssetLog }) {
+                drawRateLimit(*pCategory);
+            }
+
+            ImGui::TreePop();
+        }
+
         if (ImGui::BeginChild("Scrolling", ImVec2(0.f, 0.f), true, ImGuiWindowFlags_AlwaysVerticalScrollbar | ImGuiWindowFlags_AlwaysHorizontalScrollbar)) {
+            std::lock_guard guard(info.sink.lock);
+
             ImGuiListClipper clipper;
             clipper.Begin(int(info.sink.entries.size()));
             while (clipper.Step()) {
@@ -18,8 +18,9 @@ namespace {
     }
 }
 
-ModelPass::ModelPass(const GraphObject& object, Info& info, const std::filesystem::path& path)
+ModelPass::ModelPass(const GraphObject& object, Info& info, ScenePass& scenePass, const std::filesystem::path& path)
     : Pass(object, info)
+    , scene(scenePass)
     , name(path.filename().string())
 {
     auto& ctx = getContext();
@@ -29,16 +30,13 @@ ModelPass::ModelPass(const GraphObject& object, Info& info, const std::filesyste
 
     upload = info.assets.gltf(path, *this);
 
-    debug = game::debug.newEntry({ name.c_str() }, [this] {
+    debug = game::debug.newEntry({ name }, [this] {
         ImGui::Text("State: %s", stateToString(state));
 
-        ImGui::Text("Nodes: %zu", nodes.size());
+        ImGui::Text("Nodes: %zu", nodes.getSize());
         ImGui::Text("Vertices: %zu", vertices.size());
         ImGui::Text("Indices: %zu", indices.size());
-        ImGui::Text("Textures: %zu", textures.size());
-
-        auto& ctx = getContext();
-        auto& cbvHeap = ctx.getCbvHeap();
+        ImGui::Text("Textures: %zu", textures.getSize());
 
         int root = int(rootNode);
         ImGui::InputInt("Root node", &root);
@@ -46,13 +44,13 @@ ModelPass::ModelPass(const GraphObject& object, Info& info, const std::filesyste
 
         if (ImGui::BeginTable("textures", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
             ImGui::TableNextRow();
-            for (const auto& [name, size, resource, handle] : textures) {
+            for (const auto& [name, size, resource, slot] : textures) {
                 ImGui::TableNextColumn();
                 auto windowAvail = ImGui::GetContentRegionAvail();
                 math::Resolution<float> res = { float(size.x), float(size.y) };
 
                 ImGui::Text("%s: %zu x %zu", name.c_str(), size.x, size.y);
-                ImGui::Image(ImTextureID(cbvHeap.gpuHandle(handle).ptr), ImVec2(windowAvail.x, res.aspectRatio<float>() * windowAvail.x));
+                ImGui::Image(ImTextureID(scene.getTextureGpuHandle(slot).ptr), ImVec2(windowAvail.x, res.aspectRatio<float>() * windowAvail.x));
             }
             ImGui::EndTable();
         }
@@ -68,30 +66,37 @@ void ModelPass::stop() {
 }
 
 void ModelPass::execute(ID3D12GraphicsCommandList* cmd) {
-    if (rootNode != SIZE_MAX) {
+    // the root can be typed in from the debug window, only draw it once it names a live node
+    if (nodes.test(NodeMap::Index(rootNode))) {
         renderNode(cmd, rootNode, float4x4::identity());
     }
 }
 
 void ModelPass::renderNode(ID3D12GraphicsCommandList* cmd, size_t idx, const float4x4& parent) {
-    const auto& node = nodes[idx];
+    const auto& node = nodes.get(NodeMap::Index(idx));
 
     float4x4 transform = parent * node.asset.transform;
-    node.pNodeData->transform = transform;
 
-    cmd->SetGraphicsRootConstantBufferView(3, node.pResource->GetGPUVirtualAddress());
+    auto constant = getContext().getUploadRing().allocate<NodeBuffer>();
+    constant.pData->transform = transform;
+
+    cmd->SetGraphicsRootConstantBufferView(3, constant.address);
 
     for (const auto& primitive : node.asset.primitives) {
-        const auto& prim = primitives[primitive];
+        const auto& prim = primitives.get(PrimitiveMap::Index(primitive));
         const auto& vertexBuffer = vertices[prim.vertexBuffer];
         const auto& indexBuffer = indices[prim.indexBuffer];
 
-        cmd->SetGraphicsRoot32BitConstant(2, UINT32(prim.texture), 0);
+        // models that failed to load any texture still point at the default texture 0
+        auto texture = TextureMap::Index(prim.texture);
+        UINT32 slot = textures.test(texture) ? UINT32(textures.get(texture).slot) : 0;
+        cmd->SetGraphicsRoot32BitConstant(2, slot, 0);
 
         cmd->IASetVertexBuffers(0, 1, &vertexBuffer.view);
         cmd->IASetIndexBuffer(&indexBuffer.view);
 
         cmd->DrawIndexedInstanced(UINT(indexBuffer.size), 1, 0, 0, 0);
+        render::gDrawCalls.add();
     }
 
     for (const auto& child : node.asset.children) {
@@ -107,33 +112,21 @@ size_t ModelPass::getDefaultTexture() {
 size_t ModelPass::addVertexBuffer(std::span<const assets::Vertex> buffer) {
     ASSERT(state == eWorking);
     auto& ctx = getContext();
-    auto pDevice = ctx.getDevice();
 
     auto direct = directCommands.pCommandList;
     auto copy = copyCommands.pCommandList;
 
-    ID3D12Resource *pStagingBuffer = nullptr;
-    ID3D12Resource *pVertexBuffer = nullptr;
-
-    D3D12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(buffer.size_bytes());
-
-    HR_CHECK(pDevice->CreateCommittedResource(
+    ID3D12Resource *pStagingBuffer = ctx.newBuffer(
+        buffer.size_bytes(),
         &kUploadProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&pStagingBuffer)
-    ));
-
-    HR_CHECK(pDevice->CreateCommittedResource(
+        D3D12_RESOURCE_STATE_GENERIC_READ
+    );
+
+    ID3D12Resource *pVertexBuffer = ctx.newBuffer(
+        buffer.size_bytes(),
         &kDefaultProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
-        D3D12_RESOURCE_STATE_COMMON,
-        nullptr,
-        IID_PPV_ARGS(&pVertexBuffer)
-    ));
+        D3D12_RESOURCE_STATE_COMMON
+    );
 
     void *pStagingData = nullptr;
     HR_CHECK(pStagingBuffer->Map(0, nullptr, &pStagingData));
@@ -159,6 +152,9 @@ size_t ModelPass::addVertexBuffer(std::span<const assets::Vertex> buffer) {
     ctx.submitCopyCommands(copyCommands);
     ctx.submitDirectCommands(directCommands);
 
+    // submitting waits for the copy so the staging buffer is free to reuse
+    ctx.deleteResource(pStagingBuffer);
+
     size_t result = vertices.size();
     vertices.push_back({ pVertexBuffer, bufferView });
 
@@ -168,33 +164,21 @@ size_t ModelPass::addVertexBuffer(std::span<const assets::Vertex> buffer) {
 size_t ModelPass::addIndexBuffer(std::span<const uint32_t> buffer) {
     ASSERT(state == eWorking);
     auto& ctx = getContext();
-    auto pDevice = ctx.getDevice();
 
     auto direct = directCommands.pCommandList;
     auto copy = copyCommands.pCommandList;
 
-    ID3D12Resource *pStagingBuffer = nullptr;
-    ID3D12Resource *pIndexBuffer = nullptr;
-
-    D3D12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(buffer.size_bytes());
-
-    HR_CHECK(pDevice->CreateCommittedResource(
+    ID3D12Resource *pStagingBuffer = ctx.newBuffer(
+        buffer.size_bytes(),
         &kUploadProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&pStagingBuffer)
-    ));
-
-    HR_CHECK(pDevice->CreateCommittedResource(
+        D3D12_RESOURCE_STATE_GENERIC_READ
+    );
+
+    ID3D12Resource *pIndexBuffer = ctx.newBuffer(
+        buffer.size_bytes(),
         &kDefaultProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
-        D3D12_RESOURCE_STATE_COMMON,
-        nullptr,
-        IID_PPV_ARGS(&pIndexBuffer)
-    ));
+        D3D12_RESOURCE_STATE_COMMON
+    );
 
     void *pStagingData = nullptr;
     HR_CHECK(pStagingBuffer->Map(0, nullptr, &pStagingData));
@@ -220,6 +204,9 @@ size_t ModelPass::addIndexBuffer(std::span<const uint32_t> buffer) {
     ctx.submitCopyCommands(copyCommands);
     ctx.submitDirectCommands(directCommands);
 
+    // submitting waits for the copy so the staging buffer is free to reuse
+    ctx.deleteResource(pStagingBuffer);
+
     size_t result = indices.size();
     indices.push_back({ pIndexBuffer, bufferView, UINT(buffer.size()) });
 
@@ -230,42 +217,34 @@ size_t ModelPass::addTexture(const assets::Texture& texture) {
     ASSERT(state == eWorking);
     const auto& [data, size] = texture;
 
+    // a scene with more textures than the table holds still loads, the rest draw with the default texture
+    size_t slot = scene.newTextureSlot();
+    if (slot == SIZE_MAX) {
+        gRenderLog.warn("scene texture table is full, {} ({}x{}) uses the default texture", name, size.x, size.y);
+        return getDefaultTexture();
+    }
+
     auto& ctx = getContext();
     auto pDevice = ctx.getDevice();
-    auto& cbvHeap = ctx.getCbvHeap();
 
     auto direct = directCommands.pCommandList;
     auto copy = copyCommands.pCommandList;
 
-    ID3D12Resource *pStagingTexture = nullptr;
-    ID3D12Resource *pTexture = nullptr;
-
     D3D12_RESOURCE_DESC textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(
         /* format = */ DXGI_FORMAT_R8G8B8A8_UNORM,
         /* width = */ UINT(size.x),
         /* height = */ UINT(size.y)
     );
 
-    HR_CHECK(pDevice->CreateCommittedResource(
-        &kDefaultProps,
-        D3D12_HEAP_FLAG_NONE,
-        &textureDesc,
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        nullptr,
-        IID_PPV_ARGS(&pTexture)
-    ));
+    ID3D12Resource *pTexture = ctx.newTexture(textureDesc, D3D12_RESOURCE_STATE_COPY_DEST);
 
     UINT64 uploadSize = GetRequiredIntermediateSize(pTexture, 0, 1);
-    D3D12_RESOURCE_DESC uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadSize);
 
-    HR_CHECK(pDevice->CreateCommittedResource(
+    ID3D12Resource *pStagingTexture = ctx.newBuffer(
+        uploadSize,
         &kUploadProps,
-        D3D12_HEAP_FLAG_NONE,
-        &uploadDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&pStagingTexture)
-    ));
+        D3D12_RESOURCE_STATE_GENERIC_READ
+    );
 
     D3D12_SUBRESOURCE_DATA subresourceData = {
         .pData = data,
@@ -277,9 +256,6 @@ size_t ModelPass::addTexture(const assets::Texture& texture) {
         pTexture, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
     );
 
-    auto handle = cbvHeap.alloc();
-    size_t result = textures.size();
-
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {
         .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
         .ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D,
@@ -291,18 +267,22 @@ size_t ModelPass::addTexture(const assets::Texture& texture) {
 
     direct->ResourceBarrier(1, &barrier);
 
-    pDevice->CreateShaderResourceView(pTexture, &srvDesc, cbvHeap.cpuHandle(handle));
+    pDevice->CreateShaderResourceView(pTexture, &srvDesc, scene.getTextureCpuHandle(slot));
 
     ctx.submitCopyCommands(copyCommands);
     ctx.submitDirectCommands(directCommands);
 
-    textures.push_back({
-        .name = std::format("texture {}", result),
+    ctx.deleteResource(pStagingTexture);
+
+    auto index = textures.alloc(TextureHandle {
+        .name = std::format("texture {}", textures.getSize()),
         .size = size,
         .pResource = pTexture,
-        .handle = handle
+        .slot = slot
     });
 
+    size_t result = size_t(index);
+
     gRenderLog.info("added texture {} ({}x{})", result, size.x, size.y);
 
     return result;
@@ -310,47 +290,16 @@ size_t ModelPass::addTexture(const assets::Texture& texture) {
 
 size_t ModelPass::addPrimitive(const assets::Primitive& primitive) {
     ASSERT(state == eWorking);
-    size_t result = primitives.size();
-    primitives.push_back(primitive);
-    return result;
+    return size_t(primitives.alloc(primitive));
 }
 
 size_t ModelPass::addNode(const assets::Node& node) {
     ASSERT(state == eWorking);
-    auto& ctx = getContext();
-    auto& cbvHeap = ctx.getCbvHeap();
-    auto pDevice = ctx.getDevice();
-
-    ID3D12Resource *pResource = ctx.newBuffer(
-        sizeof(NodeBuffer),
-        &kUploadProps,
-        D3D12_RESOURCE_STATE_GENERIC_READ
-    );
-
-    auto handle = cbvHeap.alloc();
-
-    Node it = {
-        .asset = node,
-        .pResource = pResource,
-        .handle = handle
-    };
-
-    HR_CHECK(pResource->Map(0, nullptr, (void**)&it.pNodeData));
-    it.pNodeData->transform = node.transform;
-
-    D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {
-        .BufferLocation = pResource->GetGPUVirtualAddress(),
-        .SizeInBytes = sizeof(NodeBuffer)
-    };
-
-    pDevice->CreateConstantBufferView(&cbvDesc, cbvHeap.cpuHandle(handle));
-
-    size_t result = nodes.size();
-    nodes.push_back(it);
-    return result;
+    return size_t(nodes.alloc(Node { .asset = node }));
 }
 
 void ModelPass::setNodeChildren(size_t idx, std::span<const size_t> children) {
     ASSERT(state == eWorking);
-    std::copy(children.begin(), children.end(), std::back_inserter(nodes[idx].asset.children));
+    auto& node = nodes.get(NodeMap::Index(idx));
+    std::copy(children.begin(), children.end(), std::back_inserter(node.asset.children));
 }
@@ -10,17 +10,44 @@ using namespace simcoe;
 using namespace simcoe::units;
 
 namespace {
-    const D3D12_HEAP_PROPERTIES kUploadProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
     const D3D12_HEAP_PROPERTIES kDefaultProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 }
 
 ScenePass::ScenePass(const GraphObject& object, Info& info)
     : Pass(object, info)
+    , textureCount(getContext().getInfo().textureTableSize)
+    , textureSlots(textureCount)
 {
     pRenderTargetOut = out<IntermediateTargetEdge>("scene-target", info.renderResolution);
 
     vs = info.assets.loadBlob<std::byte>("scene.vs.cso");
     ps = info.assets.loadBlob<std::byte>("scene.ps.cso");
+
+    textureTable = getContext().getCbvHeap().allocRange(textureCount);
+    ASSERTF(textureTable != render::Heap::Index::eInvalid, "no room for {} texture descriptors", textureCount);
+}
+
+ScenePass::~ScenePass() {
+    getContext().getCbvHeap().releaseRange(textureTable, textureCount);
+}
+
+size_t ScenePass::newTextureSlot() {
+    auto slot = textureSlots.alloc();
+    if (slot == memory::AtomicBitMap::Index::eInvalid) { return SIZE_MAX; }
+
+    return size_t(slot);
+}
+
+render::Heap::CpuHandle ScenePass::getTextureCpuHandle(size_t slot) const {
+    ASSERT(slot < textureCount);
+
+    return getContext().getCbvHeap().cpuHandle(render::Heap::Index(size_t(textureTable) + slot));
+}
+
+render::Heap::GpuHandle ScenePass::getTextureGpuHandle(size_t slot) const {
+    ASSERT(slot < textureCount);
+
+    return getContext().getCbvHeap().gpuHandle(render::Heap::Index(size_t(textureTable) + slot));
 }
 
 void ScenePass::start(ID3D12GraphicsCommandList*) {
@@ -28,13 +55,12 @@ void ScenePass::start(ID3D12GraphicsCommandList*) {
 
     auto& ctx = getContext();
     auto *pDevice = ctx.getDevice();
-    auto& cbvHeap = ctx.getCbvHeap();
     auto& dsvHeap = ctx.getDsvHeap();
 
     CD3DX12_STATIC_SAMPLER_DESC samplers[1];
     samplers[0].Init(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
 
-    CD3DX12_DESCRIPTOR_RANGE1 textureRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE);
+    CD3DX12_DESCRIPTOR_RANGE1 textureRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT(textureCount), 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE);
 
     CD3DX12_ROOT_PARAMETER1 rootParameters[4];
     // t0[] textures
@@ -88,17 +114,6 @@ void ScenePass::start(ID3D12GraphicsCommandList*) {
 
     HR_CHECK(pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pPipelineState)));
 
-    D3D12_RESOURCE_DESC cameraBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(SceneBuffer));
-
-    HR_CHECK(pDevice->CreateCommittedResource(
-        &kUploadProps,
-        D3D12_HEAP_FLAG_NONE,
-        &cameraBufferDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&pSceneBuffer)
-    ));
-
     // create depth stencil
     D3D12_RESOURCE_DESC depthStencilDesc = CD3DX12_RESOURCE_DESC::Tex2D(
         DXGI_FORMAT_D32_FLOAT,
@@ -122,25 +137,15 @@ void ScenePass::start(ID3D12GraphicsCommandList*) {
         IID_PPV_ARGS(&pDepthStencil)
     ));
 
-    sceneHandle = cbvHeap.alloc();
     depthHandle = dsvHeap.alloc();
 
-    D3D12_CONSTANT_BUFFER_VIEW_DESC bufferDesc = {
-        .BufferLocation = pSceneBuffer->GetGPUVirtualAddress(),
-        .SizeInBytes = sizeof(SceneBuffer)
-    };
-
     D3D12_DEPTH_STENCIL_VIEW_DESC stencilDesc = {
         .Format = DXGI_FORMAT_D32_FLOAT,
         .ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D,
         .Flags = D3D12_DSV_FLAG_NONE
     };
 
-    pDevice->CreateConstantBufferView(&bufferDesc, cbvHeap.cpuHandle(sceneHandle));
     pDevice->CreateDepthStencilView(pDepthStencil, &stencilDesc, dsvHeap.cpuHandle(depthHandle));
-
-    CD3DX12_RANGE read(0, 0);
-    HR_CHECK(pSceneBuffer->Map(0, &read, (void**)&pSceneData));
 }
 
 void ScenePass::stop() {
@@ -148,11 +153,6 @@ void ScenePass::stop() {
 
     ctx.getDsvHeap().release(depthHandle);
 
-    ctx.getCbvHeap().release(sceneHandle);
-    pSceneData = nullptr;
-    pSceneBuffer->Unmap(0, nullptr);
-    RELEASE(pSceneBuffer);
-
     RELEASE(pPipelineState);
     RELEASE(pRootSignature);
 
@@ -160,9 +160,10 @@ void ScenePass::stop() {
 }
 
 void ScenePass::execute(ID3D12GraphicsCommandList *pCommands) {
-    pSceneData->mvp = info.pCamera->mvp(float4x4::identity(), info.renderResolution.aspectRatio<float>());
-
     auto& ctx = getContext();
+
+    auto scene = ctx.getUploadRing().allocate<SceneBuffer>();
+    scene.pData->mvp = info.pFrame->camera;
     auto& cbvHeap = ctx.getCbvHeap();
     auto& dsvHeap = ctx.getDsvHeap();
 
@@ -181,8 +182,8 @@ void ScenePass::execute(ID3D12GraphicsCommandList *pCommands) {
     pCommands->ClearRenderTargetView(rtv, kClearColour, 0, nullptr);
     pCommands->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1.f, 0, 0, nullptr);
 
-    pCommands->SetGraphicsRootDescriptorTable(0, cbvHeap.gpuHandle());
-    pCommands->SetGraphicsRootConstantBufferView(1, pSceneBuffer->GetGPUVirtualAddress());
+    pCommands->SetGraphicsRootDescriptorTable(0, cbvHeap.gpuHandle(textureTable));
+    pCommands->SetGraphicsRootConstantBufferView(1, scene.address);
 
     pCommands->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
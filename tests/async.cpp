@@ -0,0 +1,255 @@
+#include "simcoe/async/generator.h"
+#include "simcoe/async/task.h"
+#include "simcoe/async/when.h"
+
+#include "simcoe/core/panic.h"
+#include "simcoe/memory/tracking.h"
+
+#include <atomic>
+#include <deque>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::async;
+
+namespace {
+    constexpr size_t kWorkers = 7;
+
+    // holds posted coroutines until the test resumes them, so completion order is up to the test
+    struct ManualExecutor final : IExecutor {
+        std::deque<std::coroutine_handle<>> pending;
+
+        void post(std::coroutine_handle<> handle) override {
+            pending.push_back(handle);
+        }
+
+        void runFront() {
+            auto handle = pending.front();
+            pending.pop_front();
+            handle.resume();
+        }
+
+        void runBack() {
+            auto handle = pending.back();
+            pending.pop_back();
+            handle.resume();
+        }
+    };
+
+    Task<int> answer() {
+        co_return 42;
+    }
+
+    Task<int> add(int lhs, int rhs) {
+        int a = co_await answer();
+        co_return a + lhs + rhs - 42;
+    }
+
+    Task<std::string> text(size_t depth) {
+        if (depth == 0) { co_return "x"; }
+
+        std::string inner = co_await text(depth - 1);
+        co_return inner + "x";
+    }
+
+    Task<> nothing(int& out) {
+        out = co_await add(1, 2);
+    }
+
+    void testTask() {
+        ASSERT(syncWait(answer()) == 42);
+        ASSERT(syncWait(add(3, 4)) == 7);
+
+        ASSERT(syncWait(text(1000)).size() == 1001);
+
+        int out = 0;
+        syncWait(nothing(out));
+        ASSERT(out == 3);
+
+        // a task that is never awaited never runs, destroying it frees the frame
+        bool ran = false;
+        {
+            auto task = [](bool& ran) -> Task<> { ran = true; co_return; }(ran);
+            ASSERT(!task.isReady());
+        }
+        ASSERT(!ran);
+
+        // awaiting an lvalue leaves the result in the task
+        auto outer = []() -> Task<int> {
+            auto inner = text(3);
+            const std::string& first = co_await inner;
+            co_return int(first.size());
+        };
+        ASSERT(syncWait(outer()) == 4);
+    }
+
+    Generator<size_t> count(size_t limit, bool& finished) {
+        for (size_t i = 0; i < limit; i++) {
+            co_yield i;
+        }
+
+        finished = true;
+    }
+
+    Generator<std::string> words() {
+        // yielding temporaries, the frame keeps them alive until the next step
+        co_yield std::string("one");
+        co_yield std::string("two");
+    }
+
+    void testGenerator() {
+        bool finished = false;
+        size_t sum = 0;
+        for (size_t i : count(100, finished)) {
+            sum += i;
+        }
+
+        ASSERT(sum == 4950);
+        ASSERT(finished);
+
+        // leaving early destroys the frame without running the rest of the body
+        finished = false;
+        for (size_t i : count(100, finished)) {
+            if (i == 10) { break; }
+        }
+
+        ASSERT(!finished);
+
+        std::string joined;
+        for (const auto& word : words()) {
+            joined += word;
+        }
+
+        ASSERT(joined == "onetwo");
+    }
+
+    Task<size_t> hop(IExecutor& executor, size_t value) {
+        co_await schedule(executor);
+        co_return value * 2;
+    }
+
+    Task<> hopVoid(IExecutor& executor, std::atomic_size_t& counter) {
+        co_await schedule(executor);
+        counter += 1;
+    }
+
+    void testWhenAll() {
+        threads::Scheduler scheduler(kWorkers);
+        SchedulerExecutor executor(scheduler);
+
+        for (size_t round = 0; round < 100; round++) {
+            std::vector<Task<size_t>> tasks;
+            for (size_t i = 0; i < 64; i++) {
+                tasks.push_back(hop(executor, i));
+            }
+
+            auto results = syncWait(when_all(std::move(tasks)));
+            ASSERT(results.size() == 64);
+            for (size_t i = 0; i < results.size(); i++) {
+                ASSERTF(results[i] == i * 2, "result {} was {}", i, results[i]);
+            }
+        }
+
+        std::atomic_size_t counter = 0;
+        auto [value, none, word] = syncWait(when_all(hop(executor, 21), hopVoid(executor, counter), text(2)));
+        ASSERT(value == 42);
+        ASSERT(counter == 1);
+        ASSERT(word == "xxx");
+
+        // children that finish before the awaiter has suspended
+        InlineExecutor inline_;
+        auto quick = syncWait(when_all(hop(inline_, 1), hop(inline_, 2)));
+        ASSERT(std::get<0>(quick) == 2 && std::get<1>(quick) == 4);
+
+        // an empty list resumes straight away
+        ASSERT(syncWait(when_all(std::vector<Task<int>>())).empty());
+    }
+
+    void testWhenAny() {
+        ManualExecutor manual;
+        std::vector<Task<size_t>> tasks;
+        for (size_t i = 0; i < 4; i++) {
+            tasks.push_back(hop(manual, i));
+        }
+
+        std::optional<AnyResult<size_t>> result;
+        auto wait = [&](std::vector<Task<size_t>> tasks) -> Task<> {
+            result = co_await when_any(std::move(tasks));
+        };
+
+        auto task = wait(std::move(tasks));
+        bool started = false;
+        // coroutine lambdas take what they use as parameters, captures die with the closure
+        spawn(manual, [](bool& started, Task<>& task) -> Task<> {
+            started = true;
+            co_await task;
+        }(started, task));
+
+        // the spawned task is queued first, then the four children
+        manual.runFront();
+        ASSERT(started);
+        ASSERT(manual.pending.size() == 4);
+
+        // the last child to be posted finishes first and wins
+        manual.runBack();
+        ASSERT(result.has_value());
+        ASSERT(result->index == 3 && result->value == 6);
+
+        // the losers still run to completion after the awaiter has moved on
+        while (!manual.pending.empty()) {
+            manual.runFront();
+        }
+
+        ASSERT(result->index == 3);
+    }
+
+    void testSpawn() {
+        constexpr uint32_t kTasks = 10'000;
+
+        // declared first so workers finishing their last arrive are joined before these go away
+        std::atomic_size_t counter = 0;
+        threads::Latch done(kTasks);
+
+        threads::Scheduler scheduler(kWorkers);
+        SchedulerExecutor executor(scheduler);
+
+        for (uint32_t i = 0; i < kTasks; i++) {
+            spawn(executor, [](std::atomic_size_t& counter, threads::Latch& done) -> Task<> {
+                counter += 1;
+                done.arrive();
+                co_return;
+            }(counter, done));
+        }
+
+        done.wait();
+        ASSERT(counter == kTasks);
+    }
+
+    // frames come from the object pool, once it has warmed up tasks never touch the global heap
+    void testPooledFrames() {
+        auto run = [] {
+            int sum = 0;
+            for (int i = 0; i < 1000; i++) {
+                sum += syncWait(add(i, 1));
+            }
+            return sum;
+        };
+
+        run();
+
+        memory::ZeroAllocScope scope("async frames");
+        ASSERT(run() == 500'500);
+    }
+}
+
+int main() {
+    testTask();
+    testGenerator();
+    testWhenAll();
+    testWhenAny();
+    testSpawn();
+    testPooledFrames();
+}
@@ -0,0 +1,156 @@
+#include "simcoe/core/logwriter.h"
+
+#include "simcoe/core/panic.h"
+
+#include "logdecode/decode.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    enum struct Filter { eNearest, eLinear };
+}
+
+// enums have no binary form, the sink formats them on the spot
+template<>
+struct std::formatter<Filter> : std::formatter<std::string_view> {
+    auto format(Filter filter, auto& ctx) const {
+        return std::formatter<std::string_view>::format(filter == Filter::eNearest ? "nearest" : "linear", ctx);
+    }
+};
+
+namespace {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kMessages = 20'000;
+
+    // the lines FileSink would have written
+    struct RecordingSink final : logging::IFilterSink {
+        RecordingSink() : IFilterSink("recording") { }
+
+        void accept(logging::Category& category, logging::Level level, const char *pzMessage) override {
+            const char *pzLevel = logging::decode::getLevelName(uint8_t(level));
+            lines.push_back(std::format("[{}:{}] {}", category.getName(), pzLevel, pzMessage));
+        }
+
+        std::vector<std::string> lines;
+    };
+
+    std::vector<std::string> decodeFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::string data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+        std::vector<std::string> lines;
+        auto emit = [&](const logging::binary::Message& message, std::string_view category, const std::string& text) {
+            lines.push_back(std::format("[{}:{}] {}", category, logging::decode::getLevelName(message.level), text));
+        };
+
+        std::string error;
+        ASSERTF(logging::decode::decodeLog(data, emit, error), "failed to decode {}: {}", path.string(), error);
+        return lines;
+    }
+
+    void logEverything(logging::Category& category) {
+        std::string owned = "owned string";
+        std::string_view view = "string view";
+        util::Name name = "texture.brick";
+        const void *pNull = nullptr;
+
+        category.info("ints {} {} {} {}", -1, 0, INT64_MIN, UINT64_MAX);
+        category.info("small {} {}", int8_t(-5), uint16_t(65535));
+        category.warn("floats {} {:.3f} {:e} {}", 0.25f, 3.14159f, 1e-7, -0.0);
+        category.info("strings {} {} {:>14}", owned, view, "literal");
+        category.info("name {} padded [{:<16}]", name, name);
+        category.info("bool {} char {} pointer {}", true, 'x', pNull);
+        category.info("enum {} then {} in {}", Filter::eNearest, Filter::eLinear, name);
+        category.fatal("escapes {{}} and {}", 7);
+    }
+
+    void testFormats() {
+        auto path = std::filesystem::temp_directory_path() / "simcoe-test-formats.bin.log";
+
+        RecordingSink sink;
+        logging::Category category { logging::eInfo, "binlog" };
+        category.addSink(&sink);
+
+        {
+            logging::BinarySink binary { path.string().c_str() };
+            logEverything(category);
+        }
+
+        std::vector<std::string> decoded = decodeFile(path);
+        std::filesystem::remove(path);
+
+        ASSERT(sink.lines.size() == 8);
+        ASSERT(decoded.size() == sink.lines.size());
+
+        for (size_t i = 0; i < decoded.size(); i++) {
+            ASSERTF(decoded[i] == sink.lines[i], "decoded {} but the text sink got {}", decoded[i], sink.lines[i]);
+        }
+    }
+
+    // enough messages from enough threads that full buffers are handed to the writer many times over
+    void testHandOff(bool withWriter) {
+        auto path = std::filesystem::temp_directory_path() / "simcoe-test-handoff.bin.log";
+
+        RecordingSink sink;
+        logging::Category category { logging::eInfo, "handoff" };
+        category.addSink(&sink);
+
+        {
+            std::optional<logging::Writer> writer;
+            if (withWriter) {
+                writer.emplace(logging::Writer::Info { .overflow = logging::Overflow::eBlock });
+            }
+
+            logging::BinarySink binary { path.string().c_str() };
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < kThreads; t++) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = 0; i < kMessages; i++) {
+                        category.info("thread {} message {} of {:.1f}", t, i, float(i) * 0.5f);
+                    }
+                });
+            }
+
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        }
+
+        std::vector<std::string> decoded = decodeFile(path);
+        std::filesystem::remove(path);
+
+        ASSERTF(decoded.size() == kThreads * kMessages, "decoded {} of {} messages", decoded.size(), kThreads * kMessages);
+
+        // each thread's messages come out in the order it logged them
+        std::vector<size_t> next(kThreads);
+        for (const std::string& line : decoded) {
+            size_t thread = 0;
+            size_t index = 0;
+            int count = std::sscanf(line.c_str(), "[handoff:info] thread %zu message %zu", &thread, &index);
+            ASSERTF(count == 2 && thread < kThreads, "unexpected line {}", line);
+            ASSERTF(index == next[thread], "thread {} message {} came before {}", thread, index, next[thread]);
+            next[thread] += 1;
+        }
+
+        // the text sinks saw the same messages, though threads may interleave differently
+        std::sort(decoded.begin(), decoded.end());
+        std::sort(sink.lines.begin(), sink.lines.end());
+        ASSERT(decoded == sink.lines);
+    }
+}
+
+int main() {
+    testFormats();
+    testHandOff(false);
+    testHandOff(true);
+}
@@ -0,0 +1,142 @@
+#include "simcoe/memory/bitmap.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    constexpr size_t kThreads = 8;
+
+    // fill every size around the word and summary boundaries, then check the map is full
+    template<typename M>
+    void testSizes() {
+        for (size_t size : { 0, 1, 63, 64, 65, 4095, 4096, 4097, 70000 }) {
+            M map(size);
+
+            for (size_t i = 0; i < size; i++) {
+                auto index = map.alloc();
+                ASSERTF(size_t(index) < size, "alloc {} of {} gave {}", i, size, size_t(index));
+                ASSERT(map.test(index));
+            }
+
+            ASSERTF(map.alloc() == M::Index::eInvalid, "full map of {} handed out another bit", size);
+
+            if (size == 0) { continue; }
+
+            map.release(typename M::Index(size / 2));
+            ASSERT(size_t(map.alloc()) == size / 2);
+        }
+    }
+
+    void testRanges() {
+        AtomicBitMap map(140);
+
+        auto first = map.allocRange(70);
+        auto second = map.allocRange(70);
+        ASSERT(size_t(first) == 0);
+        ASSERT(size_t(second) == 70);
+        ASSERT(map.allocRange(70) == AtomicBitMap::Index::eInvalid);
+
+        // a single bit in the gap stops a run that would span it
+        map.releaseRange(first, 70);
+        ASSERT(map.testSet(35));
+        ASSERT(map.allocRange(40) == AtomicBitMap::Index::eInvalid);
+        ASSERT(size_t(map.allocRange(30)) == 0);
+
+        AtomicBitMap empty(0);
+        ASSERT(empty.allocRange(2) == AtomicBitMap::Index::eInvalid);
+
+        AtomicBitMap whole(4096);
+        auto all = whole.allocRange(4096);
+        ASSERT(size_t(all) == 0);
+        ASSERT(whole.alloc() == AtomicBitMap::Index::eInvalid);
+
+        whole.releaseRange(all, 4096);
+        for (size_t i = 0; i < 4096; i++) {
+            ASSERT(!whole.test(AtomicBitMap::Index(i)));
+        }
+    }
+
+    // threads claim runs and single bits at random, every bit they get is recorded as theirs.
+    // a bit handed to two threads at once shows up as an owner that isn't zero
+    void testStress() {
+        constexpr size_t kSize = 1 << 14;
+        constexpr size_t kRounds = 1000;
+        constexpr size_t kPerRound = 16;
+
+        AtomicBitMap map(kSize);
+        std::vector<std::atomic_size_t> owners(kSize);
+        std::atomic_size_t collisions = 0;
+
+        auto worker = [&](size_t id) {
+            struct Claim {
+                AtomicBitMap::Index index;
+                size_t count;
+            };
+
+            std::mt19937 rng { uint32_t(id) };
+            std::vector<Claim> claims;
+
+            for (size_t round = 0; round < kRounds; round++) {
+                for (size_t i = 0; i < kPerRound; i++) {
+                    size_t count = (rng() % 4 == 0) ? 1 : 1 + rng() % 150;
+
+                    auto index = (count == 1 && rng() % 2 == 0) ? map.alloc() : map.allocRange(count);
+                    if (index == AtomicBitMap::Index::eInvalid) { continue; }
+
+                    for (size_t bit = 0; bit < count; bit++) {
+                        size_t expected = 0;
+                        if (!owners[size_t(index) + bit].compare_exchange_strong(expected, id + 1)) {
+                            collisions += 1;
+                        }
+                    }
+
+                    claims.push_back({ index, count });
+                }
+
+                for (auto [index, count] : claims) {
+                    for (size_t bit = 0; bit < count; bit++) {
+                        owners[size_t(index) + bit].store(0);
+                    }
+
+                    if (count == 1 && rng() % 2 == 0) {
+                        map.release(index);
+                    } else {
+                        map.releaseRange(index, count);
+                    }
+                }
+
+                claims.clear();
+            }
+        };
+
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < kThreads; i++) {
+            threads.emplace_back(worker, i);
+        }
+
+        threads.clear();
+
+        ASSERTF(collisions == 0, "{} bits were handed out twice", collisions.load());
+
+        for (size_t i = 0; i < kSize; i++) {
+            ASSERTF(!map.test(AtomicBitMap::Index(i)), "bit {} leaked", i);
+        }
+
+        // nothing left fragmented, the whole map is one run again
+        ASSERT(size_t(map.allocRange(kSize)) == 0);
+    }
+}
+
+int main() {
+    testSizes<BitMap>();
+    testSizes<AtomicBitMap>();
+    testRanges();
+    testStress();
+}
@@ -0,0 +1,162 @@
+#include "simcoe/threads/frames.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::threads;
+using namespace std::chrono_literals;
+
+// the game thread publishing frames to a render thread with no window or device behind it
+namespace {
+    constexpr size_t kDepth = 3;
+    constexpr size_t kValues = 64;
+
+    struct Frame {
+        uint64_t index = 0;
+        uint64_t values[kValues] = {};
+    };
+
+    using Queue = FrameQueue<Frame, kDepth>;
+
+    // the producer spins for a while on some frames and the consumer on others
+    // so both the full and the empty queue get hit
+    void stall(uint64_t frame, uint64_t period) {
+        if (frame % period == 0) {
+            for (size_t i = 0; i < 200; i++) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void run(uint64_t frames, uint64_t producerStall, uint64_t consumerStall) {
+        Queue queue;
+        std::atomic_uint64_t released = 0;
+
+        std::jthread render([&] {
+            uint64_t expected = 0;
+
+            while (const Frame *pFrame = queue.beginRead()) {
+                ASSERTF(pFrame->index == expected, "read frame {} expected {}", pFrame->index, expected);
+
+                // the producer may be writing other slots, this one has to stay put until released
+                stall(expected, consumerStall);
+                for (uint64_t value : pFrame->values) {
+                    ASSERTF(value == expected, "frame {} changed while it was being read", expected);
+                }
+
+                expected += 1;
+                released.store(expected, std::memory_order_relaxed);
+                queue.endRead();
+            }
+
+            ASSERTF(expected == frames, "render thread saw {} of {} frames", expected, frames);
+        });
+
+        for (uint64_t frame = 0; frame < frames; frame++) {
+            Frame& slot = queue.beginWrite();
+
+            // never more than the queue depth ahead of the render thread
+            ASSERTF(frame - released.load(std::memory_order_relaxed) < kDepth, "frame {} is more than {} ahead", frame, kDepth);
+
+            slot.index = frame;
+            for (uint64_t& value : slot.values) {
+                value = frame;
+            }
+
+            queue.endWrite();
+            ASSERT(queue.getPending() <= kDepth);
+
+            stall(frame, producerStall);
+        }
+
+        // the render thread drains every frame still queued before it sees the close
+        queue.close();
+    }
+
+    // a render thread that takes a fixed time per frame against a game thread that does no work.
+    // the game thread should run kDepth frames ahead at full speed then block, not step in lockstep
+    void testSlowConsumer() {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr auto kRenderTime = 20ms;
+        constexpr size_t kFrames = 12;
+
+        Queue queue;
+
+        // when each frame got its slot, relative to start
+        std::vector<Clock::duration> acquired;
+
+        auto start = Clock::now();
+
+        std::thread render([&] {
+            while (queue.beginRead() != nullptr) {
+                std::this_thread::sleep_for(kRenderTime);
+                queue.endRead();
+            }
+        });
+
+        for (uint64_t frame = 0; frame < kFrames; frame++) {
+            queue.beginWrite().index = frame;
+            acquired.push_back(Clock::now() - start);
+            queue.endWrite();
+        }
+
+        queue.close();
+        render.join();
+
+        auto total = Clock::now() - start;
+
+        // the run ahead window, nothing has been released yet so none of these wait
+        auto window = acquired[kDepth - 1];
+        double windowRate = double(kDepth) / std::chrono::duration<double>(window).count();
+        double steadyRate = double(kFrames - kDepth) / std::chrono::duration<double>(acquired.back() - window).count();
+
+        std::printf("run ahead: %zu frames at %.0f fps, then %.1f fps against a %lldms render thread\n",
+            kDepth, windowRate, steadyRate, (long long)kRenderTime.count());
+
+        ASSERTF(window < kRenderTime, "the first {} frames took {}us, the producer is waiting on the consumer",
+            kDepth, std::chrono::duration_cast<std::chrono::microseconds>(window).count());
+
+        // the next frame needs the first one released so it waits out a whole render
+        ASSERTF(acquired[kDepth] >= kRenderTime, "frame {} was handed out {}us in, before any frame was released",
+            kDepth, std::chrono::duration_cast<std::chrono::microseconds>(acquired[kDepth]).count());
+
+        // from then on the producer is paced by the consumer, one frame per render
+        for (size_t frame = kDepth; frame < kFrames; frame++) {
+            auto earliest = kRenderTime * (frame - kDepth + 1);
+            ASSERTF(acquired[frame] >= earliest, "frame {} was handed out more than {} ahead", frame, kDepth);
+        }
+
+        ASSERT(total >= kRenderTime * kFrames);
+    }
+
+    void testClose() {
+        Queue queue;
+
+        queue.beginWrite().index = 7;
+        queue.endWrite();
+        queue.close();
+
+        const Frame *pFrame = queue.beginRead();
+        ASSERT(pFrame != nullptr && pFrame->index == 7);
+        queue.endRead();
+
+        ASSERT(queue.beginRead() == nullptr);
+        ASSERT(queue.getPending() == 0);
+    }
+}
+
+int main() {
+    testClose();
+    testSlowConsumer();
+
+    run(200'000, 1'000'000, 1'000'000);
+    run(20'000, 7, 1'000'000);
+    run(20'000, 1'000'000, 7);
+}
@@ -0,0 +1,207 @@
+#include "simcoe/core/framestats.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace simcoe;
+using namespace std::chrono_literals;
+
+namespace {
+    using Stats = FrameStats;
+
+    // the same time in every series, offset so a mixup between them shows up
+    FrameTimes getTimes(Duration cpu) {
+        return { .cpu = cpu, .presentWait = cpu * 2, .gpu = cpu * 3 };
+    }
+
+    // nearest rank against a fully sorted copy
+    Duration getExpected(std::vector<Duration> values, size_t percent) {
+        std::sort(values.begin(), values.end());
+        size_t rank = (values.size() * percent + 99) / 100;
+        return values[std::max<size_t>(rank, 1) - 1];
+    }
+
+    size_t getHistogramTotal(const Stats& stats, Stats::Series series) {
+        const Stats::Histogram& histogram = stats.getHistogram(series);
+        return std::accumulate(histogram.begin(), histogram.end(), size_t(0));
+    }
+
+    void testBuckets() {
+        ASSERT(Stats::getBucket(0us) == 0);
+        ASSERT(Stats::getBucket(-5ms) == 0);
+        ASSERT(Stats::getBucketStart(0) == 0us);
+
+        // every bucket starts where the last one ended and holds everything up to the next
+        for (size_t bucket = 0; bucket + 1 < Stats::kBucketCount; bucket++) {
+            Duration start = Stats::getBucketStart(bucket);
+            Duration next = Stats::getBucketStart(bucket + 1);
+
+            ASSERTF(start < next, "bucket {} starts at {}us but {} starts at {}us", bucket, start.count(), bucket + 1, next.count());
+            ASSERTF(Stats::getBucket(start) == bucket, "the start of bucket {} landed in {}", bucket, Stats::getBucket(start));
+            ASSERTF(Stats::getBucket(next - 1ns) == bucket, "the end of bucket {} landed in {}", bucket, Stats::getBucket(next - 1ns));
+        }
+
+        // the first few are a microsecond wide, then four to each power of two
+        ASSERT(Stats::getBucketStart(3) == 3us);
+        ASSERT(Stats::getBucketStart(4) == 4us);
+        ASSERT(Stats::getBucketStart(5) == 5us);
+        ASSERT(Stats::getBucketStart(8) == 8us);
+        ASSERT(Stats::getBucketStart(9) == 10us);
+        ASSERT(Stats::getBucket(16666us) == Stats::getBucket(16384us));
+        ASSERT(Stats::getBucket(16666us) + 1 == Stats::getBucket(20480us));
+
+        // the last bucket starts a little under 2 seconds and catches everything after
+        size_t last = Stats::kBucketCount - 1;
+        ASSERT(Stats::getBucketStart(last) < 2s);
+        ASSERT(Stats::getBucket(2s) == last);
+        ASSERT(Stats::getBucket(1h) == last);
+    }
+
+    void testPercentiles() {
+        Stats stats({ .window = 100 });
+        ASSERT(stats.getSummary(Stats::eCpu).max == Duration::zero());
+
+        // 1ms to 100ms in a shuffled order
+        std::vector<Duration> values;
+        for (int i = 1; i <= 100; i++) {
+            values.push_back(std::chrono::milliseconds(i));
+        }
+
+        std::shuffle(values.begin(), values.end(), std::mt19937 { 7 });
+        for (Duration value : values) {
+            stats.add(getTimes(value));
+        }
+
+        Stats::Summary cpu = stats.getSummary(Stats::eCpu);
+        ASSERT(cpu.p50 == 50ms);
+        ASSERT(cpu.p95 == 95ms);
+        ASSERT(cpu.p99 == 99ms);
+        ASSERT(cpu.max == 100ms);
+
+        Stats::Summary gpu = stats.getSummary(Stats::eGpu);
+        ASSERT(gpu.p50 == 150ms);
+        ASSERT(gpu.max == 300ms);
+
+        ASSERT(stats.getSummary(Stats::ePresentWait).p99 == 198ms);
+    }
+
+    // few frames put several percentiles on the same rank
+    void testSmallWindows() {
+        Stats one({ .window = 1 });
+        one.add(getTimes(5ms));
+        one.add(getTimes(9ms));
+
+        Stats::Summary summary = one.getSummary(Stats::eCpu);
+        ASSERT(summary.p50 == 9ms && summary.p95 == 9ms && summary.p99 == 9ms && summary.max == 9ms);
+
+        Stats two({ .window = 8 });
+        two.add(getTimes(7ms));
+        two.add(getTimes(3ms));
+
+        summary = two.getSummary(Stats::eCpu);
+        ASSERT(summary.p50 == 3ms);
+        ASSERT(summary.p95 == 7ms && summary.p99 == 7ms && summary.max == 7ms);
+    }
+
+    // random windows and values with plenty of duplicates against a full sort
+    void testAgainstSort() {
+        std::mt19937 rng { 42 };
+        std::uniform_int_distribution<int> micros(0, 40'000);
+
+        for (size_t window : { 1, 2, 3, 7, 64, 100, 101, 1000 }) {
+            Stats stats({ .window = window });
+            std::vector<Duration> history;
+
+            for (size_t frame = 0; frame < window * 3 + 5; frame++) {
+                // round to 100us so values repeat
+                Duration value = std::chrono::microseconds(micros(rng) / 100 * 100);
+                stats.add(getTimes(value));
+                history.push_back(value);
+
+                if (frame % 17 != 0) { continue; }
+
+                size_t count = std::min(history.size(), window);
+                std::vector<Duration> recent(history.end() - ptrdiff_t(count), history.end());
+
+                Stats::Summary summary = stats.getSummary(Stats::eCpu);
+                ASSERTF(summary.p50 == getExpected(recent, 50), "p50 wrong with window {} at frame {}", window, frame);
+                ASSERTF(summary.p95 == getExpected(recent, 95), "p95 wrong with window {} at frame {}", window, frame);
+                ASSERTF(summary.p99 == getExpected(recent, 99), "p99 wrong with window {} at frame {}", window, frame);
+                ASSERTF(summary.max == getExpected(recent, 100), "max wrong with window {} at frame {}", window, frame);
+                ASSERT(summary.p50 <= summary.p95 && summary.p95 <= summary.p99 && summary.p99 <= summary.max);
+            }
+        }
+    }
+
+    // frames leaving the window leave the histogram too
+    void testHistogram() {
+        Stats stats({ .window = 10 });
+
+        for (size_t i = 0; i < 10; i++) {
+            stats.add(getTimes(1ms));
+        }
+
+        size_t slow = Stats::getBucket(50ms);
+        size_t fast = Stats::getBucket(1ms);
+        ASSERT(stats.getHistogram(Stats::eCpu)[fast] == 10);
+
+        for (size_t i = 0; i < 15; i++) {
+            stats.add(getTimes(50ms));
+
+            size_t expected = std::min<size_t>(i + 1, 10);
+            ASSERT(stats.getHistogram(Stats::eCpu)[slow] == expected);
+            ASSERT(stats.getHistogram(Stats::eCpu)[fast] == 10 - expected);
+        }
+
+        ASSERT(stats.getCount() == 10);
+        ASSERT(stats.getTotal() == 25);
+
+        for (size_t series = 0; series < Stats::eSeriesCount; series++) {
+            ASSERT(getHistogramTotal(stats, Stats::Series(series)) == 10);
+        }
+
+        ASSERT(stats.getHistogram(Stats::eGpu)[Stats::getBucket(150ms)] == 10);
+    }
+
+    void testCsv() {
+        Stats stats({ .window = 4 });
+        for (int i = 1; i <= 6; i++) {
+            stats.add(getTimes(std::chrono::milliseconds(i)));
+        }
+
+        auto path = std::filesystem::temp_directory_path() / "simcoe-test-framestats.csv";
+        ASSERT(stats.writeCsv(path.string().c_str()));
+
+        std::vector<std::string> lines;
+        {
+            std::ifstream file(path);
+            for (std::string line; std::getline(file, line);) {
+                lines.push_back(line);
+            }
+        }
+
+        std::filesystem::remove(path);
+
+        // the header then the last 4 frames oldest first
+        ASSERT(lines.size() == 5);
+        ASSERT(lines[0] == "frame,cpu_us,present_wait_us,gpu_us");
+        ASSERT(lines[1] == "2,3000.0,6000.0,9000.0");
+        ASSERT(lines[4] == "5,6000.0,12000.0,18000.0");
+    }
+}
+
+int main() {
+    testBuckets();
+    testPercentiles();
+    testSmallWindows();
+    testAgainstSort();
+    testHistogram();
+    testCsv();
+}
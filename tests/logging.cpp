@@ -0,0 +1,93 @@
+#include "simcoe/core/logging.h"
+
+#include "simcoe/core/panic.h"
+
+#include <string>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    // keeps a copy of everything it is sent
+    struct RecordingSink final : logging::IFilterSink {
+        RecordingSink() : IFilterSink("recording") { }
+
+        void accept(logging::Category&, logging::Level, const char *pzMessage) override {
+            messages.emplace_back(pzMessage);
+        }
+
+        std::vector<std::string> messages;
+    };
+
+    // logs to another category while a message is being sent
+    struct EchoSink final : logging::IFilterSink {
+        EchoSink(logging::Category& echo) : IFilterSink("echo"), echo(echo) { }
+
+        void accept(logging::Category&, logging::Level, const char *pzMessage) override {
+            std::string before = pzMessage;
+            echo.info("echo of {}", pzMessage);
+
+            // the nested message must not have written over the one being sent
+            ASSERTF(before == pzMessage, "{} became {}", before, pzMessage);
+        }
+
+        logging::Category& echo;
+    };
+
+    void testFormat() {
+        RecordingSink sink;
+        logging::Category category { logging::eInfo, "format" };
+        category.addSink(&sink);
+
+        category.info("{} and {}", 1, "two");
+        category.warn("{:.2f}", 0.5f);
+        category.info("nothing to format");
+
+        ASSERT(sink.messages.size() == 3);
+        ASSERT(sink.messages[0] == "1 and two");
+        ASSERT(sink.messages[1] == "0.50");
+        ASSERT(sink.messages[2] == "nothing to format");
+    }
+
+    // messages longer than the thread local buffer arrive whole
+    void testLong() {
+        RecordingSink sink;
+        logging::Category category { logging::eInfo, "long" };
+        category.addSink(&sink);
+
+        for (size_t length : { 100, 4093, 4094, 10'000 }) {
+            std::string text(length, 'x');
+            text.back() = 'y';
+
+            category.info("[{}]", text);
+            ASSERT(sink.messages.back() == "[" + text + "]");
+        }
+
+        // and the buffer is fine for the next short one
+        category.info("short");
+        ASSERT(sink.messages.back() == "short");
+    }
+
+    void testNested() {
+        RecordingSink sink;
+        logging::Category echo { logging::eInfo, "echo" };
+        echo.addSink(&sink);
+
+        EchoSink echoSink { echo };
+        logging::Category category { logging::eInfo, "nested" };
+        category.addSink(&echoSink);
+
+        category.info("message {}", 1);
+        category.info("message {}", 2);
+
+        ASSERT(sink.messages.size() == 2);
+        ASSERT(sink.messages[0] == "echo of message 1");
+        ASSERT(sink.messages[1] == "echo of message 2");
+    }
+}
+
+int main() {
+    testFormat();
+    testLong();
+    testNested();
+}
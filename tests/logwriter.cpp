@@ -0,0 +1,141 @@
+#include "simcoe/core/logwriter.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <charconv>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace std::chrono_literals;
+
+namespace {
+    constexpr size_t kThreads = 8;
+    constexpr size_t kMessages = 10'000;
+
+    // checks each thread's messages arrive in the order they were logged
+    struct OrderSink final : logging::IFilterSink {
+        OrderSink() : IFilterSink("order") { }
+
+        void accept(logging::Category&, logging::Level, const char *pzMessage) override {
+            std::string_view message = pzMessage;
+
+            size_t thread = 0;
+            size_t index = 0;
+            auto [pEnd, error] = std::from_chars(message.data(), message.data() + message.size(), thread);
+            ASSERT(error == std::errc() && *pEnd == ' ');
+            std::from_chars(pEnd + 1, message.data() + message.size(), index);
+
+            ASSERTF(index == next[thread], "thread {} message {} arrived before {}", thread, index, next[thread]);
+            next[thread] += 1;
+            received += 1;
+        }
+
+        size_t next[kThreads] = { };
+        std::atomic_size_t received = 0;
+    };
+
+    void testOrder() {
+        OrderSink sink;
+        logging::Category category { logging::eInfo, "order" };
+        category.addSink(&sink);
+
+        logging::Writer writer {{ .capacity = 256, .overflow = logging::Overflow::eBlock }};
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t t = 0; t < kThreads; t++) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = 0; i < kMessages; i++) {
+                        category.info("{} {}", t, i);
+                    }
+
+                    // everything this thread logged is out once flush returns
+                    ASSERT(writer.flush());
+                    ASSERT(sink.next[t] == kMessages);
+                });
+            }
+        }
+
+        ASSERT(sink.received == kThreads * kMessages);
+        ASSERT(writer.getDropped() == 0);
+    }
+
+    // a sink that flushes, as panic does when a sink fails on the writer thread
+    struct FlushingSink final : logging::IFilterSink {
+        FlushingSink() : IFilterSink("flushing") { }
+
+        void accept(logging::Category&, logging::Level, const char*) override {
+            ASSERT(logging::getWriter()->isWriterThread());
+            ASSERT(logging::getWriter()->flush());
+            received += 1;
+        }
+
+        std::atomic_size_t received = 0;
+    };
+
+    void testFlushOnWriter() {
+        FlushingSink sink;
+        logging::Category category { logging::eInfo, "flushing" };
+        category.addSink(&sink);
+
+        logging::Writer writer {{ .overflow = logging::Overflow::eBlock }};
+
+        for (size_t i = 0; i < 1000; i++) {
+            category.info("message {}", i);
+        }
+
+        ASSERT(writer.flush(10s));
+        ASSERT(sink.received == 1000);
+    }
+
+    // a sink slow enough that a small queue overflows
+    struct SlowSink final : logging::IFilterSink {
+        SlowSink() : IFilterSink("slow") { }
+
+        void accept(logging::Category&, logging::Level level, const char *pzMessage) override {
+            std::string_view message = pzMessage;
+            if (level == logging::eWarn && message.starts_with("log writer fell behind")) {
+                reports += 1;
+                return;
+            }
+
+            std::this_thread::sleep_for(10us);
+            received += 1;
+        }
+
+        std::atomic_size_t received = 0;
+        std::atomic_size_t reports = 0;
+    };
+
+    void testOverflow() {
+        SlowSink sink;
+        logging::Category category { logging::eInfo, "overflow" };
+        category.addSink(&sink);
+
+        size_t dropped = 0;
+
+        {
+            logging::Writer writer {{ .capacity = 16, .overflow = logging::Overflow::eReport }};
+
+            for (size_t i = 0; i < kMessages; i++) {
+                category.info("message {}", i);
+            }
+
+            writer.flush();
+            dropped = writer.getDropped();
+        }
+
+        // every message was either delivered or counted, and the loss was owned up to
+        ASSERTF(sink.received + dropped == kMessages, "{} delivered and {} dropped of {}", size_t(sink.received), dropped, kMessages);
+        ASSERT(dropped > 0);
+        ASSERT(sink.reports > 0);
+    }
+}
+
+int main() {
+    testOrder();
+    testFlushOnWriter();
+    testOverflow();
+}
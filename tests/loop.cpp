@@ -0,0 +1,126 @@
+#include "simcoe/core/loop.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace simcoe;
+using namespace std::chrono_literals;
+
+namespace {
+    // time only moves when the test says so
+    struct FakeClock final : IClock {
+        Duration time = 1h;
+
+        Duration now() override { return time; }
+    };
+
+    // a little simulation whose state depends on every step and its order
+    struct Body {
+        float position = 0.f;
+        float velocity = 1.f;
+
+        void step(float dt) {
+            velocity += -position * dt;
+            position += velocity * dt;
+        }
+
+        bool operator==(const Body&) const = default;
+    };
+
+    struct Run {
+        Body body;
+        size_t ticks;
+        Duration dropped;
+    };
+
+    // feeds the same total time through the loop in whatever frame lengths it is given
+    Run simulate(const std::vector<Duration>& frames) {
+        FakeClock clock;
+        GameLoop loop({ .tickRate = 60.0, .maxSteps = 5 }, clock);
+        Body body;
+
+        for (Duration frame : frames) {
+            clock.time += frame;
+
+            float alpha = loop.update([&](float dt) { body.step(dt); });
+            ASSERTF(alpha >= 0.f && alpha < 1.f, "alpha {} out of range", alpha);
+        }
+
+        return { body, loop.getTick(), loop.getDropped() };
+    }
+
+    // frame lengths that sum to total, none long enough to hit the step limit
+    std::vector<Duration> split(Duration total, Duration shortest, Duration longest, uint32_t seed) {
+        std::mt19937 rng { seed };
+        std::uniform_int_distribution<Duration::rep> length(shortest.count(), longest.count());
+
+        std::vector<Duration> frames;
+        while (total > Duration::zero()) {
+            Duration frame = std::min(Duration(length(rng)), total);
+            frames.push_back(frame);
+            total -= frame;
+        }
+
+        return frames;
+    }
+
+    void testDeterminism() {
+        constexpr Duration kTotal = 60s;
+
+        Run fixed = simulate(std::vector<Duration>(60 * 60, Duration(1s) / 60));
+        ASSERT(fixed.dropped == Duration::zero());
+
+        // a fast display, a slow one and one all over the place, all the same simulation
+        using Range = std::pair<Duration, Duration>;
+        for (auto [shortest, longest] : { Range(1ms, 4ms), Range(30ms, 60ms), Range(1us, 80ms) }) {
+            for (uint32_t seed = 0; seed < 4; seed++) {
+                Run run = simulate(split(kTotal, shortest, longest, seed));
+
+                ASSERTF(run.ticks == fixed.ticks, "ran {} ticks, fixed frames ran {}", run.ticks, fixed.ticks);
+                ASSERT(run.dropped == Duration::zero());
+                ASSERTF(run.body == fixed.body, "diverged to {} with seed {}", run.body.position, seed);
+            }
+        }
+    }
+
+    void testSpiral() {
+        FakeClock clock;
+        GameLoop loop({ .tickRate = 100.0, .maxSteps = 5 }, clock);
+
+        // a 1 second hitch only runs 5 ticks, the rest is dropped but the partial tick is kept
+        clock.time += 1s + 4ms;
+
+        size_t steps = 0;
+        float alpha = loop.update([&](float) { steps += 1; });
+
+        ASSERT(steps == 5);
+        ASSERT(loop.getTick() == 5);
+        ASSERT(loop.getDropped() == 950ms);
+        ASSERTF(alpha > 0.39f && alpha < 0.41f, "alpha was {}", alpha);
+
+        // no time passing runs nothing
+        steps = 0;
+        loop.update([&](float) { steps += 1; });
+        ASSERT(steps == 0);
+    }
+
+    void testInterpolated() {
+        Interpolated<float> value(1.f);
+        ASSERT(value.get(0.5f) == 1.f);
+
+        value.update(3.f);
+        ASSERT(value.get(0.f) == 1.f);
+        ASSERT(value.get(0.5f) == 2.f);
+        ASSERT(value.get(1.f) == 3.f);
+    }
+}
+
+int main() {
+    testDeterminism();
+    testSpiral();
+    testInterpolated();
+}
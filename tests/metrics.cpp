@@ -0,0 +1,102 @@
+#include "simcoe/core/metrics.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace std::chrono_literals;
+
+namespace {
+    metrics::Counter gEarly { "test.early" };
+
+    // registered once a sampler is running. metrics are never removed so these have to outlive every sampler
+    std::optional<metrics::Counter> gLate;
+    std::optional<metrics::Histogram> gWaits;
+    std::optional<metrics::Gauge> gCsvLate;
+
+    std::vector<std::string> readLines(const std::filesystem::path& path) {
+        std::vector<std::string> lines;
+        std::ifstream file(path);
+        for (std::string line; std::getline(file, line);) {
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+
+    bool contains(const std::string& text, std::string_view part) {
+        return text.find(part) != std::string::npos;
+    }
+
+    // metrics made after the sampler started show up from its next sample
+    void testLateJson() {
+        auto path = std::filesystem::temp_directory_path() / "simcoe-test-metrics.jsonl";
+        std::string name = path.string();
+
+        {
+            metrics::Sampler sampler {{ .pzPath = name.c_str(), .interval = 5ms }};
+
+            gEarly.add(2);
+            gLate.emplace("test.late");
+            gLate->add(3);
+            gWaits.emplace("test.waits");
+            gWaits->record(100);
+        }
+
+        std::vector<std::string> lines = readLines(path);
+        std::filesystem::remove(path);
+
+        // the sampler writes one last line on the way out
+        ASSERT(!lines.empty());
+        const std::string& last = lines.back();
+        ASSERTF(contains(last, "\"test.early\":2"), "early counter missing from {}", last);
+        ASSERTF(contains(last, "\"test.late\":3"), "late counter missing from {}", last);
+        ASSERTF(contains(last, "\"test.waits\":{\"count\":1,\"sum\":100"), "late histogram missing from {}", last);
+    }
+
+    void testLateCsv() {
+        auto path = std::filesystem::temp_directory_path() / "simcoe-test-metrics.csv";
+        std::string name = path.string();
+
+        {
+            metrics::Sampler sampler {{ .pzPath = name.c_str(), .format = metrics::Format::eCsv, .interval = 5ms }};
+
+            // let a few rows go out with the old columns
+            std::this_thread::sleep_for(20ms);
+
+            gCsvLate.emplace("test.csv.late");
+            gCsvLate->add(-4);
+        }
+
+        std::vector<std::string> lines = readLines(path);
+        std::filesystem::remove(path);
+
+        auto isHeader = [](const std::string& line) { return line.starts_with("time,"); };
+
+        ASSERT(lines.size() >= 3);
+        ASSERT(isHeader(lines.front()));
+        ASSERT(!contains(lines.front(), "test.csv.late"));
+
+        // a second header row with the new column comes before the rows that use it
+        auto header = std::find_if(lines.rbegin(), lines.rend(), isHeader);
+        ASSERT(header != lines.rend());
+        ASSERT(contains(*header, "test.csv.late"));
+        ASSERT(header != lines.rbegin());
+
+        auto columns = [](const std::string& line) { return std::count(line.begin(), line.end(), ','); };
+        ASSERT(columns(lines.back()) == columns(*header));
+        ASSERT(lines.back().ends_with(",-4") || contains(lines.back(), ",-4,"));
+    }
+}
+
+int main() {
+    testLateJson();
+    testLateCsv();
+}
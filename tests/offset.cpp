@@ -0,0 +1,146 @@
+#include "simcoe/memory/offset.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    using Index = OffsetAllocator::Index;
+
+    constexpr size_t kGranularity = 256;
+
+    void testWhole() {
+        OffsetAllocator heap(kGranularity * 64, kGranularity);
+
+        auto all = heap.alloc(heap.getSize());
+        ASSERT(all.offset == 0);
+        ASSERT(heap.alloc(1).index == Index::eInvalid);
+
+        auto stats = heap.getStats();
+        ASSERT(stats.used.b() == heap.getSize());
+        ASSERT(stats.free.b() == 0);
+        ASSERT(stats.allocations == 1);
+
+        heap.release(all.index);
+
+        stats = heap.getStats();
+        ASSERT(stats.used.b() == 0);
+        ASSERT(stats.peak.b() == heap.getSize());
+        ASSERT(stats.largestFree.b() == heap.getSize());
+        ASSERT(stats.fragmentation == 0.f);
+    }
+
+    // release every other block, the free space is all there but none of it is contiguous
+    void testFragmentation() {
+        constexpr size_t kBlocks = 64;
+
+        OffsetAllocator heap(kGranularity * kBlocks, kGranularity);
+
+        std::vector<OffsetAllocator::Allocation> blocks;
+        for (size_t i = 0; i < kBlocks; i++) {
+            blocks.push_back(heap.alloc(kGranularity));
+            ASSERT(blocks.back().offset == i * kGranularity);
+        }
+
+        for (size_t i = 0; i < kBlocks; i += 2) {
+            heap.release(blocks[i].index);
+        }
+
+        auto stats = heap.getStats();
+        ASSERT(stats.free.b() == kGranularity * kBlocks / 2);
+        ASSERT(stats.largestFree.b() == kGranularity);
+        ASSERT(stats.fragmentation > 0.9f);
+        ASSERT(heap.alloc(kGranularity * 2).index == Index::eInvalid);
+
+        // releasing the rest coalesces back into one block
+        for (size_t i = 1; i < kBlocks; i += 2) {
+            heap.release(blocks[i].index);
+        }
+
+        ASSERT(heap.getStats().largestFree.b() == heap.getSize());
+        ASSERT(heap.alloc(heap.getSize()).offset == 0);
+    }
+
+    // random sizes and alignments, every live allocation is checked against its neighbours
+    void testRandom() {
+        constexpr size_t kSize = 64 * 1024 * 1024;
+        constexpr size_t kSteps = 200'000;
+
+        OffsetAllocator heap(kSize, kGranularity);
+        std::mt19937_64 rng(1);
+
+        struct Live {
+            size_t size;
+            Index index;
+        };
+
+        // keyed by offset so overlaps show up as neighbours
+        std::map<size_t, Live> live;
+        size_t used = 0;
+        size_t peak = 0;
+
+        auto roundUp = [](size_t size) { return std::max<size_t>((size + kGranularity - 1) / kGranularity, 1) * kGranularity; };
+
+        for (size_t step = 0; step < kSteps; step++) {
+            if (live.empty() || rng() % 3 != 0) {
+                size_t size = 1 + rng() % (256 * 1024);
+                size_t align = size_t(1) << (rng() % 17);
+
+                auto [offset, index] = heap.alloc(size, align);
+                if (index == Index::eInvalid) { continue; }
+
+                ASSERTF(offset % std::max(align, kGranularity) == 0, "offset {} not aligned to {}", offset, align);
+                ASSERT(offset + size <= kSize);
+
+                auto [it, inserted] = live.emplace(offset, Live { roundUp(size), index });
+                ASSERTF(inserted, "offset {} handed out twice", offset);
+
+                if (it != live.begin()) {
+                    auto prev = std::prev(it);
+                    ASSERTF(prev->first + prev->second.size <= offset, "{} overlaps {}", offset, prev->first);
+                }
+
+                if (auto next = std::next(it); next != live.end()) {
+                    ASSERTF(offset + it->second.size <= next->first, "{} overlaps {}", offset, next->first);
+                }
+
+                used += it->second.size;
+                peak = std::max(peak, used);
+            } else {
+                auto it = live.begin();
+                std::advance(it, rng() % live.size());
+
+                heap.release(it->second.index);
+                used -= it->second.size;
+                live.erase(it);
+            }
+
+            if (step % 1024 == 0) {
+                auto stats = heap.getStats();
+                ASSERT(stats.used.b() == used);
+                ASSERT(stats.allocations == live.size());
+            }
+        }
+
+        ASSERT(heap.getStats().peak.b() == peak);
+
+        for (auto& [offset, block] : live) {
+            heap.release(block.index);
+        }
+
+        ASSERT(heap.getStats().largestFree.b() == kSize);
+    }
+}
+
+int main() {
+    testWhole();
+    testFragmentation();
+    testRandom();
+}
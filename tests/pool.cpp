@@ -0,0 +1,115 @@
+#include "simcoe/memory/pool.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    constexpr size_t kThreads = 8;
+
+    struct Object {
+        size_t owner;
+        size_t value;
+    };
+
+    using Pool = ObjectPool<Object>;
+
+    // objects made on one thread and freed on another, no object may be live twice
+    void testCrossThread() {
+        constexpr size_t kCount = 1 << 16;
+
+        std::mutex mutex;
+        std::unordered_set<Object*> live;
+        std::vector<Object*> handoff;
+        std::atomic_size_t collisions = 0;
+
+        auto producer = [&](size_t id) {
+            for (size_t i = 0; i < kCount; i++) {
+                Object *pObject = Pool::create(id, i);
+
+                std::lock_guard guard(mutex);
+                if (!live.insert(pObject).second) { collisions += 1; }
+                handoff.push_back(pObject);
+            }
+        };
+
+        auto consumer = [&] {
+            for (size_t done = 0; done < kCount;) {
+                Object *pObject = nullptr;
+
+                {
+                    std::lock_guard guard(mutex);
+                    if (handoff.empty()) { continue; }
+
+                    pObject = handoff.back();
+                    handoff.pop_back();
+                    live.erase(pObject);
+                }
+
+                ASSERT(pObject->owner < kThreads / 2);
+                Pool::destroy(pObject);
+                done += 1;
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i = 0; i < kThreads / 2; i++) {
+                threads.emplace_back(producer, i);
+                threads.emplace_back(consumer);
+            }
+        }
+
+        ASSERTF(collisions == 0, "{} objects were handed out while still live", collisions.load());
+        ASSERT(live.empty());
+    }
+
+    // constructed before the pool is first used on a thread so it is destroyed after the thread cache
+    struct LateFree {
+        Object *pObject = nullptr;
+
+        ~LateFree() {
+            Pool::destroy(pObject);
+
+            // and a fresh allocation after the cache is gone
+            Object *pAfter = Pool::create(1, 2);
+            ASSERT(pAfter->value == 2);
+            Pool::destroy(pAfter);
+        }
+    };
+
+    void testThreadExit() {
+        auto worker = [] {
+            thread_local LateFree late;
+
+            late.pObject = Pool::create(0, 1);
+
+            // churn past a magazine so the cache holds some of both
+            std::vector<Object*> objects;
+            for (size_t i = 0; i < 200; i++) {
+                objects.push_back(Pool::create(0, i));
+            }
+
+            for (Object *pObject : objects) {
+                Pool::destroy(pObject);
+            }
+        };
+
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < kThreads; i++) {
+            threads.emplace_back(worker);
+        }
+    }
+}
+
+int main() {
+    testCrossThread();
+    testThreadExit();
+}
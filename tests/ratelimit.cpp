@@ -0,0 +1,168 @@
+#include "simcoe/core/logging.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+using namespace std::chrono_literals;
+
+namespace {
+    constexpr size_t kThreads = 8;
+    constexpr size_t kWarnings = 1'000'000;
+
+    constexpr logging::RateLimit kLimit = { .perSecond = 100.f, .burst = 10 };
+
+    // a dropped call skips formatting and the sinks, so even with every thread on the one
+    // call site it shouldn't cost more than a few times a call that goes all the way through
+    constexpr double kSlowdown = 3.0;
+
+    // splits what reaches the sinks into messages and the suppression notices
+    struct CountingSink final : logging::IFilterSink {
+        CountingSink() : IFilterSink("counting") { }
+
+        void accept(logging::Category&, logging::Level, const char *pzMessage) override {
+            std::string_view message = pzMessage;
+            if (!message.starts_with(kNotice)) {
+                messages += 1;
+                return;
+            }
+
+            size_t count = 0;
+            auto [_, error] = std::from_chars(message.data() + kNotice.size(), message.data() + message.size(), count);
+            ASSERTF(error == std::errc(), "malformed notice {}", message);
+
+            notices += 1;
+            reported += count;
+        }
+
+        static constexpr std::string_view kNotice = "suppressed ";
+
+        std::atomic_size_t messages = 0;
+        std::atomic_size_t notices = 0;
+        std::atomic_size_t reported = 0;
+    };
+
+    // one call site, the limiter keys on the format string
+    void missingTexture(logging::Category& category, size_t i) {
+        category.warn("missing texture {}", i);
+    }
+
+    void unknownKey(logging::Category& category, size_t i) {
+        category.warn("unknown key {}", i);
+    }
+
+    // returns the seconds it took
+    double spam(logging::Category& category, size_t count) {
+        auto start = std::chrono::steady_clock::now();
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t t = 0; t < kThreads; t++) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = t; i < count; i += kThreads) {
+                        missingTexture(category, i);
+                    }
+                });
+            }
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double getNanosPerCall(double seconds, size_t count) {
+        return seconds * 1e9 / double(count);
+    }
+
+    void testSpam(double unlimitedCost) {
+        CountingSink sink;
+        logging::Category category { logging::eInfo, "spam" };
+        category.addSink(&sink);
+        category.setRateLimit(kLimit);
+
+        double elapsed = spam(category, kWarnings);
+
+        double limitedCost = getNanosPerCall(elapsed, kWarnings);
+        std::printf("limited site %.1f ns/call, unlimited site %.1f ns/call\n", limitedCost, unlimitedCost);
+        ASSERTF(limitedCost <= unlimitedCost * kSlowdown, "a limited call took {:.1f}ns against {:.1f}ns unlimited", limitedCost, unlimitedCost);
+
+        // every call either got through or was counted
+        size_t messages = sink.messages;
+        size_t suppressed = category.getSuppressed();
+        ASSERTF(messages + suppressed == kWarnings, "{} sent and {} suppressed of {}", messages, suppressed, kWarnings);
+
+        // the burst up front then one message per interval, plus one for a message racing the clock
+        double allowed = kLimit.burst + elapsed * kLimit.perSecond + 1;
+        ASSERTF(double(messages) <= allowed, "{} messages got through in {}s, at most {} allowed", messages, elapsed, allowed);
+        ASSERT(messages >= kLimit.burst);
+
+        // notices only go out with a message that got through, so can't outnumber them
+        ASSERT(sink.notices < messages);
+        ASSERT(sink.reported <= suppressed);
+
+        // once the bucket drains the next message reports whatever is left
+        std::this_thread::sleep_for(200ms);
+        missingTexture(category, kWarnings);
+
+        ASSERTF(sink.reported == suppressed, "reported {} of {} suppressed", size_t(sink.reported), suppressed);
+        ASSERT(sink.messages == messages + 1);
+    }
+
+    void testSites() {
+        CountingSink sink;
+        logging::Category category { logging::eInfo, "sites" };
+        category.addSink(&sink);
+        category.setRateLimit({ .perSecond = 0.001f, .burst = 5 });
+
+        // each site gets its own burst, one flooding doesn't silence the other
+        for (size_t i = 0; i < 1000; i++) {
+            missingTexture(category, i);
+            unknownKey(category, i);
+        }
+
+        ASSERT(sink.messages == 10);
+        ASSERT(category.getSuppressed() == 1990);
+
+        // below the limited level nothing is dropped
+        for (size_t i = 0; i < 1000; i++) {
+            category.info("loaded {}", i);
+        }
+
+        ASSERT(sink.messages == 1010);
+
+        // a zeroed limit turns it off
+        category.setRateLimit({ });
+        for (size_t i = 0; i < 1000; i++) {
+            missingTexture(category, i);
+        }
+
+        ASSERT(sink.messages == 2010);
+        ASSERT(category.getSuppressed() == 1990);
+    }
+
+    // returns the cost of a call for testSpam to compare against
+    double testUnlimited() {
+        CountingSink sink;
+        logging::Category category { logging::eInfo, "unlimited" };
+        category.addSink(&sink);
+
+        double elapsed = spam(category, kWarnings / 10);
+
+        ASSERT(sink.messages == kWarnings / 10);
+        ASSERT(sink.notices == 0);
+        ASSERT(category.getSuppressed() == 0);
+
+        return getNanosPerCall(elapsed, kWarnings / 10);
+    }
+}
+
+int main() {
+    double unlimitedCost = testUnlimited();
+    testSpam(unlimitedCost);
+    testSites();
+}
@@ -0,0 +1,136 @@
+#include "simcoe/memory/ring.h"
+
+#include "simcoe/core/panic.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace simcoe;
+using namespace simcoe::memory;
+
+namespace {
+    constexpr size_t kChunkSize = 1024;
+
+    // stands in for the gpu, the test decides when work completes
+    struct FakeFence final : IFence {
+        std::uint64_t completed = 0;
+
+        std::uint64_t getCompletedValue() const override { return completed; }
+    };
+
+    void testReuse() {
+        FakeFence fence;
+        ChunkRing ring(fence, kChunkSize);
+
+        // frame 1 fills two chunks
+        ASSERT(ring.alloc(kChunkSize, 1).chunk == 0);
+        ASSERT(ring.alloc(1, 1).chunk == 1);
+        ring.retire(1);
+
+        // the gpu hasn't finished frame 1, frame 2 can't have its chunks
+        ASSERT(ring.alloc(16, 16).chunk == 2);
+        ring.retire(2);
+        ASSERT(ring.getChunkCount() == 3);
+        ASSERT(ring.getBusyCount() == 3);
+
+        // frame 1 completes, only its chunks come back
+        fence.completed = 1;
+        auto first = ring.alloc(kChunkSize, 1);
+        auto second = ring.alloc(kChunkSize, 1);
+        ASSERT(first.chunk < 2 && second.chunk < 2 && first.chunk != second.chunk);
+        ASSERT(ring.alloc(1, 1).chunk == 3);
+        ring.retire(3);
+
+        fence.completed = 3;
+        ASSERT(ring.alloc(1, 1).chunk < 4);
+        ASSERT(ring.getChunkCount() == 4);
+    }
+
+    void testAlignment() {
+        FakeFence fence;
+        ChunkRing ring(fence, kChunkSize);
+
+        ASSERT(ring.alloc(1, 1).offset == 0);
+        ASSERT(ring.alloc(4, 256).offset == 256);
+        ASSERT(ring.alloc(1, 1).offset == 260);
+
+        // doesn't fit once aligned, moves on to a fresh chunk
+        auto spill = ring.alloc(512, 512);
+        ASSERT(spill.chunk == 0 && spill.offset == 512);
+
+        auto next = ring.alloc(1, 512);
+        ASSERT(next.chunk == 1 && next.offset == 0);
+    }
+
+    // frames in flight with the gpu lagging by a random amount. every chunk the ring
+    // hands out is checked against the frame that last used it
+    void testFrames() {
+        constexpr size_t kFrames = 20'000;
+        constexpr size_t kMaxLag = 3;
+
+        FakeFence fence;
+        ChunkRing ring(fence, kChunkSize);
+        std::mt19937_64 rng(1);
+
+        constexpr std::uint64_t kInFrame = UINT64_MAX;
+        constexpr std::uint64_t kNever = 0;
+
+        // the fence value each chunk was retired with
+        std::vector<std::uint64_t> retiredAt;
+
+        // bytes used in each chunk this frame
+        std::vector<size_t> used;
+
+        for (std::uint64_t frame = 1; frame <= kFrames; frame++) {
+            std::vector<size_t> frameChunks;
+            size_t current = SIZE_MAX;
+
+            size_t count = rng() % 64;
+            for (size_t i = 0; i < count; i++) {
+                size_t size = 1 + rng() % kChunkSize;
+                size_t align = size_t(1) << (rng() % 9);
+
+                auto [chunk, offset] = ring.alloc(size, align);
+
+                if (chunk >= retiredAt.size()) {
+                    retiredAt.resize(chunk + 1, kNever);
+                    used.resize(chunk + 1, 0);
+                }
+
+                if (chunk != current) {
+                    ASSERTF(retiredAt[chunk] != kInFrame, "chunk {} handed out twice in frame {}", chunk, frame);
+                    ASSERTF(retiredAt[chunk] <= fence.completed, "chunk {} retired at {} reused at {}", chunk, retiredAt[chunk], fence.completed);
+
+                    retiredAt[chunk] = kInFrame;
+                    used[chunk] = 0;
+                    frameChunks.push_back(chunk);
+                    current = chunk;
+                }
+
+                ASSERT(offset % align == 0);
+                ASSERT(offset >= used[chunk]);
+                ASSERT(offset + size <= kChunkSize);
+                used[chunk] = offset + size;
+            }
+
+            ring.retire(frame);
+            for (size_t chunk : frameChunks) {
+                retiredAt[chunk] = frame;
+            }
+
+            // the gpu catches up to somewhere within the last few frames
+            std::uint64_t lag = rng() % (kMaxLag + 1);
+            fence.completed = std::max(fence.completed, frame > lag ? frame - lag : 0);
+        }
+
+        // with at most a few frames in flight the ring stops growing
+        ASSERTF(ring.getChunkCount() < 64 * (kMaxLag + 2), "ring grew to {} chunks", ring.getChunkCount());
+    }
+}
+
+int main() {
+    testReuse();
+    testAlignment();
+    testFrames();
+}
@@ -0,0 +1,54 @@
+#include "simcoe/core/topology.h"
+
+#include "simcoe/core/panic.h"
+
+#include <thread>
+
+using namespace simcoe;
+using namespace simcoe::os::threads;
+
+namespace {
+    void testTopology() {
+        const Topology& topology = getTopology();
+        ASSERT(!topology.cores.empty());
+
+        size_t logical = 0;
+        for (const Core& core : topology.cores) {
+            ASSERT(!core.logical.empty());
+            logical += core.logical.size();
+        }
+
+        ASSERT(logical == topology.logicalCount);
+        ASSERT(topology.getCoreCount(ePerformance) > 0);
+        ASSERT(getDefaultWorkerCount() >= 1);
+    }
+
+    // the default placement has to work for an unprivileged process.
+    // the main and render threads ask for a raised priority, which may be denied but never fails
+    void testSetup() {
+        Info info;
+
+        for (Role role : { eMain, eRender }) {
+            std::jthread thread([&] {
+                Applied applied = setup(role, info);
+                ASSERTF(applied != Applied::eFailed, "setup failed for the {} thread", getRoleName(role));
+            });
+        }
+
+        // lowering priority needs no privileges so these always apply in full
+        for (Role role : { eLogging, eMetrics }) {
+            std::jthread thread([&] {
+                ASSERTF(setup(role, info) == Applied::eAll, "setup failed for the {} thread", getRoleName(role));
+            });
+        }
+
+        std::jthread worker([&] {
+            ASSERT(setup(eWorker, info, 3) == Applied::eAll);
+        });
+    }
+}
+
+int main() {
+    testTopology();
+    testSetup();
+}
@@ -0,0 +1,321 @@
+#include "simcoe/core/trace.h"
+
+#include "simcoe/core/panic.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace simcoe;
+
+namespace {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kFrames = 20;
+    constexpr size_t kCaptures = 3;
+
+    // each capture a worker records half a ring, two zones a loop. so the third capture
+    // writes over the slots the first save copied
+    constexpr size_t kLoops = trace::kRingSize / 4;
+
+    // meson reports a test that exits with this as skipped
+    constexpr int kSkipped = 77;
+
+    // just enough json to read back what save writes
+    struct Value {
+        enum Kind { eNull, eBool, eNumber, eString, eArray, eObject } kind = eNull;
+
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<Value> array;
+        std::map<std::string, Value> object;
+
+        const Value *find(const std::string& key) const {
+            auto it = object.find(key);
+            return (it == object.end()) ? nullptr : &it->second;
+        }
+
+        std::string getString(const std::string& key) const {
+            const Value *pValue = find(key);
+            return (pValue != nullptr && pValue->kind == eString) ? pValue->string : "";
+        }
+    };
+
+    struct Parser {
+        std::string_view text;
+        size_t offset = 0;
+
+        void skipSpace() {
+            while (offset < text.size() && (text[offset] == ' ' || text[offset] == '\n' || text[offset] == '\r' || text[offset] == '\t')) {
+                offset += 1;
+            }
+        }
+
+        char peek() {
+            skipSpace();
+            ASSERTF(offset < text.size(), "json ended early");
+            return text[offset];
+        }
+
+        void expect(char c) {
+            ASSERTF(peek() == c, "expected '{}' at offset {} but found '{}'", c, offset, text[offset]);
+            offset += 1;
+        }
+
+        void expectWord(std::string_view word) {
+            ASSERTF(text.substr(offset, word.size()) == word, "expected {} at offset {}", word, offset);
+            offset += word.size();
+        }
+
+        std::string parseString() {
+            expect('"');
+
+            std::string out;
+            while (true) {
+                ASSERTF(offset < text.size(), "unterminated string");
+                char c = text[offset++];
+                if (c == '"') { break; }
+
+                ASSERTF(uint8_t(c) >= 0x20, "raw control character at offset {}", offset - 1);
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+
+                ASSERTF(offset < text.size(), "unterminated escape");
+                switch (char e = text[offset++]) {
+                case '"': case '\\': case '/': out += e; break;
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                    ASSERTF(offset + 4 <= text.size(), "short unicode escape");
+                    out += char(std::stoul(std::string(text.substr(offset, 4)), nullptr, 16));
+                    offset += 4;
+                    break;
+                default:
+                    PANIC("unknown escape \\{}", e);
+                }
+            }
+
+            return out;
+        }
+
+        Value parseValue() {
+            Value value;
+            char c = peek();
+
+            if (c == '{') {
+                value.kind = Value::eObject;
+                offset += 1;
+                if (peek() == '}') { offset += 1; return value; }
+
+                while (true) {
+                    std::string key = parseString();
+                    expect(':');
+                    value.object[key] = parseValue();
+
+                    if (peek() != ',') { break; }
+                    offset += 1;
+                }
+
+                expect('}');
+            } else if (c == '[') {
+                value.kind = Value::eArray;
+                offset += 1;
+                if (peek() == ']') { offset += 1; return value; }
+
+                while (true) {
+                    value.array.push_back(parseValue());
+
+                    if (peek() != ',') { break; }
+                    offset += 1;
+                }
+
+                expect(']');
+            } else if (c == '"') {
+                value.kind = Value::eString;
+                value.string = parseString();
+            } else if (c == 't' || c == 'f') {
+                value.kind = Value::eBool;
+                value.boolean = (c == 't');
+                expectWord(value.boolean ? "true" : "false");
+            } else if (c == 'n') {
+                expectWord("null");
+            } else {
+                value.kind = Value::eNumber;
+                size_t end = offset;
+                while (end < text.size() && std::string_view("+-.0123456789eE").find(text[end]) != std::string_view::npos) {
+                    end += 1;
+                }
+
+                ASSERTF(end > offset, "unexpected '{}' at offset {}", c, offset);
+                value.number = std::stod(std::string(text.substr(offset, end - offset)));
+                offset = end;
+            }
+
+            return value;
+        }
+    };
+
+    Value parseFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::string data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+        Parser parser { data };
+        Value root = parser.parseValue();
+        parser.skipSpace();
+        ASSERTF(parser.offset == data.size(), "trailing data after offset {}", parser.offset);
+
+        return root;
+    }
+
+    // every saved trace holds the frames of its own capture and names each thread that recorded
+    void checkTrace(const std::filesystem::path& path) {
+        Value root = parseFile(path);
+        std::filesystem::remove(path);
+
+        const Value *pEvents = root.find("traceEvents");
+        ASSERT(pEvents != nullptr && pEvents->kind == Value::eArray);
+
+        std::map<double, std::string> names; // by tid
+        std::map<std::string, size_t> zones;
+        std::set<double> zoneThreads;
+        size_t frames = 0;
+
+        for (const Value& event : pEvents->array) {
+            ASSERT(event.kind == Value::eObject);
+            std::string phase = event.getString("ph");
+            std::string name = event.getString("name");
+            const Value *pThread = event.find("tid");
+
+            if (phase == "M" && name == "thread_name") {
+                ASSERT(pThread != nullptr);
+                names[pThread->number] = event.find("args")->getString("name");
+            } else if (phase == "i") {
+                ASSERTF(name == "frame", "unexpected marker {}", name);
+                frames += 1;
+            } else if (phase == "X") {
+                ASSERTF(name == "work" || name == "inner" || name == "present", "unexpected zone {}", name);
+                ASSERT(event.find("dur")->number >= 0.0);
+                zones[name] += 1;
+                zoneThreads.insert(pThread->number);
+            }
+        }
+
+        ASSERTF(frames == kFrames, "saved {} frame markers for {} frames", frames, kFrames);
+        ASSERTF(zones["work"] == kThreads * kLoops, "saved {} work zones", zones["work"]);
+        ASSERTF(zones["inner"] == kThreads * kLoops, "saved {} inner zones", zones["inner"]);
+
+        std::set<std::string> expected = { "main" };
+        for (size_t t = 0; t < kThreads; t++) {
+            expected.insert(std::format("worker {}", t));
+        }
+
+        std::set<std::string> saved;
+        for (const auto& [tid, name] : names) {
+            saved.insert(name);
+        }
+
+        ASSERT(saved == expected);
+        ASSERTF(zoneThreads.size() == kThreads + 1, "zones from {} threads", zoneThreads.size());
+    }
+
+    // workers record zones from the start of each capture, later captures
+    // reuse ring slots that an earlier save copied
+    void testCapture() {
+        auto path = std::filesystem::temp_directory_path() / "simcoe-test-capture.json";
+
+        // the workers are started with a relaxed generation so nothing the test does orders
+        // a save before the record calls of the next capture, that has to come from trace
+        std::atomic_bool running = true;
+        std::atomic_size_t ready = 0;
+        std::atomic_size_t generation = 0;
+        std::atomic_size_t loops[kThreads] = { };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < kThreads; t++) {
+            threads.emplace_back([&, t] {
+                trace::setThreadName(std::format("worker {}", t));
+                ready.fetch_add(1, std::memory_order_relaxed);
+
+                size_t seen = 0;
+                while (running.load(std::memory_order_relaxed)) {
+                    // the capture may not be visible yet, nothing orders it before the generation
+                    size_t current = generation.load(std::memory_order_relaxed);
+                    if (current == seen || !trace::isRecording()) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        continue;
+                    }
+
+                    seen = current;
+                    for (size_t i = 0; i < kLoops; i++) {
+                        {
+                            SIMCOE_ZONE("work");
+                            SIMCOE_ZONE("inner");
+                        }
+
+                        loops[t].fetch_add(1, std::memory_order_release);
+                    }
+                }
+            });
+        }
+
+        while (ready.load(std::memory_order_relaxed) != kThreads) {
+            std::this_thread::yield();
+        }
+
+        trace::setThreadName("main");
+
+        for (size_t capture = 0; capture < kCaptures; capture++) {
+            trace::capture(kFrames);
+
+            generation.fetch_add(1, std::memory_order_relaxed);
+
+            // the frames would otherwise end the capture before a slow worker is done
+            for (size_t t = 0; t < kThreads; t++) {
+                while (loops[t].load(std::memory_order_acquire) < (capture + 1) * kLoops) {
+                    std::this_thread::yield();
+                }
+            }
+
+            size_t presented = 0;
+            while (trace::isRecording()) {
+                SIMCOE_ZONE("present");
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                trace::frame();
+                presented += 1;
+            }
+
+            ASSERTF(presented == kFrames, "capture stopped after {} of {} frames", presented, kFrames);
+            ASSERT(trace::save(path.string().c_str()));
+
+            checkTrace(path);
+        }
+
+        running.store(false, std::memory_order_relaxed);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        trace::Stats stats = trace::getStats();
+        ASSERTF(stats.threads == kThreads + 1, "{} threads recorded", stats.threads);
+    }
+}
+
+int main() {
+    if constexpr (!trace::kEnabled) {
+        std::printf("tracing is compiled out, configure with -Dtrace=enabled\n");
+        return kSkipped;
+    }
+
+    testCapture();
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+// decoding for the binary log written by logging::BinarySink, used by logdecode and the binlog test.
+// like binlog.h only depends on the standard library
+
+#include "simcoe/core/binlog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace simcoe::logging::decode {
+    using Value = std::variant<bool, char, int64_t, uint64_t, float, double, std::string_view, const void*>;
+
+    // matches the names ConsoleSink and FileSink print
+    inline const char *getLevelName(uint8_t level) {
+        switch (level) {
+        case 0: return "info";
+        case 1: return "warn";
+        case 2: return "fatal";
+        default: return "unknown";
+        }
+    }
+
+    struct Reader {
+        std::string_view data;
+        size_t offset = 0;
+
+        bool done() const { return offset >= data.size(); }
+        bool has(size_t size) const { return data.size() - offset >= size; }
+
+        template<typename T>
+        bool read(T& value) {
+            if (!has(sizeof(T))) { return false; }
+
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool varint(uint64_t& value) {
+            value = 0;
+            for (size_t shift = 0; shift < 64; shift += 7) {
+                uint8_t byte;
+                if (!read(byte)) { return false; }
+
+                value |= uint64_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) { return true; }
+            }
+
+            return false;
+        }
+
+        bool text(size_t length, std::string_view& value) {
+            if (!has(length)) { return false; }
+
+            value = data.substr(offset, length);
+            offset += length;
+            return true;
+        }
+    };
+
+    inline bool readArg(Reader& reader, Value& value) {
+        binary::Arg tag;
+        if (!reader.read(tag)) { return false; }
+
+        auto as = [&]<typename T>(T result) {
+            if (!reader.read(result)) { return false; }
+            value = result;
+            return true;
+        };
+
+        switch (tag) {
+        case binary::eBool: {
+            uint8_t flag;
+            if (!reader.read(flag)) { return false; }
+            value = flag != 0;
+            return true;
+        }
+        case binary::eChar: return as(char());
+        case binary::eInt: {
+            uint64_t bits;
+            if (!reader.varint(bits)) { return false; }
+            value = binary::unzigzag(bits);
+            return true;
+        }
+        case binary::eUint: {
+            uint64_t bits;
+            if (!reader.varint(bits)) { return false; }
+            value = bits;
+            return true;
+        }
+        case binary::eFloat: return as(float());
+        case binary::eDouble: return as(double());
+        case binary::eString: {
+            uint32_t length;
+            std::string_view text;
+            if (!reader.read(length) || !reader.text(length, text)) { return false; }
+            value = text;
+            return true;
+        }
+        case binary::ePointer: {
+            uint64_t address;
+            if (!reader.read(address)) { return false; }
+            value = reinterpret_cast<const void*>(uintptr_t(address));
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // format one argument with the spec from its replacement field, the argument
+    // has the type it had when logged so any spec that compiled then works here
+    inline void formatArg(std::string& out, const Value& value, std::string_view spec) {
+        std::string pattern = spec.empty() ? "{}" : std::format("{{:{}}}", spec);
+
+        std::visit([&](const auto& arg) {
+            std::vformat_to(std::back_inserter(out), pattern, std::make_format_args(arg));
+        }, value);
+    }
+
+    // walk the format string ourselves since std::format wants its arguments known at compile time.
+    // nested replacement fields such as dynamic widths are not supported
+    inline std::string formatMessage(std::string_view fmt, const std::vector<Value>& args) {
+        std::string out;
+        size_t next = 0;
+
+        for (size_t i = 0; i < fmt.size(); i++) {
+            char c = fmt[i];
+            if (c == '}' && i + 1 < fmt.size() && fmt[i + 1] == '}') {
+                out += '}';
+                i += 1;
+                continue;
+            }
+
+            if (c != '{') {
+                out += c;
+                continue;
+            }
+
+            if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+                out += '{';
+                i += 1;
+                continue;
+            }
+
+            size_t end = fmt.find('}', i);
+            if (end == std::string_view::npos) {
+                out += fmt.substr(i);
+                break;
+            }
+
+            std::string_view field = fmt.substr(i + 1, end - i - 1);
+            i = end;
+
+            size_t colon = field.find(':');
+            std::string_view index = field.substr(0, colon);
+            std::string_view spec = (colon == std::string_view::npos) ? std::string_view() : field.substr(colon + 1);
+
+            size_t which = next++;
+            if (!index.empty()) {
+                which = 0;
+                for (char digit : index) {
+                    which = which * 10 + size_t(digit - '0');
+                }
+            }
+
+            if (which < args.size()) {
+                formatArg(out, args[which], spec);
+            } else {
+                out += "<missing>";
+            }
+        }
+
+        return out;
+    }
+
+    // calls emit(message, category, text) for every message in order.
+    // false with the reason in error if the log can't be read, a truncated last record is not an error
+    template<typename F>
+    bool decodeLog(std::string_view data, F&& emit, std::string& error) {
+        Reader reader = { data };
+
+        binary::FileHeader header;
+        if (!reader.read(header) || std::memcmp(header.magic, binary::kMagic, sizeof(binary::kMagic)) != 0) {
+            error = "not a simcoe binary log";
+            return false;
+        }
+
+        if (header.version != binary::kVersion) {
+            error = std::format("log is version {}, this decoder reads version {}", header.version, binary::kVersion);
+            return false;
+        }
+
+        reader.offset = header.headerSize;
+
+        std::unordered_map<uint32_t, std::string_view> formats;
+        std::unordered_map<uint32_t, std::string_view> categories;
+        std::vector<Value> args;
+
+        while (!reader.done()) {
+            binary::Kind kind = binary::Kind(uint8_t(data[reader.offset]));
+
+            if (kind == binary::eFormat || kind == binary::eCategory) {
+                binary::Define define;
+                std::string_view text;
+                if (!reader.read(define) || !reader.text(define.length, text)) { break; }
+
+                auto& table = (kind == binary::eFormat) ? formats : categories;
+                table[define.id] = text;
+                continue;
+            }
+
+            if (kind != binary::eMessage) {
+                error = std::format("unknown record {} at offset {}", unsigned(kind), reader.offset);
+                return false;
+            }
+
+            binary::Message message;
+            if (!reader.read(message) || !reader.has(message.size)) { break; }
+
+            Reader payload = { data.substr(reader.offset, message.size) };
+            reader.offset += message.size;
+
+            args.resize(message.argCount);
+            for (Value& arg : args) {
+                if (!readArg(payload, arg)) {
+                    error = std::format("bad argument in message at offset {}", reader.offset);
+                    return false;
+                }
+            }
+
+            emit(message, categories[message.category], formatMessage(formats[message.format], args));
+        }
+
+        // a crash can leave a half written record at the end
+        if (!reader.done()) {
+            std::fprintf(stderr, "log ends with a truncated record\n");
+        }
+
+        return true;
+    }
+}
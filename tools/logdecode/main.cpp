@@ -0,0 +1,55 @@
+// turns a binary log written by logging::BinarySink back into the text FileSink would have written.
+// usage: logdecode [--time] <simcoe.bin.log>
+
+#include "decode.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+using namespace simcoe::logging;
+
+int main(int argc, const char **argv) {
+    bool showTime = false;
+    const char *pzPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--time") {
+            showTime = true;
+        } else {
+            pzPath = argv[i];
+        }
+    }
+
+    if (pzPath == nullptr) {
+        std::fprintf(stderr, "usage: logdecode [--time] <simcoe.bin.log>\n");
+        return 1;
+    }
+
+    std::ifstream file(pzPath, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "could not open %s\n", pzPath);
+        return 1;
+    }
+
+    std::string data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    auto print = [&](const binary::Message& message, std::string_view category, const std::string& text) {
+        if (showTime) {
+            std::printf("[%.6f t%u] ", double(message.time) / 1e9, message.thread);
+        }
+
+        std::printf("[%.*s:%s] %s\n", int(category.size()), category.data(), decode::getLevelName(message.level), text.c_str());
+    };
+
+    std::string error;
+    if (!decode::decodeLog(data, print, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    return 0;
+}